@@ -0,0 +1,414 @@
+/*
+ * CAN0 to CAN1 bridge, for MAX32690.
+ *
+ * @file        CO_CANbridge.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+#include "can.h"
+
+#include "CO_CANbridge.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+
+#if TARGET_NUM != 32690
+#error "CAN bridge requires second CAN controller (MAX32690)"
+#endif
+
+#define QUEUE_MASK (CO_CAN_BRIDGE_QUEUE_SIZE - 1U)
+#define CAN_STD_ID_MASK 0x7FFU
+#define CAN_RTR_FLAG    0x8000U
+
+/* CAN1 callbacks of the MSDK driver have no object */
+static CO_CANbridge_t *bridgeThis;
+
+
+/*
+ * Custom function for reading OD object "CAN bridge statistics"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_CANbridgeStats(OD_stream_t *stream, void *buf,
+                                    OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex > 2U * CO_CAN_BRIDGE_SUB_DIR_COUNT) {
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    CO_CANbridge_t *br = (CO_CANbridge_t *)stream->object;
+    uint8_t sub = (uint8_t)(stream->subIndex - 1U);
+    CO_CANbridge_dir_t *d = &br->dir[sub / CO_CAN_BRIDGE_SUB_DIR_COUNT];
+    uint32_t val = 0;
+
+    switch (sub % CO_CAN_BRIDGE_SUB_DIR_COUNT + 1U) {
+    case CO_CAN_BRIDGE_SUB_FORWARDED:   val = d->forwarded; break;
+    case CO_CAN_BRIDGE_SUB_DROPPED:     val = d->dropped; break;
+    case CO_CAN_BRIDGE_SUB_LIMITED:     val = d->limited; break;
+    case CO_CAN_BRIDGE_SUB_LATENCY_AVG: val = d->latencyAvg_us; break;
+    case CO_CAN_BRIDGE_SUB_LATENCY_MAX: val = d->latencyMax_us; break;
+    case CO_CAN_BRIDGE_SUB_RATE:        val = d->rate; break;
+    case CO_CAN_BRIDGE_SUB_RATE_PEAK:   val = d->ratePeak; break;
+    default: break;
+    }
+
+    *countRead = CO_setUint32(buf, val);
+    return ODR_OK;
+}
+
+
+/* Frame entered the transmit buffer, update statistics */
+CO_RAMFUNC
+static void CO_CANbridge_sent(CO_CANbridge_dir_t *d, uint32_t rx_us) {
+    uint32_t latency_us = CO_timer_us() - rx_us;
+
+    d->forwarded++;
+    d->latencySum_us += latency_us;
+    if (latency_us > d->latencyMax_us) {
+        d->latencyMax_us = latency_us;
+    }
+}
+
+
+/* Write frame into the transmit buffer of CAN1 */
+CO_RAMFUNC
+static void CO_CANbridge_send(CO_CANbridge_t *br, CO_CANtx_t *frame) {
+    mxc_can_req_t req;
+    mxc_can_msg_info_t info;
+
+    info.brs = 0;
+    info.dlc = frame->DLC;
+    info.esi = 0;
+    info.fdf = 0;
+    info.msg_id = MXC_CAN_STANDARD_ID(frame->ident);
+    info.rsv = 0;
+    info.rtr = (frame->ident & CAN_RTR_FLAG) ? 1 : 0;
+    req.data = frame->data;
+    req.data_sz = frame->DLC;
+    req.msg_info = &info;
+    if (MXC_CAN_MessageSendAsync(MXC_CAN_GET_IDX(br->CANptr), &req)
+            < E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_SEND_FAILED, frame->ident, 0);
+    }
+}
+
+
+/* Take the oldest frame from the queue, NULL if empty. Slot is valid until the
+ * next CO_CANbridge_rx(), which runs at the same interrupt priority. */
+CO_RAMFUNC
+static CO_CANbridge_item_t *CO_CANbridge_pop(CO_CANbridge_dir_t *d) {
+    if (d->tail == d->head) {
+        return NULL;
+    }
+    CO_CANbridge_item_t *item = &d->queue[d->tail & QUEUE_MASK];
+    d->tail++;
+    return item;
+}
+
+
+/* CAN1 transmit buffer is free, send next frame from the queue */
+CO_RAMFUNC
+static void CO_CANbridge_txComplete(CO_CANbridge_t *br) {
+    CO_CANbridge_dir_t *d = &br->dir[CO_CAN_BRIDGE_TO_CAN1];
+    CO_CANbridge_item_t *item = CO_CANbridge_pop(d);
+
+    if (item == NULL) {
+        d->txBusy = false;
+        return;
+    }
+    CO_CANbridge_send(br, &item->frame);
+    CO_CANbridge_sent(d, item->rx_us);
+}
+
+
+/* CAN1 error states are not reported to the CANopen stack */
+static void CO_CANbridge_unitEvent_cb(uint32_t can_idx, uint32_t event) {
+    (void)can_idx;
+    (void)event;
+}
+
+
+/* CAN1 object events, received frame is taken from the single receive slot
+ * before the next one is written into it */
+CO_RAMFUNC
+static void CO_CANbridge_objEvent_cb(uint32_t can_idx, uint32_t event) {
+    CO_CANbridge_t *br = bridgeThis;
+
+    (void)can_idx;
+    if (br == NULL) {
+        return;
+    }
+    switch (event) {
+    case MXC_CAN_OBJ_EVT_TX_COMPLETE:
+        CO_CANbridge_txComplete(br);
+        break;
+    case MXC_CAN_OBJ_EVT_RX:
+        CO_CANbridge_rx(br, true, &br->rxMsg);
+        break;
+    case MXC_CAN_OBJ_EVT_RX_OVERRUN:
+        br->dir[CO_CAN_BRIDGE_TO_CAN0].dropped++;
+        break;
+    default:
+        break;
+    }
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANbridge_init(CO_CANbridge_t *br,
+                                   CO_CANmodule_t *CANmodule,
+                                   void *CANptr,
+                                   uint16_t CANbitRate,
+                                   OD_entry_t *OD_routes,
+                                   OD_entry_t *OD_stats)
+{
+    uint8_t count = 0;
+
+    /* verify arguments */
+    if (br == NULL || CANmodule == NULL || CANptr == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* CAN1 interrupt may be active from previous communication reset */
+    bridgeThis = NULL;
+    memset(br, 0, sizeof(CO_CANbridge_t));
+    br->CANmodule = CANmodule;
+    br->CANptr = CANptr;
+
+    /* Routes are read once, sub-index 0 is the number of routes */
+    if (OD_routes != NULL && OD_get_u8(OD_routes, 0, &count, true) != ODR_OK) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    if (count > CO_CAN_BRIDGE_ROUTES_MAX) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    uint32_t now_us = CO_timer_us();
+    for (uint8_t i = 1; i <= count; i++) {
+        uint64_t r;
+
+        if (OD_get_u64(OD_routes, i, &r, true) != ODR_OK) {
+            return CO_ERROR_ILLEGAL_ARGUMENT;
+        }
+        if (!CO_CAN_BRIDGE_ROUTE_VALID(r)) {
+            continue;
+        }
+        CO_CANbridge_route_t *route = &br->route[br->routesCount++];
+        route->mask = CO_CAN_BRIDGE_ROUTE_MASK(r);
+        route->ident = CO_CAN_BRIDGE_ROUTE_IDENT(r) & route->mask;
+        route->newIdent = CO_CAN_BRIDGE_ROUTE_NEW(r);
+        route->dir = CO_CAN_BRIDGE_ROUTE_DIR(r);
+        route->interval_us = (uint32_t)CO_CAN_BRIDGE_ROUTE_INTERVAL(r) * 100U;
+        route->next_us = now_us;
+    }
+
+    if (OD_stats != NULL) {
+        br->OD_stats_ext.object = br;
+        br->OD_stats_ext.read = OD_read_CANbridgeStats;
+        br->OD_stats_ext.write = NULL;
+        OD_extension_init(OD_stats, &br->OD_stats_ext);
+    }
+
+    /* Configure CAN1, all standard identifiers are received */
+    uint32_t idx = MXC_CAN_GET_IDX(CANptr);
+    if (MXC_CAN_PowerControl(idx, MXC_CAN_PWR_CTRL_FULL) != E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_POWER_FAILED, MXC_CAN_PWR_CTRL_FULL, 0);
+        return CO_ERROR_INVALID_STATE;
+    }
+    if (MXC_CAN_Init(idx, MXC_CAN_OBJ_CFG_TXRX, CO_CANbridge_unitEvent_cb,
+                     CO_CANbridge_objEvent_cb) != E_NO_ERROR) {
+        return CO_ERROR_INVALID_STATE;
+    }
+    if (!CO_CANsetBitRate(CANptr, CANbitRate)) {
+        return CO_ERROR_ILLEGAL_BAUDRATE;
+    }
+    MXC_CAN_ObjectSetFilter(idx,
+            MXC_CAN_FILT_CFG_MASK_DEL | MXC_CAN_FILT_CFG_SINGLE_STD_ID,
+            CAN_STD_ID_MASK, 0);
+    MXC_CAN_ObjectSetFilter(idx,
+            MXC_CAN_FILT_CFG_MASK_ADD | MXC_CAN_FILT_CFG_SINGLE_STD_ID,
+            CAN_STD_ID_MASK, 0);
+
+    bridgeThis = br;
+    br->rxReq.msg_info = &br->rxMsg.info;
+    br->rxReq.data = br->rxMsg.data;
+    br->rxReq.data_sz = sizeof(br->rxMsg.data);
+    if (MXC_CAN_MessageReadAsync(idx, &br->rxReq) < E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_READ_FAILED, 0, 0);
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    MXC_CAN_EnableInt(idx, MXC_F_CAN_INTEN_DOR | MXC_F_CAN_INTEN_TX
+                         | MXC_F_CAN_INTEN_RX, 0);
+    if (MXC_CAN_SetMode(idx, MXC_CAN_MODE_NORMAL) != E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_SET_MODE_FAILED, MXC_CAN_MODE_NORMAL, 0);
+        return CO_ERROR_INVALID_STATE;
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_RAMFUNC
+void CO_CANbridge_rx(CO_CANbridge_t *br, bool_t fromCAN1,
+                     const CO_CANrxMsg_t *rcvMsg)
+{
+    uint8_t dir = fromCAN1 ? CO_CAN_BRIDGE_TO_CAN0 : CO_CAN_BRIDGE_TO_CAN1;
+    uint16_t ident = (uint16_t)(rcvMsg->info.msg_id & CAN_STD_ID_MASK);
+    CO_CANbridge_route_t *route = NULL;
+
+    /* routes are for standard identifiers only */
+    if ((rcvMsg->info.msg_id & CO_CAN_EXT_ID_FLAG) != 0U) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < br->routesCount; i++) {
+        CO_CANbridge_route_t *r = &br->route[i];
+
+        if (r->dir == dir && ((ident ^ r->ident) & r->mask) == 0U) {
+            route = r;
+            break;
+        }
+    }
+    if (route == NULL) {
+        return;
+    }
+
+    CO_CANbridge_dir_t *d = &br->dir[dir];
+    uint32_t now_us = CO_timer_us();
+
+    /* Rate limit: each frame moves next_us by the interval, frame is allowed
+     * up to burst - 1 intervals before it */
+    if (route->interval_us != 0U) {
+        uint32_t burst_us = route->interval_us * (CO_CAN_BRIDGE_BURST - 1U);
+
+        if ((int32_t)(now_us + burst_us - route->next_us) < 0) {
+            d->limited++;
+            return;
+        }
+        if ((int32_t)(now_us - route->next_us) > 0) {
+            route->next_us = now_us;
+        }
+        route->next_us += route->interval_us;
+    }
+
+    if ((d->head - d->tail) >= CO_CAN_BRIDGE_QUEUE_SIZE) {
+        d->dropped++;
+        return;
+    }
+
+    CO_CANbridge_item_t *item = &d->queue[d->head & QUEUE_MASK];
+    CO_CANtx_t *frame = &item->frame;
+    uint8_t DLC = rcvMsg->info.dlc <= 8U ? rcvMsg->info.dlc : 8U;
+
+    frame->ident = (uint32_t)((ident & ~route->mask)
+                            | (route->newIdent & route->mask));
+    if (rcvMsg->info.rtr != 0U) {
+        frame->ident |= CAN_RTR_FLAG;
+    }
+    frame->DLC = DLC;
+    memcpy(frame->data, rcvMsg->data, DLC);
+    frame->bufferFull = false;
+    frame->syncFlag = false;
+    item->rx_us = now_us;
+
+    /* Send directly, if the other controller is idle, else from its TX
+     * interrupt */
+    if (d->head == d->tail) {
+        if (dir == CO_CAN_BRIDGE_TO_CAN1) {
+            if (!d->txBusy) {
+                d->txBusy = true;
+                CO_CANbridge_send(br, frame);
+                CO_CANbridge_sent(d, now_us);
+                return;
+            }
+        }
+        else if (CO_CANsendFromISR(br->CANmodule, frame)) {
+            d->txBusy = true;
+            CO_CANbridge_sent(d, now_us);
+            return;
+        }
+    }
+    d->head++;
+}
+
+
+/******************************************************************************/
+CO_RAMFUNC
+CO_CANtx_t *CO_CANbridge_txNextCAN0(CO_CANbridge_t *br, bool_t stackWaiting) {
+    CO_CANbridge_dir_t *d = &br->dir[CO_CAN_BRIDGE_TO_CAN0];
+    CO_CANbridge_item_t *item;
+
+    if ((stackWaiting && d->txBusy) || (item = CO_CANbridge_pop(d)) == NULL) {
+        d->txBusy = false;
+        return NULL;
+    }
+    d->txBusy = true;
+    CO_CANbridge_sent(d, item->rx_us);
+    return &item->frame;
+}
+
+
+/******************************************************************************/
+void CO_CANbridge_interrupt(CO_CANbridge_t *br) {
+    /* interrupt flag cleared in MXC_CAN_Handler */
+    MXC_CAN_Handler(MXC_CAN_GET_IDX(br->CANptr));
+}
+
+
+/******************************************************************************/
+void CO_CANbridge_process(CO_CANbridge_t *br, uint32_t timeDifference_us) {
+    br->window_us += timeDifference_us;
+    if (br->window_us < (uint32_t)CO_CAN_BRIDGE_WINDOW_MS * 1000U) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < 2U; i++) {
+        CO_CANbridge_dir_t *d = &br->dir[i];
+        uint32_t forwarded = d->forwarded;
+        uint32_t latencySum_us = d->latencySum_us;
+        uint32_t frames = forwarded - d->forwardedOld;
+
+        d->rate = (uint32_t)((uint64_t)frames * 1000000U / br->window_us);
+        if (d->rate > d->ratePeak) {
+            d->ratePeak = d->rate;
+        }
+        if (frames > 0U) {
+            d->latencyAvg_us = (latencySum_us - d->latencySumOld_us) / frames;
+        }
+        d->forwardedOld = forwarded;
+        d->latencySumOld_us = latencySum_us;
+    }
+    br->window_us = 0;
+}
+
+#endif /* (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE */
@@ -0,0 +1,272 @@
+/*
+ * CAN0 to CAN1 bridge, for MAX32690.
+ *
+ * @file        CO_CANbridge.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CAN_BRIDGE_H
+#define CO_CAN_BRIDGE_H
+
+#include "can.h"
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Forwarding of selected frames between CAN0, used by the CANopen stack, and
+ * CAN1, used only by the bridge. Frames are matched against routes in the
+ * receive interrupt and written into the transmit buffer of the other
+ * controller from the same interrupt, or from its TX interrupt, if it is busy.
+ * They do not pass the CANopen stack, RX queue or mainline. On CAN0 forwarded
+ * frames take turns with messages queued by the stack, so neither starves the
+ * other. Frames received on CAN0 are processed by the stack as well.
+ *
+ * Both CAN interrupts must have the same priority, they share the queues
+ * without locking.
+ *
+ * Forwarding latency (from reception to the transmit buffer of the other
+ * controller) and the forwarding rate are measured for each direction.
+ */
+
+/* Bitrate of CAN1 in kbit/s, 0 for the bitrate of CAN0. */
+#ifndef CO_CAN_BRIDGE_BITRATE
+#define CO_CAN_BRIDGE_BITRATE 0
+#endif
+/* Maximum number of routes. */
+#ifndef CO_CAN_BRIDGE_ROUTES_MAX
+#define CO_CAN_BRIDGE_ROUTES_MAX 16
+#endif
+/* Number of frames waiting for the transmit buffer, must be power of 2. */
+#ifndef CO_CAN_BRIDGE_QUEUE_SIZE
+#define CO_CAN_BRIDGE_QUEUE_SIZE 32
+#endif
+/* Number of frames a rate limited route may send back to back. */
+#ifndef CO_CAN_BRIDGE_BURST
+#define CO_CAN_BRIDGE_BURST 4
+#endif
+/* Length of the forwarding rate window in milliseconds. */
+#ifndef CO_CAN_BRIDGE_WINDOW_MS
+#define CO_CAN_BRIDGE_WINDOW_MS 1000
+#endif
+/* Default indexes of the manufacturer specific OD entries, see
+ * CO_CANbridge_init() */
+#ifndef CO_CAN_BRIDGE_OD_INDEX
+#define CO_CAN_BRIDGE_OD_INDEX 0x2104
+#endif
+#ifndef CO_CAN_BRIDGE_STATS_OD_INDEX
+#define CO_CAN_BRIDGE_STATS_OD_INDEX 0x2105
+#endif
+
+/**
+ * Route in the routes OD entry (ARRAY of UNSIGNED64, one route per
+ * sub-index). Frame is forwarded by the first valid route, for which
+ * ((ident ^ route ident) & mask) == 0. Identifier is remapped to
+ * (ident & ~mask) | (new ident & mask), so new ident equal to route ident
+ * keeps it.
+ *
+ * - bits 0-10: route ident
+ * - bits 16-26: mask
+ * - bits 32-42: new ident
+ * - bit 44: direction, 0 from CAN0 to CAN1, 1 from CAN1 to CAN0
+ * - bit 47: route is valid
+ * - bits 48-63: minimum interval between frames in 100 us, 0 for no limit.
+ *   Up to CO_CAN_BRIDGE_BURST frames may be sent back to back.
+ *
+ * Routes are read in CO_CANbridge_init(), after communication reset.
+ */
+#define CO_CAN_BRIDGE_ROUTE_IDENT(r)    ((uint16_t)((r) & 0x7FFU))
+#define CO_CAN_BRIDGE_ROUTE_MASK(r)     ((uint16_t)(((r) >> 16) & 0x7FFU))
+#define CO_CAN_BRIDGE_ROUTE_NEW(r)      ((uint16_t)(((r) >> 32) & 0x7FFU))
+#define CO_CAN_BRIDGE_ROUTE_DIR(r)      ((uint8_t)(((r) >> 44) & 1U))
+#define CO_CAN_BRIDGE_ROUTE_VALID(r)    ((((r) >> 47) & 1U) != 0U)
+#define CO_CAN_BRIDGE_ROUTE_INTERVAL(r) ((uint16_t)((r) >> 48))
+
+/* Direction, index into CO_CANbridge_t.dir */
+#define CO_CAN_BRIDGE_TO_CAN1 0U
+#define CO_CAN_BRIDGE_TO_CAN0 1U
+
+/**
+ * Sub-indexes of the statistics OD entry (ARRAY of UNSIGNED32, read-only),
+ * sub-index 1 to 7 for direction CAN0 to CAN1, 8 to 14 for CAN1 to CAN0.
+ *
+ * - 1: forwarded frames
+ * - 2: frames dropped, because the queue was full
+ * - 3: frames dropped by rate limit
+ * - 4: average forwarding latency in us in last window
+ * - 5: maximum forwarding latency in us
+ * - 6: forwarded frames per second in last window
+ * - 7: peak of forwarded frames per second
+ */
+#define CO_CAN_BRIDGE_SUB_FORWARDED     1
+#define CO_CAN_BRIDGE_SUB_DROPPED       2
+#define CO_CAN_BRIDGE_SUB_LIMITED       3
+#define CO_CAN_BRIDGE_SUB_LATENCY_AVG   4
+#define CO_CAN_BRIDGE_SUB_LATENCY_MAX   5
+#define CO_CAN_BRIDGE_SUB_RATE          6
+#define CO_CAN_BRIDGE_SUB_RATE_PEAK     7
+#define CO_CAN_BRIDGE_SUB_DIR_COUNT     7
+
+/**
+ * Route, parsed from the OD entry.
+ */
+typedef struct {
+    uint16_t ident;
+    uint16_t mask;
+    uint16_t newIdent;
+    /** Direction, CO_CAN_BRIDGE_TO_CAN1 or CO_CAN_BRIDGE_TO_CAN0 */
+    uint8_t dir;
+    /** Minimum interval in us, 0 for no limit */
+    uint32_t interval_us;
+    /** Rate limit: frame is allowed, if not earlier than burst intervals
+     * before this time */
+    uint32_t next_us;
+} CO_CANbridge_route_t;
+
+/**
+ * Frame waiting for the transmit buffer.
+ */
+typedef struct {
+    CO_CANtx_t frame;
+    /** Time of reception, see CO_timer_us() */
+    uint32_t rx_us;
+} CO_CANbridge_item_t;
+
+/**
+ * One forwarding direction.
+ */
+typedef struct {
+    CO_CANbridge_item_t queue[CO_CAN_BRIDGE_QUEUE_SIZE];
+    /** Free running counters, queue index is their lower bits */
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    /** Direction to CAN1: transmit buffer of CAN1 is in use. Direction to
+     * CAN0: last frame in the transmit buffer was forwarded. */
+    volatile bool_t txBusy;
+    /* Statistics, counters are incremented from CAN interrupts */
+    volatile uint32_t forwarded;
+    volatile uint32_t dropped;
+    volatile uint32_t limited;
+    volatile uint32_t latencySum_us;
+    volatile uint32_t latencyMax_us;
+    /* Calculated in CO_CANbridge_process() */
+    uint32_t latencyAvg_us;
+    uint32_t rate;
+    uint32_t ratePeak;
+    uint32_t forwardedOld;
+    uint32_t latencySumOld_us;
+} CO_CANbridge_dir_t;
+
+/**
+ * CAN bridge object.
+ */
+typedef struct CO_CANbridge {
+    CO_CANbridge_route_t route[CO_CAN_BRIDGE_ROUTES_MAX];
+    uint8_t routesCount;
+    CO_CANbridge_dir_t dir[2];
+    /** CAN module of the stack, on CAN0 */
+    CO_CANmodule_t *CANmodule;
+    /** Second CAN controller */
+    void *CANptr;
+    /* Internal */
+    CO_CANrxMsg_t rxMsg;
+    mxc_can_req_t rxReq;
+    uint32_t window_us;
+    OD_extension_t OD_stats_ext;
+} CO_CANbridge_t;
+
+
+/**
+ * Initialize CAN bridge and second CAN controller, called after CO_CANinit()
+ * in each communication reset.
+ *
+ * @param br This object will be initialized.
+ * @param CANmodule CAN module of the stack.
+ * @param CANptr Second CAN controller, MXC_CAN1.
+ * @param CANbitRate Bitrate of the second CAN controller in kbit/s.
+ * @param OD_routes OD entry with routes, see @ref CO_CAN_BRIDGE_ROUTE_IDENT.
+ * May be NULL, nothing is forwarded then.
+ * @param OD_stats Optional OD entry for reading statistics, see
+ * @ref CO_CAN_BRIDGE_SUB_FORWARDED. May be NULL.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT, CO_ERROR_ILLEGAL_BAUDRATE
+ * or CO_ERROR_INVALID_STATE.
+ */
+CO_ReturnError_t CO_CANbridge_init(CO_CANbridge_t *br,
+                                   CO_CANmodule_t *CANmodule,
+                                   void *CANptr,
+                                   uint16_t CANbitRate,
+                                   OD_entry_t *OD_routes,
+                                   OD_entry_t *OD_stats);
+
+
+/**
+ * Match received frame against routes and forward it. Called from CAN
+ * receive interrupt of either controller.
+ *
+ * @param br CAN bridge object.
+ * @param fromCAN1 Frame was received on CAN1.
+ * @param rcvMsg Received message.
+ */
+void CO_CANbridge_rx(CO_CANbridge_t *br, bool_t fromCAN1,
+                     const CO_CANrxMsg_t *rcvMsg);
+
+
+/**
+ * Get next forwarded frame for CAN0, called from CO_CANTXinterrupt().
+ *
+ * @param br CAN bridge object.
+ * @param stackWaiting Messages of the stack are queued. If set, NULL is
+ * returned after each forwarded frame.
+ *
+ * @return Frame to be written into the transmit buffer or NULL.
+ */
+CO_CANtx_t *CO_CANbridge_txNextCAN0(CO_CANbridge_t *br, bool_t stackWaiting);
+
+
+/**
+ * CAN1 interrupt, set as vector of CAN1_IRQn by main file.
+ *
+ * @param br CAN bridge object.
+ */
+void CO_CANbridge_interrupt(CO_CANbridge_t *br);
+
+
+/**
+ * Calculate forwarding rate, called cyclically from mainline.
+ *
+ * @param br CAN bridge object.
+ * @param timeDifference_us Time difference from previous function call.
+ */
+void CO_CANbridge_process(CO_CANbridge_t *br, uint32_t timeDifference_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE */
+
+#endif /* CO_CAN_BRIDGE_H */
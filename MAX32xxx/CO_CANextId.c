@@ -0,0 +1,102 @@
+/*
+ * Reception of 29-bit extended identifiers, for MAX32xxx.
+ *
+ * @file        CO_CANextId.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_CANextId.h"
+
+
+#if (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE
+
+/* RTR is compared as bit above the 29-bit identifier */
+#define EXT_RTR_BIT (CO_CAN_EXT_ID_MASK + 1U)
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANextId_init(CO_CANextId_t *ext) {
+    /* verify arguments */
+    if (ext == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(ext, 0, sizeof(CO_CANextId_t));
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANextId_rxBufferInit(CO_CANextId_t *ext,
+                                          uint8_t index,
+                                          uint32_t ident,
+                                          uint32_t mask,
+                                          bool_t rtr,
+                                          void *object,
+                                          void (*CANrx_callback)(void *object,
+                                                                 void *message))
+{
+    /* verify arguments */
+    if (ext == NULL || index >= CO_CAN_EXT_ID_RX_MAX || CANrx_callback == NULL
+        || ident > CO_CAN_EXT_ID_MASK
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    CO_CANextId_rx_t *buffer = &ext->rxArray[index];
+
+    buffer->mask = (mask & CO_CAN_EXT_ID_MASK) | EXT_RTR_BIT;
+    buffer->ident = (ident | (rtr ? EXT_RTR_BIT : 0U)) & buffer->mask;
+    buffer->object = object;
+    buffer->CANrx_callback = CANrx_callback;
+    if (index >= ext->rxCount) {
+        ext->rxCount = index + 1U;
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_RAMFUNC
+void CO_CANextId_rx(CO_CANextId_t *ext, CO_CANrxMsg_t *rcvMsg) {
+    uint32_t ident = rcvMsg->info.msg_id & CO_CAN_EXT_ID_MASK;
+
+    if (rcvMsg->info.rtr != 0U) {
+        ident |= EXT_RTR_BIT;
+    }
+    ext->received++;
+
+    for (uint8_t i = 0; i < ext->rxCount; i++) {
+        CO_CANextId_rx_t *buffer = &ext->rxArray[i];
+
+        if (buffer->CANrx_callback != NULL
+            && ((ident ^ buffer->ident) & buffer->mask) == 0U
+        ) {
+            buffer->CANrx_callback(buffer->object, (void *)rcvMsg);
+            return;
+        }
+    }
+    ext->unmatched++;
+}
+
+#endif /* (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE */
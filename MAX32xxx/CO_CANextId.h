@@ -0,0 +1,137 @@
+/*
+ * Reception of 29-bit extended identifiers, for MAX32xxx.
+ *
+ * @file        CO_CANextId.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CAN_EXT_ID_H
+#define CO_CAN_EXT_ID_H
+
+#include "301/CO_driver.h"
+
+#if ((CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * CANopen uses 11-bit identifiers only. Frames with 29-bit identifier (J1939
+ * and other protocols on the same bus) are rejected at the start of
+ * CO_CANRXinterrupt(), before the receive slot is advanced, and counted in
+ * CO_CANmodule_t.rxExtRejected. The acceptance filter of the CAN controller
+ * compares the same bits for both frame formats, so it can not reject them.
+ *
+ * If this object is set in CO_CANmodule_t.extId, extended frames are matched
+ * against its own table and passed to application callbacks instead. This is
+ * done directly in CO_CANRXinterrupt(), also with FreeRTOS, so callbacks must
+ * be short. They never pass statistics, trace, bridge, RX queue or
+ * CO_CANrxDispatch(), and the standard identifier path only tests one bit.
+ */
+
+/* Number of entries in the receive table. */
+#ifndef CO_CAN_EXT_ID_RX_MAX
+#define CO_CAN_EXT_ID_RX_MAX 8
+#endif
+/* 29-bit identifier mask, e.g. J1939 PGN is matched with 0x03FFFF00. */
+#define CO_CAN_EXT_ID_MASK 0x1FFFFFFFUL
+
+/* 29-bit identifier of received message, see CO_CANrxMsg_readIdent() */
+#define CO_CANrxMsg_readExtIdent(msg) \
+    ((uint32_t)(((CO_CANrxMsg_t*)(msg)))->info.msg_id & CO_CAN_EXT_ID_MASK)
+
+/**
+ * Entry of the receive table.
+ */
+typedef struct {
+    uint32_t ident;
+    uint32_t mask;
+    void *object;
+    /** Called from CAN interrupt, message is CO_CANrxMsg_t. Entry is not
+     * used, if NULL. */
+    void (*CANrx_callback)(void *object, void *message);
+} CO_CANextId_rx_t;
+
+/**
+ * Extended identifier object.
+ */
+typedef struct CO_CANextId {
+    CO_CANextId_rx_t rxArray[CO_CAN_EXT_ID_RX_MAX];
+    /** Number of table entries searched, up to the last initialized one */
+    uint8_t rxCount;
+    /** Received extended frames */
+    volatile uint32_t received;
+    /** Received extended frames without matching entry */
+    volatile uint32_t unmatched;
+} CO_CANextId_t;
+
+
+/**
+ * Initialize extended identifier object. Set CO_CANmodule_t.extId after
+ * entries are configured, in each communication reset.
+ *
+ * @param ext This object will be initialized.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANextId_init(CO_CANextId_t *ext);
+
+
+/**
+ * Configure entry of the receive table, same as CO_CANrxBufferInit(). Frame
+ * is passed to the first entry, for which ((ident ^ entry ident) & mask) == 0.
+ *
+ * @param ext Extended identifier object.
+ * @param index Index of the entry, 0 to CO_CAN_EXT_ID_RX_MAX - 1.
+ * @param ident 29-bit identifier.
+ * @param mask 29-bit mask, bits set to 1 are compared.
+ * @param rtr If true, remote frames are matched, else data frames.
+ * @param object Passed to callback.
+ * @param CANrx_callback Function called from CAN interrupt.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANextId_rxBufferInit(CO_CANextId_t *ext,
+                                          uint8_t index,
+                                          uint32_t ident,
+                                          uint32_t mask,
+                                          bool_t rtr,
+                                          void *object,
+                                          void (*CANrx_callback)(void *object,
+                                                                 void *message));
+
+
+/**
+ * Pass received extended frame to its callback, called from
+ * CO_CANRXinterrupt().
+ *
+ * @param ext Extended identifier object.
+ * @param rcvMsg Received message.
+ */
+void CO_CANextId_rx(CO_CANextId_t *ext, CO_CANrxMsg_t *rcvMsg);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE */
+
+#endif /* CO_CAN_EXT_ID_H */
@@ -0,0 +1,355 @@
+/*
+ * CAN loopback self-test, for MAX32xxx.
+ *
+ * @file        CO_CANselfTest.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+#include "can.h"
+
+#include "CO_CANselfTest.h"
+
+
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+
+/* Phase of the pending test, one step per CO_CANselfTest_process() */
+#define CO_CAN_SELFTEST_PHASE_START 0U  /* wait for free TX path */
+#define CO_CAN_SELFTEST_PHASE_CAL   1U  /* idle counter without traffic */
+#define CO_CAN_SELFTEST_PHASE_TEST  2U  /* test frames in loopback */
+
+/*
+ * Custom function for reading OD object "CAN self-test"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_CANselfTest(OD_stream_t *stream, void *buf,
+                                 OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_CANselfTest_t *st = (CO_CANselfTest_t *)stream->object;
+    uint32_t val;
+
+    switch (stream->subIndex) {
+    case CO_CAN_SELFTEST_SUB_COMMAND:  val = st->state; break;
+    case CO_CAN_SELFTEST_SUB_IDENT:    val = st->ident; break;
+    case CO_CAN_SELFTEST_SUB_DLC:      val = st->DLC; break;
+    case CO_CAN_SELFTEST_SUB_PATTERN:  val = st->pattern; break;
+    case CO_CAN_SELFTEST_SUB_RATE:     val = st->rate; break;
+    case CO_CAN_SELFTEST_SUB_LOST:     val = st->lost; break;
+    case CO_CAN_SELFTEST_SUB_ERRORS:   val = st->errors; break;
+    case CO_CAN_SELFTEST_SUB_CPU_LOAD: val = st->cpuLoad; break;
+    case CO_CAN_SELFTEST_SUB_DURATION: val = st->duration_us; break;
+    default:
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    *countRead = CO_setUint32(buf, val);
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for writing OD object "CAN self-test"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_write_CANselfTest(OD_stream_t *stream, const void *buf,
+                                  OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0) {
+        return OD_writeOriginal(stream, buf, count, countWritten);
+    }
+    if (count != sizeof(uint32_t)) {
+        return ODR_TYPE_MISMATCH;
+    }
+
+    CO_CANselfTest_t *st = (CO_CANselfTest_t *)stream->object;
+    uint32_t val = CO_getUint32(buf);
+
+    /* configuration is used by the running test */
+    if (st->state == CO_CAN_SELFTEST_PENDING) {
+        return ODR_DATA_DEV_STATE;
+    }
+
+    switch (stream->subIndex) {
+    case CO_CAN_SELFTEST_SUB_COMMAND:
+        if (CO_CANselfTest_start(st, val) != CO_ERROR_NO) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    case CO_CAN_SELFTEST_SUB_IDENT:
+        if (val > 0x7FFU) {
+            return ODR_INVALID_VALUE;
+        }
+        st->ident = (uint16_t)val;
+        break;
+    case CO_CAN_SELFTEST_SUB_DLC:
+        if (val < 4U || val > 8U) {
+            return ODR_INVALID_VALUE;
+        }
+        st->DLC = (uint8_t)val;
+        break;
+    case CO_CAN_SELFTEST_SUB_PATTERN:
+        st->pattern = val;
+        break;
+    case CO_CAN_SELFTEST_SUB_RATE:
+    case CO_CAN_SELFTEST_SUB_LOST:
+    case CO_CAN_SELFTEST_SUB_ERRORS:
+    case CO_CAN_SELFTEST_SUB_CPU_LOAD:
+    case CO_CAN_SELFTEST_SUB_DURATION:
+        return ODR_READONLY;
+    default:
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    *countWritten = count;
+    return ODR_OK;
+}
+
+
+/* Data byte of test frame, after the sequence number */
+static inline uint8_t CO_CANselfTest_byte(CO_CANselfTest_t *st, uint32_t seq,
+                                          uint8_t i)
+{
+    return (uint8_t)(st->pattern >> (8U * (i - 4U))) ^ (uint8_t)seq;
+}
+
+
+/* Send test frames from free TX buffers, up to limit frames in total */
+static void CO_CANselfTest_fill(CO_CANselfTest_t *st,
+                                CO_CANmodule_t *CANmodule,
+                                uint32_t limit)
+{
+    for (uint8_t i = 0; i < CO_CAN_SELFTEST_WINDOW && st->sent < limit; i++) {
+        CO_CANtx_t *buffer = &st->tx[i];
+
+        if (buffer->bufferFull) {
+            continue;
+        }
+        (void)CO_setUint32(buffer->data, st->sent);
+        for (uint8_t j = 4; j < st->DLC; j++) {
+            buffer->data[j] = CO_CANselfTest_byte(st, st->sent, j);
+        }
+        (void)CO_CANsend(CANmodule, buffer);
+        st->sent++;
+    }
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANselfTest_init(CO_CANselfTest_t *st,
+                                     OD_entry_t *OD_selfTest)
+{
+    /* verify arguments */
+    if (st == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(st, 0, sizeof(CO_CANselfTest_t));
+    st->ident = 0x7F0;
+    st->DLC = 8;
+    st->pattern = 0x55AA33CC;
+
+    /* test is optionally started from Object Dictionary */
+    if (OD_selfTest != NULL) {
+        st->OD_selfTest_ext.object = st;
+        st->OD_selfTest_ext.read = OD_read_CANselfTest;
+        st->OD_selfTest_ext.write = OD_write_CANselfTest;
+        OD_extension_init(OD_selfTest, &st->OD_selfTest_ext);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANselfTest_start(CO_CANselfTest_t *st, uint32_t frames) {
+    if (frames == 0U || frames > CO_CAN_SELFTEST_FRAMES_MAX) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    st->frames = frames;
+    st->state = CO_CAN_SELFTEST_PENDING;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_CANselfTest_rx(CO_CANselfTest_t *st, const CO_CANrxMsg_t *rcvMsg) {
+    const uint8_t *data = rcvMsg->data;
+    uint32_t seq;
+    bool_t intact = rcvMsg->info.dlc == st->DLC;
+
+    if (rcvMsg->info.dlc < 4U) {
+        st->rxErrors++;
+        return;
+    }
+    seq = CO_getUint32(data);
+    for (uint8_t j = 4; intact && j < st->DLC; j++) {
+        intact = data[j] == CO_CANselfTest_byte(st, seq, j);
+    }
+
+    /* frames are sent in sequence, missing ones are counted as lost */
+    if (!intact || seq < st->received) {
+        st->rxErrors++;
+    }
+    st->received++;
+}
+
+
+/* Pause the stack, let the driver queue only test frames, enter loopback */
+static void CO_CANselfTest_begin(CO_CANselfTest_t *st,
+                                 CO_CANmodule_t *CANmodule)
+{
+    uint32_t idx = MXC_CAN_GET_IDX(CANmodule->CANptr);
+
+    st->txArray = CANmodule->txArray;
+    st->txSize = CANmodule->txSize;
+    st->CANnormal = CANmodule->CANnormal;
+
+    CANmodule->CANnormal = false;
+    CANmodule->txArray = st->tx;
+    CANmodule->txSize = CO_CAN_SELFTEST_WINDOW;
+    for (uint16_t i = 0; i < CO_CAN_SELFTEST_WINDOW; i++) {
+        (void)CO_CANtxBufferInit(CANmodule, i, st->ident, false, st->DLC, false);
+    }
+    st->sent = 0;
+    st->received = 0;
+    st->rxErrors = 0;
+    st->receivedLast = 0;
+    st->idleCal = 0;
+    st->idle = 0;
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_INITIALIZATION);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_LOOPBACK);
+    CANmodule->selfTest = st;
+}
+
+
+/* Drop frames, which were not sent, restore normal operation, set results */
+static void CO_CANselfTest_end(CO_CANselfTest_t *st,
+                               CO_CANmodule_t *CANmodule,
+                               uint32_t test_us)
+{
+    uint32_t idx = MXC_CAN_GET_IDX(CANmodule->CANptr);
+
+    CO_LOCK_CAN_SEND(CANmodule);
+    for (uint16_t i = 0; i < CO_CAN_SELFTEST_WINDOW; i++) {
+        st->tx[i].bufferFull = false;
+    }
+    CANmodule->CANtxCount = 0;
+    CANmodule->selfTest = NULL;
+    CANmodule->txArray = st->txArray;
+    CANmodule->txSize = st->txSize;
+    CO_UNLOCK_CAN_SEND(CANmodule);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_INITIALIZATION);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_NORMAL);
+    CANmodule->CANnormal = st->CANnormal;
+
+    uint32_t received = st->receivedLast;
+    st->duration_us = st->lastRx_us - st->start_us;
+    st->rate = st->duration_us > 0U
+             ? (uint32_t)((uint64_t)received * 1000000U / st->duration_us) : 0U;
+    st->lost = received < st->frames ? st->frames - received : 0U;
+    st->errors = st->rxErrors;
+    uint64_t idleFree = (uint64_t)st->idleCal * test_us;
+    uint64_t idleLoad = (uint64_t)st->idle * st->cal_us * 1000U;
+    st->cpuLoad = (idleFree > 0U && idleLoad < idleFree * 1000U)
+                ? 1000U - (uint32_t)(idleLoad / idleFree) : 0U;
+    st->phase = CO_CAN_SELFTEST_PHASE_START;
+    st->state = (st->lost == 0U && st->errors == 0U)
+              ? CO_CAN_SELFTEST_PASSED : CO_CAN_SELFTEST_FAILED;
+}
+
+
+/******************************************************************************/
+void CO_CANselfTest_process(CO_CANselfTest_t *st, CO_CANmodule_t *CANmodule,
+                            uint32_t *timerNext_us)
+{
+    if (st->state != CO_CAN_SELFTEST_PENDING) {
+        return;
+    }
+
+    /* mainline must not sleep, test progress is counted per call */
+    if (timerNext_us != NULL) {
+        *timerNext_us = 0;
+    }
+
+    if (st->phase == CO_CAN_SELFTEST_PHASE_START) {
+        /* last message of the stack must leave the controller first */
+        uint32_t canStat = ((mxc_can_regs_t *)CANmodule->CANptr)->stat;
+        if (CANmodule->CANtxCount != 0U
+            || (canStat & MXC_F_CAN_STAT_TXBUF) == 0U
+        ) {
+            return;
+        }
+        CO_CANselfTest_begin(st, CANmodule);
+        st->phase = CO_CAN_SELFTEST_PHASE_CAL;
+        st->start_us = CO_timer_us();
+        return;
+    }
+
+    /* Same body in both phases. Idle counter is calibrated with no traffic,
+     * during the test it is reduced by interrupts and tasks. */
+    bool_t test = st->phase == CO_CAN_SELFTEST_PHASE_TEST;
+    CO_CANselfTest_fill(st, CANmodule, test ? st->frames : 0U);
+    if (test) {
+        st->idle++;
+    } else {
+        st->idleCal++;
+    }
+    uint32_t now_us = CO_timer_us();
+    uint32_t received = st->received;
+    if (received != st->receivedLast) {
+        st->receivedLast = received;
+        st->lastRx_us = now_us;
+    }
+
+    if (!test) {
+        if ((now_us - st->start_us) >= (CO_CAN_SELFTEST_CAL_MS * 1000U)) {
+            st->cal_us = now_us - st->start_us;
+            st->phase = CO_CAN_SELFTEST_PHASE_TEST;
+            st->start_us = now_us;
+            st->lastRx_us = now_us;
+        }
+    }
+    else if (received >= st->frames
+             || (now_us - st->lastRx_us) >= (CO_CAN_SELFTEST_TIMEOUT_MS * 1000U)
+    ) {
+        CO_CANselfTest_end(st, CANmodule, now_us - st->start_us);
+    }
+}
+
+#endif /* (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE */
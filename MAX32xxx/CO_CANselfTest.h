@@ -0,0 +1,196 @@
+/*
+ * CAN loopback self-test, for MAX32xxx.
+ *
+ * @file        CO_CANselfTest.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CAN_SELFTEST_H
+#define CO_CAN_SELFTEST_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * End-of-line test of the CAN path without a second node. Started from the OD
+ * entry, test runs in steps from mainline: CAN controller is put into internal
+ * loopback mode (nothing is sent to the bus), CANopen stack is paused and
+ * frames are sent with CO_CANsend() as fast as the TX interrupt takes them.
+ * Received frames come through the normal RX path (receive slot, RX queue
+ * with FreeRTOS, CO_CANrxDispatch()). Each frame carries a sequence number in its
+ * first four data bytes and a pattern in the rest, so lost, reordered and
+ * corrupted frames are detected.
+ *
+ * CPU load is derived from an idle counter, incremented in each call of
+ * CO_CANselfTest_process(). It is calibrated with no traffic before the test
+ * by the same code, so it includes all CAN interrupt and task overhead, also
+ * of the MSDK driver.
+ */
+
+/* Default index of the manufacturer specific OD entry, see CO_CANselfTest_init() */
+#ifndef CO_CAN_SELFTEST_OD_INDEX
+#define CO_CAN_SELFTEST_OD_INDEX 0x2103
+#endif
+/* Number of TX buffers queued in CO_CANmodule_t during the test. */
+#ifndef CO_CAN_SELFTEST_WINDOW
+#define CO_CAN_SELFTEST_WINDOW 4
+#endif
+/* Calibration time of the idle counter. */
+#ifndef CO_CAN_SELFTEST_CAL_MS
+#define CO_CAN_SELFTEST_CAL_MS 10
+#endif
+/* Test ends, if no frame is received for this time. */
+#ifndef CO_CAN_SELFTEST_TIMEOUT_MS
+#define CO_CAN_SELFTEST_TIMEOUT_MS 100
+#endif
+/* Maximum number of frames in one test. */
+#ifndef CO_CAN_SELFTEST_FRAMES_MAX
+#define CO_CAN_SELFTEST_FRAMES_MAX 1000000UL
+#endif
+
+/**
+ * Sub-indexes of the self-test OD entry (RECORD of UNSIGNED32).
+ *
+ * - 1: write N starts the test with N frames, read returns
+ *   @ref CO_CAN_SELFTEST_IDLE and others.
+ * - 2: CAN identifier of test frames (11-bit), default 0x7F0.
+ * - 3: data length of test frames, 4 to 8, default 8.
+ * - 4: pattern, data bytes 4 to 7 are pattern bytes XOR sequence number.
+ * - 5: received frames per second in last test.
+ * - 6: lost frames in last test.
+ * - 7: reordered or corrupted frames in last test.
+ * - 8: CPU load during last test, in 0.1 %.
+ * - 9: duration of last test in microseconds.
+ */
+#define CO_CAN_SELFTEST_SUB_COMMAND     1
+#define CO_CAN_SELFTEST_SUB_IDENT       2
+#define CO_CAN_SELFTEST_SUB_DLC         3
+#define CO_CAN_SELFTEST_SUB_PATTERN     4
+#define CO_CAN_SELFTEST_SUB_RATE        5
+#define CO_CAN_SELFTEST_SUB_LOST        6
+#define CO_CAN_SELFTEST_SUB_ERRORS      7
+#define CO_CAN_SELFTEST_SUB_CPU_LOAD    8
+#define CO_CAN_SELFTEST_SUB_DURATION    9
+
+/* Test state, read from CO_CAN_SELFTEST_SUB_COMMAND */
+#define CO_CAN_SELFTEST_IDLE      0U  /* no test since reset */
+#define CO_CAN_SELFTEST_PENDING   1U  /* test requested or running */
+#define CO_CAN_SELFTEST_PASSED    2U  /* all frames received intact and in order */
+#define CO_CAN_SELFTEST_FAILED    3U
+
+/**
+ * CAN self-test object.
+ */
+typedef struct CO_CANselfTest {
+    /* Configuration */
+    uint32_t frames;
+    uint16_t ident;
+    uint8_t DLC;
+    uint32_t pattern;
+    /** CO_CAN_SELFTEST_IDLE or other */
+    volatile uint8_t state;
+    /* Results */
+    uint32_t rate;
+    uint32_t lost;
+    uint32_t errors;
+    uint32_t cpuLoad;
+    uint32_t duration_us;
+    /* Internal, used during the test */
+    CO_CANtx_t tx[CO_CAN_SELFTEST_WINDOW];
+    uint32_t sent;
+    volatile uint32_t received;
+    volatile uint32_t rxErrors;
+    uint8_t phase;
+    uint32_t receivedLast;
+    uint32_t idleCal;
+    uint32_t idle;
+    uint32_t cal_us;
+    uint32_t start_us;
+    uint32_t lastRx_us;
+    /* Stack state, restored after the test */
+    CO_CANtx_t *txArray;
+    uint16_t txSize;
+    bool_t CANnormal;
+    OD_extension_t OD_selfTest_ext;
+} CO_CANselfTest_t;
+
+
+/**
+ * Initialize CAN self-test object.
+ *
+ * @param st This object will be initialized.
+ * @param OD_selfTest Optional OD entry for starting the test and reading
+ * results, see @ref CO_CAN_SELFTEST_SUB_COMMAND. May be NULL.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANselfTest_init(CO_CANselfTest_t *st,
+                                     OD_entry_t *OD_selfTest);
+
+
+/**
+ * Request the test, it runs on the next CO_CANselfTest_process().
+ *
+ * @param st CAN self-test object.
+ * @param frames Number of frames, 1 to CO_CAN_SELFTEST_FRAMES_MAX.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANselfTest_start(CO_CANselfTest_t *st, uint32_t frames);
+
+
+/**
+ * Test frame received, called from CO_CANrxDispatch() during the test.
+ *
+ * @param st CAN self-test object.
+ * @param rcvMsg Received message.
+ */
+void CO_CANselfTest_rx(CO_CANselfTest_t *st, const CO_CANrxMsg_t *rcvMsg);
+
+
+/**
+ * Process requested test, called from mainline in every pass. Test starts,
+ * when no messages are queued, so response to the starting SDO is sent first.
+ * Each call sends frames to free TX buffers and returns. Test ends, when all
+ * frames are received or CO_CAN_SELFTEST_TIMEOUT_MS passes without reception.
+ * CAN module is in normal mode afterwards. Stack frames sent during the test
+ * are dropped.
+ *
+ * @param st CAN self-test object.
+ * @param CANmodule CAN module object.
+ * @param [out] timerNext_us Set to zero while test is pending, mainline must
+ * not sleep. May be NULL.
+ */
+void CO_CANselfTest_process(CO_CANselfTest_t *st, CO_CANmodule_t *CANmodule,
+                            uint32_t *timerNext_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE */
+
+#endif /* CO_CAN_SELFTEST_H */
@@ -0,0 +1,152 @@
+/*
+ * CAN bus load and traffic statistics for MAX32xxx.
+ *
+ * @file        CO_CANstats.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_CANstats.h"
+
+
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+
+/*
+ * Custom function for reading OD object "CAN statistics"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_CANstats(OD_stream_t *stream, void *buf,
+                              OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_CANstats_t *stats = (CO_CANstats_t *)stream->object;
+    uint8_t sub = stream->subIndex;
+    uint32_t val = 0;
+
+    if (sub == CO_CAN_STATS_SUB_BUS_LOAD) {
+        val = stats->busLoad;
+    }
+    else if (sub == CO_CAN_STATS_SUB_BUS_LOAD_PEAK) {
+        val = stats->busLoadPeak;
+    }
+    else if (sub == CO_CAN_STATS_SUB_RX_FRAMES) {
+        val = stats->rxFrames;
+    }
+    else if (sub == CO_CAN_STATS_SUB_TX_FRAMES) {
+        val = stats->txFrames;
+    }
+    else if (sub < CO_CAN_STATS_SUB_FRAMES) {
+        uint8_t i = sub - CO_CAN_STATS_SUB_TOP;
+        val = (stats->topFrames[i] << 8) | stats->topNode[i];
+    }
+    else if (sub < CO_CAN_STATS_SUB_BYTES) {
+        val = stats->frames[sub - CO_CAN_STATS_SUB_FRAMES];
+    }
+    else if (sub <= CO_CAN_STATS_SUB_COUNT) {
+        val = stats->bytes[sub - CO_CAN_STATS_SUB_BYTES];
+    }
+    else {
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    *countRead = CO_setUint32(buf, val);
+    return ODR_OK;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANstats_init(CO_CANstats_t *stats,
+                                  OD_entry_t *OD_stats,
+                                  uint16_t CANbitRate)
+{
+    /* verify arguments */
+    if (stats == NULL || CANbitRate == 0) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(stats, 0, sizeof(CO_CANstats_t));
+    stats->CANbitRate = CANbitRate;
+
+    /* statistics are optionally readable from Object Dictionary */
+    if (OD_stats != NULL) {
+        stats->OD_stats_ext.object = stats;
+        stats->OD_stats_ext.read = OD_read_CANstats;
+        stats->OD_stats_ext.write = NULL;
+        OD_extension_init(OD_stats, &stats->OD_stats_ext);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_CANstats_process(CO_CANstats_t *stats, uint32_t timeDifference_us) {
+    stats->window_us += timeDifference_us;
+    if (stats->window_us < (CO_CAN_STATS_WINDOW_MS * 1000UL)) {
+        return;
+    }
+
+    /* bus load = bits on the bus / bits available in the window, in 0.1 %.
+     * CANbitRate is in kbit/s, so bits available = CANbitRate * window_ms. */
+    uint32_t bits = stats->bits;
+    uint32_t window_ms = stats->window_us / 1000U;
+    uint64_t load = ((uint64_t)(bits - stats->bitsOld) * 1000U)
+                    / ((uint64_t)stats->CANbitRate * window_ms);
+    stats->bitsOld = bits;
+    stats->window_us = 0;
+    stats->busLoad = load > 1000U ? 1000U : (uint16_t)load;
+    if (stats->busLoad > stats->busLoadPeak) {
+        stats->busLoadPeak = stats->busLoad;
+    }
+
+    /* top talkers in the window, insertion into a short sorted list */
+    memset(stats->topNode, 0, sizeof(stats->topNode));
+    memset(stats->topFrames, 0, sizeof(stats->topFrames));
+    for (uint8_t node = 0; node < 128U; node++) {
+        uint32_t cnt = stats->nodeFrames[node];
+        uint32_t diff = cnt - stats->nodeFramesOld[node];
+        stats->nodeFramesOld[node] = cnt;
+
+        if (diff <= stats->topFrames[CO_CAN_STATS_TOP_N - 1]) {
+            continue;
+        }
+        uint8_t i = CO_CAN_STATS_TOP_N - 1;
+        while (i > 0 && diff > stats->topFrames[i - 1]) {
+            stats->topFrames[i] = stats->topFrames[i - 1];
+            stats->topNode[i] = stats->topNode[i - 1];
+            i--;
+        }
+        stats->topFrames[i] = diff;
+        stats->topNode[i] = node;
+    }
+}
+
+#endif /* (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE */
@@ -0,0 +1,219 @@
+/*
+ * CAN bus load and traffic statistics for MAX32xxx.
+ *
+ * @file        CO_CANstats.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CAN_STATS_H
+#define CO_CAN_STATS_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Length of the statistics window in milliseconds. */
+#ifndef CO_CAN_STATS_WINDOW_MS
+#define CO_CAN_STATS_WINDOW_MS 1000
+#endif
+/* Number of top talkers (nodes with most frames in last window). */
+#ifndef CO_CAN_STATS_TOP_N
+#define CO_CAN_STATS_TOP_N 4
+#endif
+/* Default index of the manufacturer specific OD entry, see CO_CANstats_init() */
+#ifndef CO_CAN_STATS_OD_INDEX
+#define CO_CAN_STATS_OD_INDEX 0x2100
+#endif
+
+/**
+ * CANopen message class, derived from 11-bit CAN identifier according to the
+ * CiA 301 pre-defined connection set.
+ */
+typedef enum {
+    CO_CAN_STATS_NMT,
+    CO_CAN_STATS_SYNC,
+    CO_CAN_STATS_EMCY,
+    CO_CAN_STATS_TIME,
+    CO_CAN_STATS_TPDO1,
+    CO_CAN_STATS_RPDO1,
+    CO_CAN_STATS_TPDO2,
+    CO_CAN_STATS_RPDO2,
+    CO_CAN_STATS_TPDO3,
+    CO_CAN_STATS_RPDO3,
+    CO_CAN_STATS_TPDO4,
+    CO_CAN_STATS_RPDO4,
+    CO_CAN_STATS_SDO_TX,
+    CO_CAN_STATS_SDO_RX,
+    CO_CAN_STATS_HB,
+    CO_CAN_STATS_LSS,
+    CO_CAN_STATS_OTHER,
+    CO_CAN_STATS_CLASS_COUNT
+} CO_CANstats_class_t;
+
+/**
+ * Sub-indexes of the statistics OD entry (ARRAY of UNSIGNED32, read-only).
+ *
+ * - 1: bus load in last window, in 0.1 %
+ * - 2: peak bus load since reset, in 0.1 %
+ * - 3: number of received frames
+ * - 4: number of transmitted frames
+ * - CO_CAN_STATS_SUB_TOP + i: i-th top talker in last window,
+ *   (frames << 8) | nodeId
+ * - CO_CAN_STATS_SUB_FRAMES + class: frames per @ref CO_CANstats_class_t
+ * - CO_CAN_STATS_SUB_BYTES + class: data bytes per @ref CO_CANstats_class_t
+ */
+#define CO_CAN_STATS_SUB_BUS_LOAD       1
+#define CO_CAN_STATS_SUB_BUS_LOAD_PEAK  2
+#define CO_CAN_STATS_SUB_RX_FRAMES      3
+#define CO_CAN_STATS_SUB_TX_FRAMES      4
+#define CO_CAN_STATS_SUB_TOP            5
+#define CO_CAN_STATS_SUB_FRAMES         (CO_CAN_STATS_SUB_TOP + CO_CAN_STATS_TOP_N)
+#define CO_CAN_STATS_SUB_BYTES          (CO_CAN_STATS_SUB_FRAMES + CO_CAN_STATS_CLASS_COUNT)
+#define CO_CAN_STATS_SUB_COUNT          (CO_CAN_STATS_SUB_BYTES + CO_CAN_STATS_CLASS_COUNT - 1)
+
+/* Length of classic CAN frame with standard identifier in bits, without stuff
+ * bits: SOF, ID, RTR, IDE, r0, DLC, data, CRC, delimiters, ACK, EOF and IFS. */
+#define CO_CAN_STATS_FRAME_BITS(dlc) (47U + 8U * (uint32_t)(dlc))
+
+/**
+ * CAN statistics object.
+ *
+ * Counters are incremented from CAN interrupt, other members are calculated
+ * in CO_CANstats_process().
+ */
+typedef struct CO_CANstats {
+    /** Frames per message class */
+    volatile uint32_t frames[CO_CAN_STATS_CLASS_COUNT];
+    /** Data bytes per message class */
+    volatile uint32_t bytes[CO_CAN_STATS_CLASS_COUNT];
+    /** Frames per node-ID (lower 7 bits of CAN identifier), only EMCY,
+     * PDO, SDO and heartbeat carry node-ID */
+    volatile uint32_t nodeFrames[128];
+    /** Sum of frame lengths in bits, used for bus load */
+    volatile uint32_t bits;
+    volatile uint32_t rxFrames;
+    volatile uint32_t txFrames;
+    /** Bus load in last window in 0.1 % */
+    uint16_t busLoad;
+    /** Peak bus load in 0.1 % */
+    uint16_t busLoadPeak;
+    /** Node-IDs with most frames in last window, sorted descending */
+    uint8_t topNode[CO_CAN_STATS_TOP_N];
+    /** Number of frames of topNode in last window */
+    uint32_t topFrames[CO_CAN_STATS_TOP_N];
+    /* Internal */
+    uint32_t nodeFramesOld[128];
+    uint32_t bitsOld;
+    uint32_t window_us;
+    uint16_t CANbitRate;
+    OD_extension_t OD_stats_ext;
+} CO_CANstats_t;
+
+
+/**
+ * Initialize CAN statistics object.
+ *
+ * @param stats This object will be initialized.
+ * @param OD_stats Optional OD entry for reading statistics, see
+ * @ref CO_CAN_STATS_SUB_BUS_LOAD. May be NULL.
+ * @param CANbitRate CAN bit rate in kbit/s, used for bus load.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANstats_init(CO_CANstats_t *stats,
+                                  OD_entry_t *OD_stats,
+                                  uint16_t CANbitRate);
+
+
+/**
+ * Account one CAN frame. Called from CAN interrupt for received and sent
+ * frames, costs a table lookup and few counter increments.
+ *
+ * @param stats CAN statistics object.
+ * @param ident CAN identifier, as in CO_CANrxMsg_t.
+ * @param DLC Data length.
+ * @param tx True for transmitted frame.
+ */
+static inline void CO_CANstats_frame(CO_CANstats_t *stats,
+                                     uint32_t ident,
+                                     uint8_t DLC,
+                                     bool_t tx)
+{
+    /* message class by function code (upper 4 bits of 11-bit identifier) */
+    static const uint8_t fcClass[16] CO_RAMCONST = {
+        CO_CAN_STATS_NMT,    CO_CAN_STATS_EMCY,   CO_CAN_STATS_TIME,
+        CO_CAN_STATS_TPDO1,  CO_CAN_STATS_RPDO1,  CO_CAN_STATS_TPDO2,
+        CO_CAN_STATS_RPDO2,  CO_CAN_STATS_TPDO3,  CO_CAN_STATS_RPDO3,
+        CO_CAN_STATS_TPDO4,  CO_CAN_STATS_RPDO4,  CO_CAN_STATS_SDO_TX,
+        CO_CAN_STATS_SDO_RX, CO_CAN_STATS_OTHER,  CO_CAN_STATS_HB,
+        CO_CAN_STATS_OTHER
+    };
+    uint16_t id = (uint16_t)(ident & 0x7FFU);
+    uint8_t cls = fcClass[id >> 7];
+
+    if (id == 0x080U) {
+        cls = CO_CAN_STATS_SYNC;
+    }
+    else if (id == 0x7E4U || id == 0x7E5U) {
+        cls = CO_CAN_STATS_LSS;
+    }
+    if (DLC > 8U) {
+        DLC = 8U;
+    }
+
+    stats->frames[cls]++;
+    stats->bytes[cls] += DLC;
+    if ((id & 0x7FU) != 0U && cls != CO_CAN_STATS_NMT && cls != CO_CAN_STATS_SYNC
+        && cls != CO_CAN_STATS_TIME && cls != CO_CAN_STATS_LSS
+        && cls != CO_CAN_STATS_OTHER
+    ) {
+        stats->nodeFrames[id & 0x7FU]++;
+    }
+    stats->bits += CO_CAN_STATS_FRAME_BITS(DLC);
+    if (tx) {
+        stats->txFrames++;
+    }
+    else {
+        stats->rxFrames++;
+    }
+}
+
+
+/**
+ * Process CAN statistics: calculate bus load and top talkers at the end of
+ * each window. Called cyclically from mainline.
+ *
+ * @param stats CAN statistics object.
+ * @param timeDifference_us Time difference from previous function call.
+ */
+void CO_CANstats_process(CO_CANstats_t *stats, uint32_t timeDifference_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE */
+
+#endif /* CO_CAN_STATS_H */
@@ -0,0 +1,360 @@
+/*
+ * CAN trace recorder for MAX32xxx.
+ *
+ * @file        CO_CANtrace.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_CANtrace.h"
+
+
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+
+#define TRACE_IDX(cnt) ((cnt) & (CO_CAN_TRACE_SIZE - 1U))
+
+/* Index of the oldest frame in the trace. Comparing wrCnt with the buffer
+ * size fails after wrCnt wraps, so filled buffer is flagged separately. */
+static uint32_t CO_CANtrace_first(CO_CANtrace_t *trace) {
+    bool_t full = trace->full;
+    uint32_t wrCnt = trace->wrCnt;
+    return full ? (wrCnt - CO_CAN_TRACE_SIZE) : 0U;
+}
+
+
+/*
+ * Format next frame from dump position into trace->line in candump log
+ * format. Frames overwritten in meantime are skipped and counted as lost.
+ *
+ * @return false, if there are no more frames.
+ */
+static bool_t CO_CANtrace_nextLine(CO_CANtrace_t *trace) {
+    CO_CANtrace_entry_t entry;
+
+    for (;;) {
+        uint32_t first = CO_CANtrace_first(trace);
+
+        if ((int32_t)(first - trace->dumpCnt) > 0) {
+            trace->lost += first - trace->dumpCnt;
+            trace->dumpCnt = first;
+        }
+        if ((int32_t)(trace->dumpEnd - trace->dumpCnt) <= 0) {
+            return false;
+        }
+
+        entry = trace->entries[TRACE_IDX(trace->dumpCnt)];
+        /* verify, entry was not overwritten while copying */
+        if ((trace->wrCnt - trace->dumpCnt) <= CO_CAN_TRACE_SIZE) {
+            break;
+        }
+    }
+    trace->dumpCnt++;
+
+    char *p = trace->line;
+    char *end = trace->line + sizeof(trace->line);
+    uint32_t ident = entry.ident;
+
+    p += snprintf(p, end - p, "(%010lu.%06lu) %s ",
+                  (unsigned long)(entry.timestamp_us / 1000000U),
+                  (unsigned long)(entry.timestamp_us % 1000000U),
+                  (ident & CO_CAN_TRACE_TX) ? "tx" : "rx");
+    if (ident & MXC_CAN_MSG_INFO_IDE_BIT) {
+        p += snprintf(p, end - p, "%08lX#", (unsigned long)(ident & 0x1FFFFFFFUL));
+    }
+    else {
+        p += snprintf(p, end - p, "%03lX#", (unsigned long)(ident & 0x7FFUL));
+    }
+    if (ident & CO_CAN_TRACE_RTR) {
+        *p++ = 'R';
+    }
+    else {
+        for (uint8_t i = 0; i < entry.DLC && i < 8U; i++) {
+            p += snprintf(p, end - p, "%02X", entry.data[i]);
+        }
+    }
+    *p++ = '\n';
+
+    trace->linePos = 0;
+    trace->lineLen = (uint8_t)(p - trace->line);
+    return true;
+}
+
+
+/* Start dump of all frames currently in the trace */
+static void CO_CANtrace_dumpStart(CO_CANtrace_t *trace) {
+    trace->dumpCnt = CO_CANtrace_first(trace);
+    trace->dumpEnd = trace->wrCnt;
+    trace->linePos = 0;
+    trace->lineLen = 0;
+}
+
+
+/*
+ * Custom function for reading OD object "CAN trace"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_CANtrace(OD_stream_t *stream, void *buf,
+                              OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_CANtrace_t *trace = (CO_CANtrace_t *)stream->object;
+    uint32_t val;
+
+    switch (stream->subIndex) {
+    case CO_CAN_TRACE_SUB_DUMP: {
+        /* New SDO upload starts with dataOffset 0 */
+        if (stream->dataOffset == 0) {
+            CO_CANtrace_dumpStart(trace);
+        }
+
+        uint8_t *b = (uint8_t *)buf;
+        OD_size_t n = 0;
+        bool_t more = true;
+
+        while (n < count) {
+            if (trace->linePos >= trace->lineLen
+                && !CO_CANtrace_nextLine(trace)
+            ) {
+                more = false;
+                break;
+            }
+            OD_size_t len = trace->lineLen - trace->linePos;
+            if (len > (count - n)) {
+                len = count - n;
+            }
+            memcpy(&b[n], &trace->line[trace->linePos], len);
+            trace->linePos += len;
+            n += len;
+        }
+        /* buffer may end exactly at the end of the last frame */
+        if (more && trace->linePos >= trace->lineLen
+            && (int32_t)(trace->dumpEnd - trace->dumpCnt) <= 0
+        ) {
+            more = false;
+        }
+
+        *countRead = n;
+        if (more) {
+            stream->dataOffset += n;
+            return ODR_PARTIAL;
+        }
+        stream->dataOffset = 0;
+        return ODR_OK;
+    }
+    case CO_CAN_TRACE_SUB_FILTER_IDENT: val = trace->filterIdent; break;
+    case CO_CAN_TRACE_SUB_FILTER_MASK:  val = trace->filterMask; break;
+    case CO_CAN_TRACE_SUB_ENABLE:       val = trace->enabled ? 1U : 0U; break;
+    case CO_CAN_TRACE_SUB_LOST:         val = trace->lost; break;
+    case CO_CAN_TRACE_SUB_REPLAY:       val = trace->replaySpeed; break;
+    default:
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+    *countRead = CO_setUint32(buf, val);
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for writing OD object "CAN trace"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_write_CANtrace(OD_stream_t *stream, const void *buf,
+                               OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex < CO_CAN_TRACE_SUB_FILTER_IDENT) {
+        return OD_writeOriginal(stream, buf, count, countWritten);
+    }
+    if (count != sizeof(uint32_t)) {
+        return ODR_TYPE_MISMATCH;
+    }
+
+    CO_CANtrace_t *trace = (CO_CANtrace_t *)stream->object;
+    uint32_t val = CO_getUint32(buf);
+
+    switch (stream->subIndex) {
+    case CO_CAN_TRACE_SUB_FILTER_IDENT: trace->filterIdent = val; break;
+    case CO_CAN_TRACE_SUB_FILTER_MASK:  trace->filterMask = val; break;
+    case CO_CAN_TRACE_SUB_ENABLE:
+        if (val > 1U) {
+            return ODR_INVALID_VALUE;
+        }
+        trace->enabled = val != 0U;
+        break;
+    case CO_CAN_TRACE_SUB_LOST: {
+        /* CO_CANtrace_record() runs in CAN interrupt */
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        trace->wrCnt = 0;
+        trace->full = false;
+        trace->lost = 0;
+        __set_PRIMASK(primask);
+        break;
+    }
+    case CO_CAN_TRACE_SUB_REPLAY:
+        CO_CANtrace_replayStart(trace, val);
+        break;
+    default:
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    *countWritten = count;
+    return ODR_OK;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_CANtrace_init(CO_CANtrace_t *trace, OD_entry_t *OD_trace) {
+    /* verify arguments */
+    if (trace == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(trace, 0, sizeof(CO_CANtrace_t));
+    trace->enabled = true;
+
+    /* trace is optionally accessible from Object Dictionary */
+    if (OD_trace != NULL) {
+        trace->OD_trace_ext.object = trace;
+        trace->OD_trace_ext.read = OD_read_CANtrace;
+        trace->OD_trace_ext.write = OD_write_CANtrace;
+        OD_extension_init(OD_trace, &trace->OD_trace_ext);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_CANtrace_record(CO_CANtrace_t *trace, uint32_t ident, uint8_t DLC,
+                        const uint8_t *data, bool_t tx)
+{
+    if (!trace->enabled
+        || ((ident ^ trace->filterIdent) & trace->filterMask) != 0U
+    ) {
+        return;
+    }
+
+    if (DLC > 8U) {
+        DLC = 8U;
+    }
+
+    /* Fill and publish entry. Frames are recorded from CAN interrupt and
+     * from CO_CANsend(), which may be interrupted, so dump or replay never
+     * sees a half-written entry below wrCnt. */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    CO_CANtrace_entry_t *entry = &trace->entries[TRACE_IDX(trace->wrCnt)];
+    entry->timestamp_us = CO_timer_us();
+    entry->ident = ident | (tx ? CO_CAN_TRACE_TX : 0U);
+    entry->DLC = DLC;
+    memcpy(entry->data, data, DLC);
+    trace->wrCnt++;
+    if (trace->wrCnt == CO_CAN_TRACE_SIZE) {
+        trace->full = true;
+    }
+    __set_PRIMASK(primask);
+}
+
+
+/******************************************************************************/
+void CO_CANtrace_print(CO_CANtrace_t *trace) {
+    CO_CANtrace_dumpStart(trace);
+    while (CO_CANtrace_nextLine(trace)) {
+        fwrite(trace->line, 1, trace->lineLen, stdout);
+    }
+    trace->linePos = trace->lineLen = 0;
+    fflush(stdout);
+}
+
+
+/******************************************************************************/
+void CO_CANtrace_replayStart(CO_CANtrace_t *trace, uint32_t speed) {
+    trace->replaySpeed = 0;
+    if (speed == 0U) {
+        trace->enabled = true;
+        return;
+    }
+
+    trace->enabled = false;
+    trace->replayCnt = CO_CANtrace_first(trace);
+    trace->replayEnd = trace->wrCnt;
+    trace->replayT0_us = trace->entries[TRACE_IDX(trace->replayCnt)].timestamp_us;
+    trace->replayStart_us = CO_timer_us();
+    trace->replaySpeed = speed;
+}
+
+
+/******************************************************************************/
+void CO_CANtrace_process(CO_CANtrace_t *trace, CO_CANmodule_t *CANmodule) {
+    if (trace->replaySpeed == 0U) {
+        return;
+    }
+
+    uint64_t elapsed = (uint64_t)(CO_timer_us() - trace->replayStart_us)
+                       * trace->replaySpeed;
+
+    while (trace->replayCnt != trace->replayEnd) {
+        CO_CANtrace_entry_t *entry = &trace->entries[TRACE_IDX(trace->replayCnt)];
+
+        if ((entry->timestamp_us - trace->replayT0_us) > elapsed) {
+            break;
+        }
+        if (entry->ident & CO_CAN_TRACE_TX) {
+            trace->replayCnt++;
+            continue;
+        }
+
+        CO_CANrxMsg_t msg = {0};
+        msg.info.msg_id = entry->ident & ~(CO_CAN_TRACE_TX | CO_CAN_TRACE_RTR);
+        msg.info.rtr = (entry->ident & CO_CAN_TRACE_RTR) ? 1 : 0;
+        msg.info.dlc = entry->DLC;
+        memcpy(msg.data, entry->data, entry->DLC);
+
+        /* Frame goes through CAN interrupt and the same RX path as received
+         * frames. If previous frame is not taken yet, retry next time. */
+        if (!CO_CANrxInject(CANmodule, &msg)) {
+            break;
+        }
+        trace->replayCnt++;
+    }
+
+    if (trace->replayCnt == trace->replayEnd) {
+        trace->replaySpeed = 0;
+        trace->enabled = true;
+    }
+}
+
+#endif /* (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE */
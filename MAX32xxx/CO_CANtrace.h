@@ -0,0 +1,175 @@
+/*
+ * CAN trace recorder for MAX32xxx.
+ *
+ * @file        CO_CANtrace.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CAN_TRACE_H
+#define CO_CAN_TRACE_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of frames in the trace buffer, must be power of 2. */
+#ifndef CO_CAN_TRACE_SIZE
+#define CO_CAN_TRACE_SIZE 256
+#endif
+/* Default index of the manufacturer specific OD entry, see CO_CANtrace_init() */
+#ifndef CO_CAN_TRACE_OD_INDEX
+#define CO_CAN_TRACE_OD_INDEX 0x2101
+#endif
+
+/* Flags in CO_CANtrace_entry_t.ident, besides MXC_CAN_MSG_INFO_IDE_BIT */
+#define CO_CAN_TRACE_TX  0x40000000UL
+#define CO_CAN_TRACE_RTR 0x20000000UL
+
+/**
+ * Sub-indexes of the trace OD entry (RECORD).
+ *
+ * - 1 DOMAIN: read returns the trace in candump log format, one line per
+ *   frame: "(sec.usec) rx 123#0102". Received frames use interface name "rx",
+ *   transmitted "tx", so the file can be replayed with
+ *   "canplayer -I trace.log can0=rx".
+ * - 2 UNSIGNED32: filter identifier.
+ * - 3 UNSIGNED32: filter mask, frame is recorded if
+ *   ((ident ^ filterIdent) & filterMask) == 0. Mask 0 records all frames.
+ * - 4 UNSIGNED32: recording enabled (0 or 1).
+ * - 5 UNSIGNED32: number of frames lost (overwritten before read). Any write
+ *   clears the trace.
+ * - 6 UNSIGNED32: replay speed. Writing N > 0 replays received frames from
+ *   the trace into the own node at N-times original speed, 0 stops replay.
+ */
+#define CO_CAN_TRACE_SUB_DUMP           1
+#define CO_CAN_TRACE_SUB_FILTER_IDENT   2
+#define CO_CAN_TRACE_SUB_FILTER_MASK    3
+#define CO_CAN_TRACE_SUB_ENABLE         4
+#define CO_CAN_TRACE_SUB_LOST           5
+#define CO_CAN_TRACE_SUB_REPLAY         6
+
+/**
+ * One recorded CAN frame.
+ */
+typedef struct {
+    /** Time of reception or transmission request, see CO_timer_us() */
+    uint32_t timestamp_us;
+    /** CAN identifier with CO_CAN_TRACE_TX, CO_CAN_TRACE_RTR and IDE flags */
+    uint32_t ident;
+    uint8_t DLC;
+    uint8_t data[8];
+} CO_CANtrace_entry_t;
+
+/**
+ * CAN trace object.
+ */
+typedef struct CO_CANtrace {
+    CO_CANtrace_entry_t entries[CO_CAN_TRACE_SIZE];
+    /** Free running count of recorded frames, entry index is its lower bits */
+    volatile uint32_t wrCnt;
+    /** Buffer was filled since last clear, oldest frames are overwritten */
+    volatile bool_t full;
+    /** Frames lost in dump, because they were overwritten */
+    uint32_t lost;
+    uint32_t filterIdent;
+    uint32_t filterMask;
+    volatile bool_t enabled;
+    /* Internal, dump state */
+    uint32_t dumpCnt;
+    uint32_t dumpEnd;
+    char line[64];
+    uint8_t linePos;
+    uint8_t lineLen;
+    /* Internal, replay state */
+    uint32_t replayCnt;
+    uint32_t replayEnd;
+    uint32_t replayStart_us;
+    uint32_t replayT0_us;
+    uint32_t replaySpeed;
+    OD_extension_t OD_trace_ext;
+} CO_CANtrace_t;
+
+
+/**
+ * Initialize CAN trace object. Recording is enabled for all frames.
+ *
+ * @param trace This object will be initialized.
+ * @param OD_trace Optional OD entry for reading and controlling the trace, see
+ * @ref CO_CAN_TRACE_SUB_DUMP. May be NULL.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_CANtrace_init(CO_CANtrace_t *trace, OD_entry_t *OD_trace);
+
+
+/**
+ * Record one CAN frame into circular buffer, oldest frame is overwritten.
+ * Called from CAN receive interrupt and from CO_CANsend().
+ *
+ * @param trace CAN trace object.
+ * @param ident CAN identifier, as in CO_CANrxMsg_t.
+ * @param DLC Data length.
+ * @param data Frame data.
+ * @param tx True for transmitted frame.
+ */
+void CO_CANtrace_record(CO_CANtrace_t *trace, uint32_t ident, uint8_t DLC,
+                        const uint8_t *data, bool_t tx);
+
+
+/**
+ * Print the whole trace in candump log format with printf(), for example to
+ * the debug UART. Blocking, call only from mainline.
+ *
+ * @param trace CAN trace object.
+ */
+void CO_CANtrace_print(CO_CANtrace_t *trace);
+
+
+/**
+ * Start replay of received frames from the trace into own node. Recording is
+ * disabled during replay.
+ *
+ * @param trace CAN trace object.
+ * @param speed Replay speed, 1 for original speed, N for N-times faster.
+ */
+void CO_CANtrace_replayStart(CO_CANtrace_t *trace, uint32_t speed);
+
+
+/**
+ * Process replay. Frames which are due are passed to CO_CANrxInject(), so they
+ * take the same RX path as received frames. Called cyclically from mainline.
+ *
+ * @param trace CAN trace object.
+ * @param CANmodule CAN module, which receives replayed frames.
+ */
+void CO_CANtrace_process(CO_CANtrace_t *trace, CO_CANmodule_t *CANmodule);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE */
+
+#endif /* CO_CAN_TRACE_H */
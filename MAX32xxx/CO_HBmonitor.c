@@ -0,0 +1,279 @@
+/*
+ * Heartbeat monitor for all nodes of the network, for MAX32xxx.
+ *
+ * @file        CO_HBmonitor.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_HBmonitor.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+
+/* Deadline queues are modified by CO_HBmonitor_frame() in CAN interrupt or
+ * CAN RX task, mainline locks them. */
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+#define HB_MON_LOCK()   taskENTER_CRITICAL()
+#define HB_MON_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define HB_MON_LOCK()   uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define HB_MON_UNLOCK() __set_PRIMASK(primask)
+#endif
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+#if defined(__riscv)
+#error "CO_CONFIG_HB_MON_CYCLES requires Cortex-M DWT cycle counter"
+#endif
+#define HB_MON_CYCLES() (DWT->CYCCNT)
+#endif
+
+
+/* Remove node from its deadline queue */
+static void CO_HBmonitor_unlink(CO_HBmonitor_t *hbMon, uint8_t nodeId) {
+    CO_HBmonitor_node_t *node = &hbMon->node[nodeId];
+    CO_HBmonitor_queue_t *q = &hbMon->queue[node->queue];
+
+    if (node->prev != CO_HB_MON_NONE) {
+        hbMon->node[node->prev].next = node->next;
+    }
+    else {
+        q->head = node->next;
+    }
+    if (node->next != CO_HB_MON_NONE) {
+        hbMon->node[node->next].prev = node->prev;
+    }
+    else {
+        q->tail = node->prev;
+    }
+    node->prev = CO_HB_MON_NONE;
+    node->next = CO_HB_MON_NONE;
+}
+
+
+/* Append node to the end of its deadline queue. All nodes in the queue have
+ * the same consumer time, so the queue stays ordered by deadline. */
+static void CO_HBmonitor_append(CO_HBmonitor_t *hbMon, uint8_t nodeId) {
+    CO_HBmonitor_node_t *node = &hbMon->node[nodeId];
+    CO_HBmonitor_queue_t *q = &hbMon->queue[node->queue];
+
+    node->prev = q->tail;
+    node->next = CO_HB_MON_NONE;
+    if (q->tail != CO_HB_MON_NONE) {
+        hbMon->node[q->tail].next = nodeId;
+    }
+    else {
+        q->head = nodeId;
+    }
+    q->tail = nodeId;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_HBmonitor_init(CO_HBmonitor_t *hbMon,
+                                   CO_CANmodule_t *CANmodule,
+                                   uint16_t time_ms,
+                                   uint8_t ownNodeId)
+{
+    /* verify arguments */
+    if (hbMon == NULL || CANmodule == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(hbMon, 0, sizeof(CO_HBmonitor_t));
+
+    if (time_ms != 0U) {
+        hbMon->queue[0].time_us = (uint32_t)time_ms * 1000U;
+        hbMon->queues = 1;
+        for (uint8_t nodeId = 1; nodeId <= 127U; nodeId++) {
+            if (nodeId != ownNodeId) {
+                hbMon->node[nodeId].state = CO_HB_MON_UNKNOWN;
+            }
+        }
+    }
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    CANmodule->hbMonitor = hbMon;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_HBmonitor_setTime(CO_HBmonitor_t *hbMon,
+                                      uint8_t nodeId,
+                                      uint16_t time_ms)
+{
+    uint32_t time_us = (uint32_t)time_ms * 1000U;
+    uint8_t q;
+
+    if (hbMon == NULL || nodeId < 1U || nodeId > 127U) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* find or add deadline queue for this consumer time */
+    for (q = 0; q < hbMon->queues; q++) {
+        if (hbMon->queue[q].time_us == time_us) {
+            break;
+        }
+    }
+    if (time_ms == 0U) {
+        q = 0;
+    }
+    else if (q == hbMon->queues) {
+        if (hbMon->queues >= CO_HB_MON_QUEUES) {
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+        hbMon->queue[q].time_us = time_us;
+        hbMon->queue[q].head = CO_HB_MON_NONE;
+        hbMon->queue[q].tail = CO_HB_MON_NONE;
+        hbMon->queues++;
+    }
+
+    CO_HBmonitor_node_t *node = &hbMon->node[nodeId];
+    HB_MON_LOCK();
+    if (node->state == CO_HB_MON_ACTIVE) {
+        CO_HBmonitor_unlink(hbMon, nodeId);
+        hbMon->activeCount--;
+    }
+    node->queue = q;
+    node->state = (time_ms != 0U) ? CO_HB_MON_UNKNOWN : CO_HB_MON_UNCONFIGURED;
+    HB_MON_UNLOCK();
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_HBmonitor_initCallbackTimeout(CO_HBmonitor_t *hbMon,
+                                      void *object,
+                                      void (*pFunctSignal)(void *object,
+                                                           uint8_t nodeId))
+{
+    if (hbMon != NULL) {
+        hbMon->functSignalObject = object;
+        hbMon->pFunctSignalTimeout = pFunctSignal;
+    }
+}
+
+
+/******************************************************************************/
+void CO_HBmonitor_frame(CO_HBmonitor_t *hbMon, uint8_t nodeId,
+                        uint8_t nmtState)
+{
+    CO_HBmonitor_node_t *node = &hbMon->node[nodeId];
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+    uint32_t start = HB_MON_CYCLES();
+#endif
+
+    if (node->state == CO_HB_MON_UNCONFIGURED) {
+        return;
+    }
+
+    node->nmtState = nmtState;
+    node->deadline_us = CO_timer_us() + hbMon->queue[node->queue].time_us;
+    if (node->state == CO_HB_MON_ACTIVE) {
+        /* already in queue, move to the end */
+        if (hbMon->queue[node->queue].tail != nodeId) {
+            CO_HBmonitor_unlink(hbMon, nodeId);
+            CO_HBmonitor_append(hbMon, nodeId);
+        }
+    }
+    else {
+        CO_HBmonitor_append(hbMon, nodeId);
+        node->state = CO_HB_MON_ACTIVE;
+        hbMon->activeCount++;
+    }
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+    uint32_t cycles = HB_MON_CYCLES() - start;
+    if (cycles > hbMon->frameCyclesMax) {
+        hbMon->frameCyclesMax = cycles;
+    }
+#endif
+}
+
+
+/******************************************************************************/
+void CO_HBmonitor_process(CO_HBmonitor_t *hbMon, uint32_t *timerNext_us) {
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+    uint32_t start = HB_MON_CYCLES();
+#endif
+    uint32_t now = CO_timer_us();
+
+    for (uint8_t q = 0; q < hbMon->queues; q++) {
+        CO_HBmonitor_queue_t *queue = &hbMon->queue[q];
+
+        for (;;) {
+            uint8_t nodeId = CO_HB_MON_NONE;
+            bool_t waiting = false;
+            uint32_t deadline = 0;
+
+            /* only the first node in the queue may be late */
+            HB_MON_LOCK();
+            if (queue->head != CO_HB_MON_NONE) {
+                deadline = hbMon->node[queue->head].deadline_us;
+                if ((int32_t)(now - deadline) >= 0) {
+                    nodeId = queue->head;
+                    CO_HBmonitor_unlink(hbMon, nodeId);
+                    hbMon->node[nodeId].state = CO_HB_MON_TIMEOUT;
+                    hbMon->activeCount--;
+                }
+                else {
+                    waiting = true;
+                }
+            }
+            HB_MON_UNLOCK();
+
+            if (nodeId == CO_HB_MON_NONE) {
+                if (waiting && timerNext_us != NULL) {
+                    uint32_t diff = deadline - now;
+                    if (*timerNext_us > diff) {
+                        *timerNext_us = diff;
+                    }
+                }
+                break;
+            }
+
+            hbMon->timeouts++;
+            CO_LOG(CO_LOG_HB_MON_TIMEOUT, nodeId, hbMon->timeouts);
+            if (hbMon->pFunctSignalTimeout != NULL) {
+                hbMon->pFunctSignalTimeout(hbMon->functSignalObject, nodeId);
+            }
+        }
+    }
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES
+    hbMon->processCycles = HB_MON_CYCLES() - start;
+    if (hbMon->processCycles > hbMon->processCyclesMax) {
+        hbMon->processCyclesMax = hbMon->processCycles;
+    }
+#endif
+}
+
+#endif /* (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE */
@@ -0,0 +1,208 @@
+/*
+ * Heartbeat monitor for all nodes of the network, for MAX32xxx.
+ *
+ * @file        CO_HBmonitor.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_HB_MONITOR_H
+#define CO_HB_MONITOR_H
+
+#include "301/CO_driver.h"
+
+#if ((CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Heartbeat monitor receives heartbeats 0x701..0x77F of all nodes. CAN driver
+ * passes them directly from CO_CANrxDispatch(), before rxArray is searched,
+ * and the node is found by its node-ID, not by search. rxArray is searched
+ * afterwards only if the heartbeat consumer of the stack (0x1016) has
+ * registered a heartbeat receive buffer.
+ *
+ * Nodes with the same consumer time are kept in one deadline queue, ordered
+ * by deadline: received heartbeat moves the node to the end of its queue.
+ * CO_HBmonitor_process() checks only the first node of each queue. Cost of a
+ * heartbeat and of each process call therefore does not depend on the number
+ * of monitored nodes.
+ *
+ * As in CiA 301 heartbeat consumer, monitoring of a node starts with its
+ * first heartbeat and stops after timeout, until the next heartbeat.
+ */
+
+/* Default consumer time for all nodes, used by main file. */
+#ifndef CO_HB_MON_TIME_MS
+#define CO_HB_MON_TIME_MS 1500
+#endif
+/* Maximum number of different consumer times (deadline queues). */
+#ifndef CO_HB_MON_QUEUES
+#define CO_HB_MON_QUEUES 4
+#endif
+
+/** Monitoring state of a node, CO_HBmonitor_node_t.state */
+#define CO_HB_MON_UNCONFIGURED  0U  /* consumer time is 0 */
+#define CO_HB_MON_UNKNOWN       1U  /* no heartbeat received yet */
+#define CO_HB_MON_ACTIVE        2U  /* heartbeats received in time */
+#define CO_HB_MON_TIMEOUT       3U  /* heartbeat missed */
+
+/* No node, end of deadline queue */
+#define CO_HB_MON_NONE 0U
+
+/**
+ * Monitored node, indexed by node-ID.
+ */
+typedef struct {
+    uint32_t deadline_us;
+    /** Neighbours in deadline queue, node-ID or CO_HB_MON_NONE */
+    uint8_t prev;
+    uint8_t next;
+    /** Deadline queue by consumer time */
+    uint8_t queue;
+    volatile uint8_t state;
+    /** NMT state from the last heartbeat */
+    volatile uint8_t nmtState;
+} CO_HBmonitor_node_t;
+
+/**
+ * Deadline queue, nodes with the same consumer time.
+ */
+typedef struct {
+    uint32_t time_us;
+    uint8_t head;
+    uint8_t tail;
+} CO_HBmonitor_queue_t;
+
+/**
+ * Heartbeat monitor object.
+ */
+typedef struct CO_HBmonitor {
+    /** Nodes, index 0 is not used */
+    CO_HBmonitor_node_t node[128];
+    CO_HBmonitor_queue_t queue[CO_HB_MON_QUEUES];
+    uint8_t queues;
+    /** Nodes in CO_HB_MON_ACTIVE state */
+    uint8_t activeCount;
+    /** Total number of timeouts */
+    uint32_t timeouts;
+    /** Called from CO_HBmonitor_process() on timeout, may be NULL */
+    void (*pFunctSignalTimeout)(void *object, uint8_t nodeId);
+    void *functSignalObject;
+#if ((CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_CYCLES) || defined CO_DOXYGEN
+    /** CPU cycles of the last and the longest CO_HBmonitor_process() call */
+    uint32_t processCycles;
+    uint32_t processCyclesMax;
+    /** CPU cycles of the longest CO_HBmonitor_frame() call */
+    uint32_t frameCyclesMax;
+#endif
+} CO_HBmonitor_t;
+
+
+/**
+ * Initialize heartbeat monitor and connect it to the CAN driver.
+ *
+ * @param hbMon This object will be initialized.
+ * @param CANmodule CAN module, which receives heartbeats.
+ * @param time_ms Consumer time for all nodes except own, 0 to monitor none.
+ * Change it for individual nodes with CO_HBmonitor_setTime().
+ * @param ownNodeId Own node-ID, not monitored.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_HBmonitor_init(CO_HBmonitor_t *hbMon,
+                                   CO_CANmodule_t *CANmodule,
+                                   uint16_t time_ms,
+                                   uint8_t ownNodeId);
+
+
+/**
+ * Set consumer time of one node. Monitoring of the node restarts.
+ *
+ * @param hbMon Heartbeat monitor object.
+ * @param nodeId Node-ID, 1 to 127.
+ * @param time_ms Consumer time, 0 to stop monitoring the node.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or CO_ERROR_OUT_OF_MEMORY,
+ * if there are more than CO_HB_MON_QUEUES different consumer times.
+ */
+CO_ReturnError_t CO_HBmonitor_setTime(CO_HBmonitor_t *hbMon,
+                                      uint8_t nodeId,
+                                      uint16_t time_ms);
+
+
+/**
+ * Initialize timeout callback. Callback is called from
+ * CO_HBmonitor_process().
+ *
+ * @param hbMon Heartbeat monitor object.
+ * @param object Pointer passed to callback.
+ * @param pFunctSignal Callback, may be NULL.
+ */
+void CO_HBmonitor_initCallbackTimeout(CO_HBmonitor_t *hbMon,
+                                      void *object,
+                                      void (*pFunctSignal)(void *object,
+                                                           uint8_t nodeId));
+
+
+/**
+ * Process received heartbeat. Called from CO_CANrxDispatch().
+ *
+ * @param hbMon Heartbeat monitor object.
+ * @param nodeId Node-ID from CAN identifier.
+ * @param nmtState NMT state from heartbeat, 0 for boot-up.
+ */
+void CO_HBmonitor_frame(CO_HBmonitor_t *hbMon, uint8_t nodeId,
+                        uint8_t nmtState);
+
+
+/**
+ * Process timeouts. Called cyclically from mainline.
+ *
+ * @param hbMon Heartbeat monitor object.
+ * @param [out] timerNext_us info to OS, may be NULL.
+ */
+void CO_HBmonitor_process(CO_HBmonitor_t *hbMon, uint32_t *timerNext_us);
+
+
+/**
+ * Get monitoring state of a node.
+ *
+ * @param hbMon Heartbeat monitor object.
+ * @param nodeId Node-ID, 1 to 127.
+ *
+ * @return CO_HB_MON_UNCONFIGURED, CO_HB_MON_UNKNOWN, CO_HB_MON_ACTIVE or
+ * CO_HB_MON_TIMEOUT.
+ */
+static inline uint8_t CO_HBmonitor_getState(CO_HBmonitor_t *hbMon,
+                                            uint8_t nodeId)
+{
+    return (nodeId >= 1U && nodeId <= 127U)
+         ? hbMon->node[nodeId].state : CO_HB_MON_UNCONFIGURED;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE */
+
+#endif /* CO_HB_MONITOR_H */
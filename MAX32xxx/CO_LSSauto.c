@@ -0,0 +1,233 @@
+/*
+ * LSS master auto-addressing with Fastscan, for MAX32xxx.
+ *
+ * @file        CO_LSSauto.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_LSSauto.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+
+#define NODE_ID_USED(lssAuto, id) \
+    (((lssAuto)->used[(id) / 32U] & (1UL << ((id) % 32U))) != 0U)
+#define NODE_ID_SET_USED(lssAuto, id) \
+    ((lssAuto)->used[(id) / 32U] |= 1UL << ((id) % 32U))
+
+
+/* Next free node-ID, 0 if none */
+static uint8_t CO_LSSauto_nextNodeId(CO_LSSauto_t *lssAuto) {
+    for (uint8_t id = CO_LSS_AUTO_FIRST_NODE_ID; id <= 127U; id++) {
+        if (!NODE_ID_USED(lssAuto, id)) {
+            return id;
+        }
+    }
+    return 0;
+}
+
+
+/* End of batch */
+static void CO_LSSauto_finish(CO_LSSauto_t *lssAuto,
+                              CO_LSSauto_state_t state)
+{
+    CO_LSSmaster_switchStateDeselect(lssAuto->LSSmaster);
+#if (CO_CONFIG_NMT) & CO_CONFIG_NMT_MASTER
+    /* New node-IDs are used after communication reset */
+    if (lssAuto->assigned > 0U) {
+        CO_NMT_sendCommand(lssAuto->NMT, CO_NMT_RESET_COMMUNICATION, 0);
+        lssAuto->resetSent = true;
+    }
+#endif
+    lssAuto->state = state;
+    CO_LOG(CO_LOG_LSS_AUTO_FINISHED, lssAuto->assigned,
+           lssAuto->time_us / 1000U);
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_LSSauto_init(CO_LSSauto_t *lssAuto,
+                                 CO_LSSmaster_t *LSSmaster,
+                                 CO_NMT_t *NMT,
+                                 OD_entry_t *OD_1016_HBcons,
+                                 uint8_t ownNodeId)
+{
+    /* verify arguments */
+    if (lssAuto == NULL || LSSmaster == NULL || NMT == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* communication reset may be caused by our own broadcast */
+    bool_t resetSent = lssAuto->resetSent;
+    memset(lssAuto, 0, sizeof(CO_LSSauto_t));
+    lssAuto->resetSent = resetSent;
+    lssAuto->LSSmaster = LSSmaster;
+    lssAuto->NMT = NMT;
+    lssAuto->state = CO_LSS_AUTO_IDLE;
+    if (ownNodeId >= 1U && ownNodeId <= 127U) {
+        NODE_ID_SET_USED(lssAuto, ownNodeId);
+    }
+
+    /* nodes known from heartbeat consumer: node-ID in bits 16..23 */
+    uint8_t count = 0;
+    if (OD_1016_HBcons != NULL
+        && OD_get_u8(OD_1016_HBcons, 0, &count, true) == ODR_OK
+    ) {
+        for (uint8_t i = 1; i <= count; i++) {
+            uint32_t val;
+            if (OD_get_u32(OD_1016_HBcons, i, &val, true) == ODR_OK) {
+                uint8_t id = (uint8_t)(val >> 16);
+                if (id >= 1U && id <= 127U) {
+                    NODE_ID_SET_USED(lssAuto, id);
+                }
+            }
+        }
+    }
+
+    CO_LSSmaster_changeTimeout(LSSmaster, CO_LSS_AUTO_TIMEOUT_MS);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_LSSauto_start(CO_LSSauto_t *lssAuto) {
+    /* slaves already use their new node-IDs, no need to scan again */
+    if (lssAuto->resetSent) {
+        lssAuto->resetSent = false;
+        lssAuto->state = CO_LSS_AUTO_FINISHED;
+        return;
+    }
+
+    /* Find any unconfigured slave, all four identity fields are scanned */
+    for (uint8_t i = 0; i < 4U; i++) {
+        lssAuto->fastscan.scan[i] = CO_LSSmaster_FS_SCAN;
+    }
+    lssAuto->assigned = 0;
+    lssAuto->time_us = 0;
+    lssAuto->nodeTime_us = 0;
+    lssAuto->nodeStart_us = 0;
+    lssAuto->state = CO_LSS_AUTO_FASTSCAN;
+}
+
+
+/******************************************************************************/
+CO_LSSauto_state_t CO_LSSauto_process(CO_LSSauto_t *lssAuto,
+                                      uint32_t timeDifference_us,
+                                      uint32_t *timerNext_us)
+{
+    CO_LSSmaster_return_t ret = CO_LSSmaster_OK;
+
+    if (lssAuto->state == CO_LSS_AUTO_IDLE
+        || lssAuto->state == CO_LSS_AUTO_FINISHED
+        || lssAuto->state == CO_LSS_AUTO_FAILED
+    ) {
+        return lssAuto->state;
+    }
+
+    lssAuto->time_us += timeDifference_us;
+
+    switch (lssAuto->state) {
+    case CO_LSS_AUTO_FASTSCAN:
+        ret = CO_LSSmaster_IdentifyFastscan(lssAuto->LSSmaster,
+                                            timeDifference_us,
+                                            &lssAuto->fastscan);
+        if (ret == CO_LSSmaster_SCAN_FINISHED) {
+            /* slave is selected */
+            lssAuto->nodeId = CO_LSSauto_nextNodeId(lssAuto);
+            if (lssAuto->nodeId == 0U) {
+                CO_LSSauto_finish(lssAuto, CO_LSS_AUTO_FAILED);
+                ret = CO_LSSmaster_OK;
+                break;
+            }
+            lssAuto->state = CO_LSS_AUTO_NODE_ID;
+            ret = CO_LSSmaster_WAIT_SLAVE;
+        }
+        else if (ret == CO_LSSmaster_SCAN_NOACK) {
+            /* no more unconfigured slaves */
+            CO_LSSauto_finish(lssAuto, CO_LSS_AUTO_FINISHED);
+            ret = CO_LSSmaster_OK;
+        }
+        break;
+
+    case CO_LSS_AUTO_NODE_ID:
+        ret = CO_LSSmaster_configureNodeId(lssAuto->LSSmaster,
+                                           timeDifference_us,
+                                           lssAuto->nodeId);
+        if (ret == CO_LSSmaster_OK) {
+            lssAuto->state = (CO_LSS_AUTO_BITRATE != 0)
+                           ? CO_LSS_AUTO_BITRATE_SET : CO_LSS_AUTO_STORE;
+            ret = CO_LSSmaster_WAIT_SLAVE;
+        }
+        break;
+
+    case CO_LSS_AUTO_BITRATE_SET:
+        ret = CO_LSSmaster_configureBitTiming(lssAuto->LSSmaster,
+                                              timeDifference_us,
+                                              CO_LSS_AUTO_BITRATE);
+        if (ret == CO_LSSmaster_OK) {
+            lssAuto->state = CO_LSS_AUTO_STORE;
+            ret = CO_LSSmaster_WAIT_SLAVE;
+        }
+        break;
+
+    case CO_LSS_AUTO_STORE:
+        ret = CO_LSSmaster_configureStore(lssAuto->LSSmaster,
+                                          timeDifference_us);
+        if (ret == CO_LSSmaster_OK) {
+            uint8_t id = lssAuto->nodeId;
+
+            NODE_ID_SET_USED(lssAuto, id);
+            lssAuto->assigned++;
+            lssAuto->nodeTime_us = lssAuto->time_us - lssAuto->nodeStart_us;
+            lssAuto->nodeStart_us = lssAuto->time_us;
+            CO_LOG(CO_LOG_LSS_AUTO_ASSIGNED, id,
+                   lssAuto->fastscan.found.identity.serialNumber);
+
+            /* next slave */
+            CO_LSSmaster_switchStateDeselect(lssAuto->LSSmaster);
+            lssAuto->state = CO_LSS_AUTO_FASTSCAN;
+            ret = CO_LSSmaster_WAIT_SLAVE;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    if (ret != CO_LSSmaster_WAIT_SLAVE && ret != CO_LSSmaster_OK) {
+        /* timeout or rejected by slave, which stays unconfigured */
+        CO_LOG(CO_LOG_LSS_AUTO_FAILED, lssAuto->state, (uint32_t)(-ret));
+        CO_LSSauto_finish(lssAuto, CO_LSS_AUTO_FAILED);
+    }
+    else if (ret == CO_LSSmaster_WAIT_SLAVE && timerNext_us != NULL) {
+        /* LSS master timeout is counted by timeDifference_us */
+        if (*timerNext_us > 1000U) {
+            *timerNext_us = 1000U;
+        }
+    }
+
+    return lssAuto->state;
+}
+
+#endif /* (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE */
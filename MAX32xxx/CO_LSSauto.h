@@ -0,0 +1,154 @@
+/*
+ * LSS master auto-addressing with Fastscan, for MAX32xxx.
+ *
+ * @file        CO_LSSauto.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_LSS_AUTO_H
+#define CO_LSS_AUTO_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+#include "301/CO_NMT_Heartbeat.h"
+#include "305/CO_LSSmaster.h"
+
+#if ((CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Batch auto-addressing of all LSS slaves with unconfigured node-ID (CiA 305).
+ * Each pass finds one slave with Fastscan, which resolves its 128-bit LSS
+ * address by bit-wise binary search and leaves it selected. The slave then
+ * gets the next free node-ID (and bit rate), stores the configuration and is
+ * deselected. Configured slaves do not answer Fastscan any more, so the pass
+ * is repeated until no slave answers. Finally, NMT reset communication is
+ * broadcast (with CO_CONFIG_NMT_MASTER), so the slaves use their new node-IDs.
+ * Unconfigured slaves have no node-ID to address, so the broadcast also resets
+ * communication of this node. The batch started after that reset is skipped.
+ *
+ * Node-IDs of this node and of all nodes in its heartbeat consumer (0x1016)
+ * are never assigned.
+ */
+
+/* First node-ID assigned to slaves. */
+#ifndef CO_LSS_AUTO_FIRST_NODE_ID
+#define CO_LSS_AUTO_FIRST_NODE_ID 2
+#endif
+/* Bit rate in kbit/s configured in slaves, 0 to keep their bit rate. */
+#ifndef CO_LSS_AUTO_BITRATE
+#define CO_LSS_AUTO_BITRATE 0
+#endif
+/* LSS master response timeout. Fastscan waits for it once for each bit of
+ * the LSS address, so it dominates the addressing time per slave. */
+#ifndef CO_LSS_AUTO_TIMEOUT_MS
+#define CO_LSS_AUTO_TIMEOUT_MS 5
+#endif
+
+/** Auto-addressing step, CO_LSSauto_t.state */
+typedef enum {
+    CO_LSS_AUTO_IDLE,
+    CO_LSS_AUTO_FASTSCAN,
+    CO_LSS_AUTO_NODE_ID,
+    CO_LSS_AUTO_BITRATE_SET,
+    CO_LSS_AUTO_STORE,
+    CO_LSS_AUTO_FINISHED,
+    CO_LSS_AUTO_FAILED
+} CO_LSSauto_state_t;
+
+/**
+ * LSS auto-addressing object.
+ */
+typedef struct {
+    CO_LSSmaster_t *LSSmaster;
+    CO_NMT_t *NMT;
+    CO_LSSauto_state_t state;
+    CO_LSSmaster_fastscan_t fastscan;
+    /** Used node-IDs, bit (nodeId). Application may set bits of nodes
+     * configured otherwise before CO_LSSauto_start(). */
+    uint32_t used[4];
+    /** Set when NMT reset communication was broadcast, kept over
+     * CO_LSSauto_init() */
+    bool_t resetSent;
+    uint8_t nodeId;
+    /** Slaves configured in the last batch */
+    uint8_t assigned;
+    /** Duration of the last batch and of the last slave */
+    uint32_t time_us;
+    uint32_t nodeTime_us;
+    uint32_t nodeStart_us;
+} CO_LSSauto_t;
+
+
+/**
+ * Initialize LSS auto-addressing. Called after CO_CANopenInit().
+ *
+ * @param lssAuto This object will be initialized, must be zeroed before the
+ * first call (global variable).
+ * @param LSSmaster LSS master object, CO->LSSmaster.
+ * @param NMT NMT object, CO->NMT.
+ * @param OD_1016_HBcons OD entry for 0x1016 - "Consumer heartbeat time", may
+ * be NULL. Node-IDs of consumed heartbeats are never assigned.
+ * @param ownNodeId Own node-ID, never assigned.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_LSSauto_init(CO_LSSauto_t *lssAuto,
+                                 CO_LSSmaster_t *LSSmaster,
+                                 CO_NMT_t *NMT,
+                                 OD_entry_t *OD_1016_HBcons,
+                                 uint8_t ownNodeId);
+
+
+/**
+ * Start batch auto-addressing of all unconfigured slaves. If the previous
+ * batch has broadcast NMT reset communication, which has reset also this
+ * node, nothing is started and state is CO_LSS_AUTO_FINISHED.
+ *
+ * @param lssAuto LSS auto-addressing object.
+ */
+void CO_LSSauto_start(CO_LSSauto_t *lssAuto);
+
+
+/**
+ * Process LSS auto-addressing. Called cyclically from mainline. LSS master
+ * must not be used by others while batch is running.
+ *
+ * @param lssAuto LSS auto-addressing object.
+ * @param timeDifference_us Time difference from previous function call.
+ * @param [out] timerNext_us info to OS, may be NULL.
+ *
+ * @return Current state, CO_LSS_AUTO_FINISHED or CO_LSS_AUTO_FAILED after
+ * batch ends.
+ */
+CO_LSSauto_state_t CO_LSSauto_process(CO_LSSauto_t *lssAuto,
+                                      uint32_t timeDifference_us,
+                                      uint32_t *timerNext_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE */
+
+#endif /* CO_LSS_AUTO_H */
@@ -0,0 +1,90 @@
+/*
+ * Typed lock-free access to Object Dictionary variables, for MAX32xxx.
+ *
+ * @file        CO_ODaccess.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_ODaccess.h"
+
+
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+
+/* Mainline write of larger variables must not be interrupted by RT thread,
+ * which may map them to TPDO. */
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+#define OD_ACCESS_LOCK()   taskENTER_CRITICAL()
+#define OD_ACCESS_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define OD_ACCESS_LOCK()   uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define OD_ACCESS_UNLOCK() __set_PRIMASK(primask)
+#endif
+
+volatile uint32_t CO_ODaccess_seq;
+volatile uint32_t CO_ODaccess_retries;
+
+
+/******************************************************************************/
+void CO_ODaccess_read(void *dst, const volatile void *src, size_t len) {
+    for (;;) {
+        uint32_t seq = CO_ODaccess_seq;
+
+        CO_OD_ACCESS_BARRIER();
+        /* Sequence is odd only if RT thread is preempted inside its section */
+        if ((seq & 1U) == 0U) {
+            memcpy(dst, (const void *)src, len);
+            CO_OD_ACCESS_BARRIER();
+            if (seq == CO_ODaccess_seq) {
+                return;
+            }
+        }
+        CO_ODaccess_retries++;
+    }
+}
+
+
+/******************************************************************************/
+void CO_ODaccess_write(volatile void *dst, const void *src, size_t len) {
+    /* Aligned variable up to 32 bits is written with a single store */
+    if (len == sizeof(uint32_t) && ((uintptr_t)dst & 3U) == 0U) {
+        uint32_t val;
+        memcpy(&val, src, sizeof(val));
+        *(volatile uint32_t *)dst = val;
+    }
+    else if (len == sizeof(uint16_t) && ((uintptr_t)dst & 1U) == 0U) {
+        uint16_t val;
+        memcpy(&val, src, sizeof(val));
+        *(volatile uint16_t *)dst = val;
+    }
+    else if (len == sizeof(uint8_t)) {
+        *(volatile uint8_t *)dst = *(const uint8_t *)src;
+    }
+    else {
+        OD_ACCESS_LOCK();
+        memcpy((void *)dst, src, len);
+        OD_ACCESS_UNLOCK();
+    }
+}
+
+#endif /* (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE */
@@ -0,0 +1,130 @@
+/*
+ * Typed lock-free access to Object Dictionary variables, for MAX32xxx.
+ *
+ * @file        CO_ODaccess.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_OD_ACCESS_H
+#define CO_OD_ACCESS_H
+
+#include <stddef.h>
+
+#include "301/CO_driver.h"
+
+#if ((CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Access to PDO mapped OD variables from app_programAsync() without
+ * CO_LOCK_OD(), which would stall the RT thread.
+ *
+ * RT thread is the only writer of PDO mapped variables, which runs
+ * concurrently with mainline: it increments CO_ODaccess_seq before and after
+ * its locked section (RPDOs, app_programRt(), TPDOs). Mainline reader copies
+ * the variable and repeats the copy, if sequence was odd or has changed
+ * meanwhile. So RT thread never waits for the reader. Mainline writes of
+ * variables larger than 32 bits are done in a critical section of the copy
+ * length, smaller aligned variables are written with a single store.
+ *
+ * Accessors are generated with CO_OD_ACCESSORS() for OD variables and records
+ * from OD.h, for example:
+ *
+ *     CO_OD_ACCESSORS(x6001_remoteCounter, OD_PERSIST_COMM.x6001_remoteCounter)
+ *
+ * gives OD_get_x6001_remoteCounter() and OD_set_x6001_remoteCounter(). Arrays
+ * are not supported, wrap them into a record.
+ */
+
+/* Ordering of sequence counter and data accesses */
+#if defined(__riscv)
+#define CO_OD_ACCESS_BARRIER() __asm volatile("fence rw, rw" ::: "memory")
+#else
+#define CO_OD_ACCESS_BARRIER() __asm volatile("dmb" ::: "memory")
+#endif
+
+/** Sequence counter, odd while RT thread is inside its locked section */
+extern volatile uint32_t CO_ODaccess_seq;
+/** Number of repeated reads, for comparison with lock-based access */
+extern volatile uint32_t CO_ODaccess_retries;
+
+
+/**
+ * Begin of write section, called by RT thread after CO_LOCK_OD().
+ */
+static inline void CO_ODaccess_writeBegin(void) {
+    CO_ODaccess_seq++;
+    CO_OD_ACCESS_BARRIER();
+}
+
+
+/**
+ * End of write section, called by RT thread before CO_UNLOCK_OD().
+ */
+static inline void CO_ODaccess_writeEnd(void) {
+    CO_OD_ACCESS_BARRIER();
+    CO_ODaccess_seq++;
+}
+
+
+/**
+ * Read consistent copy of OD variable, from mainline.
+ *
+ * @param [out] dst Copy of the variable.
+ * @param src OD variable.
+ * @param len Size of the variable.
+ */
+void CO_ODaccess_read(void *dst, const volatile void *src, size_t len);
+
+
+/**
+ * Write OD variable, from mainline.
+ *
+ * @param dst OD variable.
+ * @param src New value.
+ * @param len Size of the variable.
+ */
+void CO_ODaccess_write(volatile void *dst, const void *src, size_t len);
+
+
+/**
+ * Generate typed accessors OD_get_<name>() and OD_set_<name>() for OD
+ * variable or record var.
+ */
+#define CO_OD_ACCESSORS(name, var)                                            \
+static inline __typeof__(var) OD_get_##name(void) {                          \
+    __typeof__(var) val;                                                      \
+    CO_ODaccess_read(&val, &(var), sizeof(val));                              \
+    return val;                                                               \
+}                                                                             \
+static inline void OD_set_##name(__typeof__(var) val) {                       \
+    CO_ODaccess_write(&(var), &val, sizeof(val));                             \
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE */
+
+#endif /* CO_OD_ACCESS_H */
@@ -0,0 +1,338 @@
+/*
+ * Hardware timer driven SYNC producer, for MAX32xxx.
+ *
+ * @file        CO_SYNCtimer.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_SYNCtimer.h"
+
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+
+/* 0x1005 bit 30, node is SYNC producer */
+#define SYNC_PRODUCER 0x40000000UL
+
+
+/* Clear statistics */
+static void CO_SYNCtimer_clearStats(CO_SYNCtimer_t *syncTmr) {
+    syncTmr->count = 0;
+    syncTmr->deferred = 0;
+    syncTmr->overrun = 0;
+    syncTmr->latencyMin = 0xFFFFFFFFUL;
+    syncTmr->latencyMax = 0;
+    memset(syncTmr->hist, 0, sizeof(syncTmr->hist));
+}
+
+
+/*
+ * Custom functions for reading and writing OD object "SYNC timer statistics"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_SYNCtimer(OD_stream_t *stream, void *buf,
+                               OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_SYNCtimer_t *syncTmr = (CO_SYNCtimer_t *)stream->object;
+    uint8_t sub = stream->subIndex;
+    uint32_t val = 0;
+
+    if (sub == CO_SYNC_TMR_SUB_COUNT) {
+        val = syncTmr->count;
+    }
+    else if (sub == CO_SYNC_TMR_SUB_DEFERRED) {
+        val = syncTmr->deferred;
+    }
+    else if (sub == CO_SYNC_TMR_SUB_OVERRUN) {
+        val = syncTmr->overrun;
+    }
+    else if (sub == CO_SYNC_TMR_SUB_MIN) {
+        val = (syncTmr->count > 0U)
+            ? (uint32_t)((uint64_t)syncTmr->latencyMin * 1000U
+                         / syncTmr->ticksPerUs)
+            : 0U;
+    }
+    else if (sub == CO_SYNC_TMR_SUB_MAX) {
+        val = (uint32_t)((uint64_t)syncTmr->latencyMax * 1000U
+                         / syncTmr->ticksPerUs);
+    }
+    else if (sub <= CO_SYNC_TMR_SUB_LAST) {
+        val = syncTmr->hist[sub - CO_SYNC_TMR_SUB_HIST];
+    }
+    else {
+        return ODR_SUB_NOT_EXIST;
+    }
+
+    *countRead = CO_setUint32(buf, val);
+    return ODR_OK;
+}
+
+static ODR_t OD_write_SYNCtimer(OD_stream_t *stream, const void *buf,
+                                OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex == 0 || stream->subIndex > CO_SYNC_TMR_SUB_LAST) {
+        return ODR_READONLY;
+    }
+
+    CO_SYNCtimer_clearStats((CO_SYNCtimer_t *)stream->object);
+    *countWritten = count;
+    return ODR_OK;
+}
+
+
+#if (CO_CONFIG_SYNC) & CO_CONFIG_FLAG_OD_DYNAMIC
+/*
+ * Custom function for writing OD object "COB-ID SYNC message". Write is
+ * passed to the SYNC object, which sets its isProducer from the new value.
+ * Production stays with the timer, so it is cleared again. Called with OD
+ * locked, so RT thread never sees isProducer set.
+ */
+static ODR_t OD_write_1005_SYNCtimer(OD_stream_t *stream, const void *buf,
+                                     OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_SYNCtimer_t *syncTmr = (CO_SYNCtimer_t *)stream->object;
+    CO_SYNC_t *SYNC = syncTmr->SYNC;
+
+    stream->object = SYNC;
+    ODR_t ret = SYNC->OD_1005_extension.write(stream, buf, count, countWritten);
+    stream->object = syncTmr;
+    SYNC->isProducer = false;
+
+    return ret;
+}
+#endif
+
+
+/* Stop the timer, pending SYNC is dropped */
+static void CO_SYNCtimer_stop(CO_SYNCtimer_t *syncTmr) {
+    MXC_TMR_DisableInt(CO_SYNC_TMR);
+    MXC_TMR_Stop(CO_SYNC_TMR);
+    MXC_TMR_ClearFlags(CO_SYNC_TMR);
+    syncTmr->running = false;
+    syncTmr->pending = false;
+    syncTmr->period_us = 0;
+}
+
+
+/* (Re)start the timer with the SYNC period */
+static void CO_SYNCtimer_start(CO_SYNCtimer_t *syncTmr, uint32_t cobId,
+                               uint32_t period_us)
+{
+    mxc_tmr_cfg_t cfg = {
+        .pres = TMR_PRES_1,
+        .mode = TMR_MODE_CONTINUOUS,
+        .bitMode = TMR_BIT_MODE_32,
+        .clock = MXC_TMR_APB_CLK,
+        .cmp_cnt = period_us * syncTmr->ticksPerUs,
+        .pol = 0
+    };
+
+    if (syncTmr->running) {
+        CO_SYNCtimer_stop(syncTmr);
+    }
+
+    /* first SYNC carries counter value 1, as from the stack */
+    syncTmr->counter = 1;
+    syncTmr->txBuff.ident = cobId & 0x7FFU;
+    syncTmr->txBuff.DLC = (syncTmr->SYNC->counterOverflowValue != 0U) ? 1U : 0U;
+    syncTmr->txBuff.data[0] = syncTmr->counter;
+
+    MXC_TMR_Init(CO_SYNC_TMR, &cfg, false);
+    MXC_TMR_ClearFlags(CO_SYNC_TMR);
+    MXC_TMR_EnableInt(CO_SYNC_TMR);
+    syncTmr->period_us = period_us;
+    syncTmr->running = true;
+    MXC_TMR_Start(CO_SYNC_TMR);
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_SYNCtimer_init(CO_SYNCtimer_t *syncTmr,
+                                   CO_SYNC_t *SYNC,
+                                   CO_CANmodule_t *CANmodule,
+                                   OD_entry_t *OD_1005_cobIdSync,
+                                   OD_entry_t *OD_stats)
+{
+    /* verify arguments */
+    if (syncTmr == NULL || SYNC == NULL || CANmodule == NULL
+        || OD_1005_cobIdSync == NULL
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    if (syncTmr->running) {
+        CO_SYNCtimer_stop(syncTmr);
+    }
+    memset(syncTmr, 0, sizeof(CO_SYNCtimer_t));
+    syncTmr->SYNC = SYNC;
+    syncTmr->CANmodule = CANmodule;
+    syncTmr->OD_1005_entry = OD_1005_cobIdSync;
+    syncTmr->ticksPerUs = PeripheralClock / 1000000U;
+    CO_SYNCtimer_clearStats(syncTmr);
+
+    /* statistics are optionally readable from Object Dictionary */
+    if (OD_stats != NULL) {
+        syncTmr->OD_stats_ext.object = syncTmr;
+        syncTmr->OD_stats_ext.read = OD_read_SYNCtimer;
+        syncTmr->OD_stats_ext.write = OD_write_SYNCtimer;
+        OD_extension_init(OD_stats, &syncTmr->OD_stats_ext);
+    }
+
+    /* SYNC is produced only by the timer */
+    SYNC->isProducer = false;
+#if (CO_CONFIG_SYNC) & CO_CONFIG_FLAG_OD_DYNAMIC
+    syncTmr->OD_1005_ext.object = syncTmr;
+    syncTmr->OD_1005_ext.read = SYNC->OD_1005_extension.read;
+    syncTmr->OD_1005_ext.write = OD_write_1005_SYNCtimer;
+    OD_extension_init(OD_1005_cobIdSync, &syncTmr->OD_1005_ext);
+#endif
+
+    CANmodule->syncTimer = syncTmr;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_SYNCtimer_initCallbackPre(CO_SYNCtimer_t *syncTmr,
+                                  void *object,
+                                  void (*pFunctSignal)(void *object))
+{
+    if (syncTmr != NULL) {
+        syncTmr->functSignalObject = object;
+        syncTmr->pFunctSignal = pFunctSignal;
+    }
+}
+
+
+/******************************************************************************/
+void CO_SYNCtimer_process(CO_SYNCtimer_t *syncTmr, bool_t NMTisPreOrOperational) {
+    CO_SYNC_t *SYNC = syncTmr->SYNC;
+    uint32_t cobId = 0;
+    uint32_t period_us = 0;
+
+    OD_get_u32(syncTmr->OD_1005_entry, 0, &cobId, true);
+    if ((cobId & SYNC_PRODUCER) != 0U) {
+        if (NMTisPreOrOperational && SYNC->OD_1006_period != NULL) {
+            period_us = *SYNC->OD_1006_period;
+        }
+    }
+
+    /* 32-bit timer limits the period to about a minute */
+    if (period_us > (0xFFFFFFFFUL / syncTmr->ticksPerUs)) {
+        period_us = 0xFFFFFFFFUL / syncTmr->ticksPerUs;
+    }
+
+    if (period_us == 0U) {
+        if (syncTmr->running) {
+            CO_SYNCtimer_stop(syncTmr);
+        }
+    }
+    else if (!syncTmr->running || period_us != syncTmr->period_us
+             || (cobId & 0x7FFU) != syncTmr->txBuff.ident
+    ) {
+        CO_SYNCtimer_start(syncTmr, cobId, period_us);
+    }
+}
+
+
+/******************************************************************************/
+void CO_SYNCtimer_interrupt(CO_SYNCtimer_t *syncTmr) {
+    MXC_TMR_ClearFlags(CO_SYNC_TMR);
+
+    /* CAN module is being initialized after communication reset */
+    if (!syncTmr->running || syncTmr->CANmodule->syncTimer != syncTmr) {
+        return;
+    }
+    if (syncTmr->pending) {
+        /* previous SYNC still waits for CAN TX interrupt */
+        syncTmr->overrun++;
+    }
+    syncTmr->pending = true;
+
+    if (CO_CANsendFromISR(syncTmr->CANmodule, &syncTmr->txBuff)) {
+        CO_SYNCtimer_sent(syncTmr, false);
+    }
+}
+
+
+/******************************************************************************/
+void CO_SYNCtimer_sent(CO_SYNCtimer_t *syncTmr, bool_t deferred) {
+    /* Timer restarts counting at the period, so the count is the latency */
+    uint32_t latency = MXC_TMR_GetCount(CO_SYNC_TMR);
+    CO_SYNC_t *SYNC = syncTmr->SYNC;
+
+    syncTmr->pending = false;
+    syncTmr->count++;
+    if (deferred) {
+        syncTmr->deferred++;
+    }
+    if (latency < syncTmr->latencyMin) {
+        syncTmr->latencyMin = latency;
+    }
+    if (latency > syncTmr->latencyMax) {
+        syncTmr->latencyMax = latency;
+    }
+    uint32_t bin = (uint32_t)((uint64_t)latency * 1000U
+                              / (syncTmr->ticksPerUs * CO_SYNC_TMR_HIST_BIN_NS));
+    if (bin >= CO_SYNC_TMR_HIST_BINS) {
+        bin = CO_SYNC_TMR_HIST_BINS - 1U;
+    }
+    syncTmr->hist[bin]++;
+
+    /* SYNC object processes own SYNC as received, PDOs use the counter.
+     * Toggle switches RPDO buffers, as in CO_SYNCsend(). */
+    SYNC->counter = syncTmr->counter;
+    SYNC->CANrxToggle = SYNC->CANrxToggle ? false : true;
+    CO_FLAG_SET(SYNC->CANrxNew);
+
+    /* prepare the next frame */
+    if (++syncTmr->counter > SYNC->counterOverflowValue) {
+        syncTmr->counter = 1;
+    }
+    syncTmr->txBuff.data[0] = syncTmr->counter;
+
+    if (syncTmr->pFunctSignal != NULL) {
+        syncTmr->pFunctSignal(syncTmr->functSignalObject);
+    }
+}
+
+#endif /* (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE */
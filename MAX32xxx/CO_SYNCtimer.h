@@ -0,0 +1,197 @@
+/*
+ * Hardware timer driven SYNC producer, for MAX32xxx.
+ *
+ * @file        CO_SYNCtimer.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_SYNC_TIMER_H
+#define CO_SYNC_TIMER_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+#include "301/CO_SYNC.h"
+
+#if ((CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE) || defined CO_DOXYGEN
+
+#include "tmr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * SYNC producer, driven by a hardware timer instead of the 1 ms tick. The
+ * timer runs with the 0x1006 period and its interrupt sends the SYNC frame,
+ * prepared after the previous SYNC. If the CAN TX buffer is busy, SYNC is
+ * sent from the next CAN TX interrupt, before all queued frames. The SYNC
+ * object of the stack is then only informed about the SYNC, as if it was
+ * received, so synchronous PDOs work as before.
+ *
+ * Timer interrupt has the same priority as CAN interrupt. Latency from the
+ * timer period to the write into the CAN TX buffer is measured with the timer
+ * counter, in peripheral clock ticks, and collected into a histogram.
+ */
+
+/* Timer instance and its interrupt. */
+#ifndef CO_SYNC_TMR
+#define CO_SYNC_TMR MXC_TMR1
+#endif
+#ifndef CO_SYNC_TMR_IRQn
+#define CO_SYNC_TMR_IRQn TMR1_IRQn
+#endif
+/* Number of histogram bins, last bin counts all longer latencies. */
+#ifndef CO_SYNC_TMR_HIST_BINS
+#define CO_SYNC_TMR_HIST_BINS 16
+#endif
+/* Width of histogram bin in nanoseconds. */
+#ifndef CO_SYNC_TMR_HIST_BIN_NS
+#define CO_SYNC_TMR_HIST_BIN_NS 250
+#endif
+/* Default index of the manufacturer specific OD entry, see CO_SYNCtimer_init() */
+#ifndef CO_SYNC_TMR_OD_INDEX
+#define CO_SYNC_TMR_OD_INDEX 0x2102
+#endif
+
+/**
+ * Sub-indexes of the OD entry @ref CO_SYNC_TMR_OD_INDEX, all UNSIGNED32,
+ * latencies in nanoseconds:
+ * - CO_SYNC_TMR_SUB_COUNT: SYNC frames sent
+ * - CO_SYNC_TMR_SUB_DEFERRED: SYNC frames sent from CAN TX interrupt
+ * - CO_SYNC_TMR_SUB_OVERRUN: periods without SYNC, previous was not sent
+ * - CO_SYNC_TMR_SUB_MIN, CO_SYNC_TMR_SUB_MAX: minimum and maximum latency
+ * - CO_SYNC_TMR_SUB_HIST + i: frames with latency in i-th bin
+ *
+ * Writing any sub-index clears the statistics.
+ */
+#define CO_SYNC_TMR_SUB_COUNT       1
+#define CO_SYNC_TMR_SUB_DEFERRED    2
+#define CO_SYNC_TMR_SUB_OVERRUN     3
+#define CO_SYNC_TMR_SUB_MIN         4
+#define CO_SYNC_TMR_SUB_MAX         5
+#define CO_SYNC_TMR_SUB_HIST        6
+#define CO_SYNC_TMR_SUB_LAST        (CO_SYNC_TMR_SUB_HIST + CO_SYNC_TMR_HIST_BINS - 1)
+
+/**
+ * Hardware timer SYNC producer object.
+ */
+typedef struct CO_SYNCtimer {
+    CO_SYNC_t *SYNC;
+    CO_CANmodule_t *CANmodule;
+    OD_entry_t *OD_1005_entry;
+    /** SYNC frame, prepared with the next counter value */
+    CO_CANtx_t txBuff;
+    uint8_t counter;
+    /** Timer is running, own node is SYNC producer */
+    bool_t running;
+    /** Timer period expired, SYNC not yet in CAN TX buffer */
+    volatile bool_t pending;
+    uint32_t period_us;
+    uint32_t ticksPerUs;
+    /** Statistics, see CO_SYNC_TMR_SUB_COUNT */
+    uint32_t count;
+    uint32_t deferred;
+    uint32_t overrun;
+    uint32_t latencyMin;
+    uint32_t latencyMax;
+    uint32_t hist[CO_SYNC_TMR_HIST_BINS];
+    OD_extension_t OD_stats_ext;
+#if ((CO_CONFIG_SYNC) & CO_CONFIG_FLAG_OD_DYNAMIC) || defined CO_DOXYGEN
+    /** Wraps OD_1005_extension of the SYNC object */
+    OD_extension_t OD_1005_ext;
+#endif
+    /** Called from interrupt after SYNC is sent, may be NULL */
+    void (*pFunctSignal)(void *object);
+    void *functSignalObject;
+} CO_SYNCtimer_t;
+
+
+/**
+ * Initialize SYNC timer and connect it to the CAN driver. Called after
+ * CO_CANopenInit(). Timer is started by CO_SYNCtimer_process(), if own node
+ * is SYNC producer. SYNC production of the stack SYNC object is disabled here
+ * and, with dynamic OD, also after each write to 0x1005, so it never sends a
+ * second SYNC.
+ *
+ * @param syncTmr This object will be initialized.
+ * @param SYNC SYNC object, CO->SYNC.
+ * @param CANmodule CAN module, CO->CANmodule.
+ * @param OD_1005_cobIdSync OD entry for 0x1005 - "COB-ID SYNC message".
+ * @param OD_stats OD entry @ref CO_SYNC_TMR_OD_INDEX for statistics, may be
+ * NULL.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_SYNCtimer_init(CO_SYNCtimer_t *syncTmr,
+                                   CO_SYNC_t *SYNC,
+                                   CO_CANmodule_t *CANmodule,
+                                   OD_entry_t *OD_1005_cobIdSync,
+                                   OD_entry_t *OD_stats);
+
+
+/**
+ * Initialize callback, called from interrupt after SYNC is sent, for example
+ * to wake RT task.
+ *
+ * @param syncTmr SYNC timer object.
+ * @param object Pointer passed to callback.
+ * @param pFunctSignal Callback, may be NULL.
+ */
+void CO_SYNCtimer_initCallbackPre(CO_SYNCtimer_t *syncTmr,
+                                  void *object,
+                                  void (*pFunctSignal)(void *object));
+
+
+/**
+ * Follow 0x1005 and 0x1006 and (re)start or stop the timer. Takes over SYNC
+ * production from the stack SYNC object. Called cyclically from mainline.
+ *
+ * @param syncTmr SYNC timer object.
+ * @param NMTisPreOrOperational True if NMT state is pre-operational or
+ * operational.
+ */
+void CO_SYNCtimer_process(CO_SYNCtimer_t *syncTmr, bool_t NMTisPreOrOperational);
+
+
+/**
+ * Timer interrupt, set as vector of @ref CO_SYNC_TMR_IRQn by main file.
+ *
+ * @param syncTmr SYNC timer object.
+ */
+void CO_SYNCtimer_interrupt(CO_SYNCtimer_t *syncTmr);
+
+
+/**
+ * SYNC frame was written into the CAN TX buffer, called from
+ * CO_SYNCtimer_interrupt() or from CO_CANTXinterrupt(), which sends pending
+ * SYNC before all queued frames. Records latency and informs SYNC object.
+ *
+ * @param syncTmr SYNC timer object.
+ * @param deferred True if called from CO_CANTXinterrupt().
+ */
+void CO_SYNCtimer_sent(CO_SYNCtimer_t *syncTmr, bool_t deferred);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE */
+
+#endif /* CO_SYNC_TIMER_H */
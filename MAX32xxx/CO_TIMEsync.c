@@ -0,0 +1,327 @@
+/*
+ * Synchronized time base from TIME object with high resolution timestamps,
+ * for MAX32xxx.
+ *
+ * @file        CO_TIMEsync.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_TIMEsync.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+
+/* Clock is read from CAN interrupts, tasks and mainline. Section is a few
+ * instructions long, so interrupts are disabled in both threading models. */
+#define TIME_SYNC_LOCK()   uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define TIME_SYNC_UNLOCK() __set_PRIMASK(primask)
+
+/* 0x1012 bits */
+#define TIME_CONSUMER 0x80000000UL
+#define TIME_PRODUCER 0x40000000UL
+
+#define NS_PER_DAY (86400000ULL * 1000000ULL)
+/* Clock is rebased before the raw difference gets near 2^31 us */
+#define REBASE_US 1000000000UL
+#define MAX_PPB ((int32_t)CO_TIME_SYNC_MAX_PPM * 1000)
+
+
+/* Synchronized time at raw_us, clock must be locked */
+static uint64_t CO_TIMEsync_clock(CO_TIMEsync_t *timeSync, uint32_t raw_us) {
+    int64_t d_us = (int32_t)(raw_us - timeSync->baseRaw_us);
+
+    return timeSync->baseSync_ns + (uint64_t)(d_us * 1000
+           + d_us * timeSync->rate_ppb / 1000000);
+}
+
+
+/* Move clock base to raw_us, add offset and set new rate */
+static void CO_TIMEsync_rebase(CO_TIMEsync_t *timeSync, uint32_t raw_us,
+                               int64_t offset_ns, int32_t rate_ppb)
+{
+    TIME_SYNC_LOCK();
+    timeSync->baseSync_ns = CO_TIMEsync_clock(timeSync, raw_us) + (uint64_t)offset_ns;
+    timeSync->baseRaw_us = raw_us;
+    timeSync->rate_ppb = rate_ppb;
+    TIME_SYNC_UNLOCK();
+}
+
+
+static int32_t CO_TIMEsync_clamp(int64_t ppb) {
+    if (ppb > MAX_PPB) {
+        return MAX_PPB;
+    }
+    if (ppb < -MAX_PPB) {
+        return -MAX_PPB;
+    }
+    return (int32_t)ppb;
+}
+
+
+/* PI servo, offset is producer time minus own time at the same instant */
+static void CO_TIMEsync_servo(CO_TIMEsync_t *timeSync, int64_t offset_ns,
+                              uint32_t stamp_us)
+{
+    uint32_t interval_us = stamp_us - timeSync->lastSample_us;
+
+    timeSync->lastSample_us = stamp_us;
+    timeSync->offset_ns = (offset_ns > INT32_MAX) ? INT32_MAX
+                        : (offset_ns < INT32_MIN) ? INT32_MIN : (int32_t)offset_ns;
+    timeSync->samples++;
+
+    if (timeSync->samples == 1U || interval_us == 0U
+        || offset_ns > ((int64_t)CO_TIME_SYNC_STEP_US * 1000)
+        || offset_ns < -((int64_t)CO_TIME_SYNC_STEP_US * 1000)
+    ) {
+        /* set the clock, keep the rate */
+        CO_TIMEsync_rebase(timeSync, CO_timer_us(), offset_ns, timeSync->rate_ppb);
+        timeSync->steps++;
+        CO_LOG(CO_LOG_TIME_SYNC_STEP, (uint32_t)(offset_ns / 1000), timeSync->steps);
+        return;
+    }
+
+    /* offset per interval is the rate error, in ns/s = ppb */
+    int64_t err_ppb = offset_ns * 1000000 / (int64_t)interval_us;
+    timeSync->drift_ppb = CO_TIMEsync_clamp(timeSync->drift_ppb
+                                            + err_ppb * CO_TIME_SYNC_KI / 1000);
+    CO_TIMEsync_rebase(timeSync, CO_timer_us(), 0,
+                       CO_TIMEsync_clamp(timeSync->drift_ppb
+                                         + err_ppb * CO_TIME_SYNC_KP / 1000));
+}
+
+
+/*
+ * Custom functions for reading and writing OD object "High resolution time
+ * stamp"
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_1013(OD_stream_t *stream, void *buf,
+                          OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_TIMEsync_t *timeSync = (CO_TIMEsync_t *)stream->object;
+
+    *countRead = CO_setUint32(buf, timeSync->hrTimeStamp_us);
+    return ODR_OK;
+}
+
+static ODR_t OD_write_1013(OD_stream_t *stream, const void *buf,
+                           OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL
+        || count != sizeof(uint32_t)
+    ) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_TIMEsync_t *timeSync = (CO_TIMEsync_t *)stream->object;
+
+    /* follow-up from producer, written by RPDO */
+    timeSync->hrTimeStamp_us = CO_getUint32(buf);
+    if (timeSync->isConsumer) {
+        timeSync->followUp_us = timeSync->hrTimeStamp_us;
+        timeSync->followUpNew = true;
+    }
+
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_TIMEsync_init(CO_TIMEsync_t *timeSync,
+                                  CO_TIME_t *TIME,
+                                  CO_CANmodule_t *CANmodule,
+                                  OD_entry_t *OD_1012_cobIdTime,
+                                  OD_entry_t *OD_1013_hrTimeStamp)
+{
+    /* verify arguments */
+    if (timeSync == NULL || TIME == NULL || CANmodule == NULL
+        || OD_1012_cobIdTime == NULL
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* Clock runs on across communication reset */
+    uint32_t baseRaw_us = timeSync->baseRaw_us;
+    uint64_t baseSync_ns = timeSync->baseSync_ns;
+    bool_t valid = timeSync->valid;
+
+    memset(timeSync, 0, sizeof(CO_TIMEsync_t));
+    timeSync->TIME = TIME;
+    timeSync->OD_1012_entry = OD_1012_cobIdTime;
+    timeSync->OD_1013_entry = OD_1013_hrTimeStamp;
+    timeSync->baseRaw_us = baseRaw_us;
+    timeSync->baseSync_ns = baseSync_ns;
+    timeSync->valid = valid;
+
+    if (OD_1013_hrTimeStamp != NULL) {
+        timeSync->OD_1013_ext.object = timeSync;
+        timeSync->OD_1013_ext.read = OD_read_1013;
+        timeSync->OD_1013_ext.write = OD_write_1013;
+        OD_extension_init(OD_1013_hrTimeStamp, &timeSync->OD_1013_ext);
+    }
+
+    CO_TIMEsync_process(timeSync);
+#if (CO_CONFIG_TIME) & CO_CONFIG_TIME_PRODUCER
+    if (timeSync->isProducer) {
+        uint64_t ms = CO_TIMEsync_now_ns(timeSync) / 1000000U;
+        CO_TIME_set(TIME, (uint32_t)(ms % 86400000U), (uint16_t)(ms / 86400000U),
+                    CO_TIME_SYNC_INTERVAL_MS);
+    }
+#endif
+
+    CANmodule->timeSync = timeSync;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_TIMEsync_set(CO_TIMEsync_t *timeSync, uint32_t ms, uint16_t days) {
+    uint64_t sync_ns = (uint64_t)days * NS_PER_DAY + (uint64_t)ms * 1000000U;
+    uint32_t now = CO_timer_us();
+
+    TIME_SYNC_LOCK();
+    timeSync->baseRaw_us = now;
+    timeSync->baseSync_ns = sync_ns;
+    timeSync->valid = true;
+    TIME_SYNC_UNLOCK();
+
+#if (CO_CONFIG_TIME) & CO_CONFIG_TIME_PRODUCER
+    if (timeSync->isProducer) {
+        CO_TIME_set(timeSync->TIME, ms, days, CO_TIME_SYNC_INTERVAL_MS);
+    }
+#endif
+}
+
+
+/******************************************************************************/
+uint64_t CO_TIMEsync_toSync_ns(CO_TIMEsync_t *timeSync, uint32_t raw_us) {
+    TIME_SYNC_LOCK();
+    uint64_t sync_ns = CO_TIMEsync_clock(timeSync, raw_us);
+    TIME_SYNC_UNLOCK();
+
+    return sync_ns;
+}
+
+
+/******************************************************************************/
+void CO_TIMEsync_process(CO_TIMEsync_t *timeSync) {
+    uint32_t cobId = 0;
+    uint32_t now = CO_timer_us();
+
+    OD_get_u32(timeSync->OD_1012_entry, 0, &cobId, true);
+    timeSync->ident = (uint16_t)(cobId & 0x7FFU);
+    timeSync->isProducer = (cobId & TIME_PRODUCER) != 0U;
+    timeSync->isConsumer = !timeSync->isProducer && (cobId & TIME_CONSUMER) != 0U;
+
+    if ((now - timeSync->baseRaw_us) > REBASE_US) {
+        CO_TIMEsync_rebase(timeSync, now, 0, timeSync->rate_ppb);
+    }
+
+    /* Producer: publish TX complete stamp of the TIME frame */
+    if (timeSync->txStampNew) {
+        timeSync->txStampNew = false;
+        timeSync->hrTimeStamp_us =
+            (uint32_t)(CO_TIMEsync_toSync_ns(timeSync, timeSync->txStamp_us) / 1000U);
+#if OD_FLAGS_PDO_SIZE > 0
+        if (timeSync->OD_1013_entry != NULL) {
+            OD_requestTPDO(OD_getFlagsPDO(timeSync->OD_1013_entry), 0);
+        }
+#endif
+    }
+
+    /* Consumer: set clock from TIME frame, if it is far off */
+    if (timeSync->rxNew) {
+        uint32_t stamp_us = timeSync->rxStamp_us;
+        uint64_t time_ns = (uint64_t)CO_getUint16(&timeSync->rxData[4]) * NS_PER_DAY
+            + (uint64_t)(CO_getUint32(&timeSync->rxData[0]) & 0x0FFFFFFFUL) * 1000000U;
+        timeSync->rxNew = false;
+
+        int64_t offset_ns = (int64_t)(time_ns
+                          - CO_TIMEsync_toSync_ns(timeSync, stamp_us));
+        if (!timeSync->valid
+            || offset_ns > ((int64_t)CO_TIME_SYNC_COARSE_US * 1000)
+            || offset_ns < -((int64_t)CO_TIME_SYNC_COARSE_US * 1000)
+        ) {
+            CO_TIMEsync_rebase(timeSync, stamp_us, offset_ns, timeSync->rate_ppb);
+            timeSync->valid = true;
+            timeSync->steps++;
+            CO_LOG(CO_LOG_TIME_SYNC_STEP, (uint32_t)(offset_ns / 1000), timeSync->steps);
+        }
+        timeSync->rxPairStamp_us = stamp_us;
+        timeSync->rxPairValid = true;
+    }
+
+    /* Consumer: producer stamp of the same frame, fine correction */
+    if (timeSync->followUpNew) {
+        timeSync->followUpNew = false;
+        if (timeSync->rxPairValid) {
+            uint64_t own_ns = CO_TIMEsync_toSync_ns(timeSync,
+                                                    timeSync->rxPairStamp_us);
+            int32_t diff_us = (int32_t)(timeSync->followUp_us
+                                        - (uint32_t)(own_ns / 1000U));
+            timeSync->rxPairValid = false;
+            CO_TIMEsync_servo(timeSync,
+                              (int64_t)diff_us * 1000 - (int64_t)(own_ns % 1000U),
+                              timeSync->rxPairStamp_us);
+        }
+    }
+}
+
+
+/******************************************************************************/
+void CO_TIMEsync_txLoad(CO_TIMEsync_t *timeSync, uint8_t *data) {
+    uint64_t ms = CO_TIMEsync_now_ns(timeSync) / 1000000U;
+
+    (void)CO_setUint32(&data[0], (uint32_t)(ms % 86400000U));
+    (void)CO_setUint16(&data[4], (uint16_t)(ms / 86400000U));
+    timeSync->txInFlight = true;
+}
+
+
+/******************************************************************************/
+void CO_TIMEsync_txComplete(CO_TIMEsync_t *timeSync) {
+    timeSync->txStamp_us = CO_timer_us();
+    timeSync->txInFlight = false;
+    timeSync->txStampNew = true;
+}
+
+
+/******************************************************************************/
+void CO_TIMEsync_rx(CO_TIMEsync_t *timeSync, const uint8_t *data) {
+    timeSync->rxStamp_us = CO_timer_us();
+    memcpy(timeSync->rxData, data, sizeof(timeSync->rxData));
+    timeSync->rxNew = true;
+}
+
+#endif /* (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE */
@@ -0,0 +1,220 @@
+/*
+ * Synchronized time base from TIME object with high resolution timestamps,
+ * for MAX32xxx.
+ *
+ * @file        CO_TIMEsync.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_TIME_SYNC_H
+#define CO_TIME_SYNC_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+#include "301/CO_TIME.h"
+
+#if ((CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Local clock, synchronized to the TIME producer. Synchronized time is
+ * calculated from CO_timer_us() with offset and rate correction, so any
+ * timestamp taken with CO_timer_us() converts to it.
+ *
+ * TIME frame carries time with 1 ms resolution, so it is only used for coarse
+ * setting of the clock. The TIME frame itself is the time reference: producer
+ * stamps it in the CAN TX complete interrupt, consumers stamp it in the CAN RX
+ * interrupt; both stamps are the end of the same frame on the bus. Producer
+ * then publishes its stamp in OD object 0x1013 "High resolution time stamp"
+ * (microseconds), which is mapped to a TPDO in the producer and to a RPDO in
+ * consumers. Consumer compares it with own RX stamp and corrects offset and
+ * rate of its clock with a PI servo. TIME period must be longer than the PDO
+ * latency, so follow-up arrives before the next TIME frame.
+ *
+ * Producer also writes the current synchronized time into the TIME frame,
+ * when the frame is written into the CAN TX buffer.
+ */
+
+/* TIME producer interval, set with CO_TIME_set() in init. */
+#ifndef CO_TIME_SYNC_INTERVAL_MS
+#define CO_TIME_SYNC_INTERVAL_MS 1000
+#endif
+/* Offset, above which clock is set instead of corrected by servo. */
+#ifndef CO_TIME_SYNC_STEP_US
+#define CO_TIME_SYNC_STEP_US 500
+#endif
+/* Offset to TIME frame, above which clock is set from TIME frame. It is
+ * larger than TIME frame resolution. */
+#ifndef CO_TIME_SYNC_COARSE_US
+#define CO_TIME_SYNC_COARSE_US 2000
+#endif
+/* Proportional and integral gain of the servo, in 1/1000. */
+#ifndef CO_TIME_SYNC_KP
+#define CO_TIME_SYNC_KP 700
+#endif
+#ifndef CO_TIME_SYNC_KI
+#define CO_TIME_SYNC_KI 300
+#endif
+/* Maximum rate correction in ppm. */
+#ifndef CO_TIME_SYNC_MAX_PPM
+#define CO_TIME_SYNC_MAX_PPM 500
+#endif
+
+/**
+ * Synchronized time object.
+ */
+typedef struct CO_TIMEsync {
+    CO_TIME_t *TIME;
+    OD_entry_t *OD_1012_entry;
+    OD_entry_t *OD_1013_entry;
+    OD_extension_t OD_1013_ext;
+    /** TIME CAN identifier and role from 0x1012 */
+    uint16_t ident;
+    bool_t isProducer;
+    bool_t isConsumer;
+    /** Clock, see CO_TIMEsync_toSync_ns() */
+    uint32_t baseRaw_us;
+    uint64_t baseSync_ns;
+    int32_t rate_ppb;
+    int32_t drift_ppb;
+    /** Clock was set, from application or from TIME frame */
+    bool_t valid;
+    /** Producer: TIME frame in CAN TX buffer, its TX complete stamp */
+    volatile bool_t txInFlight;
+    volatile bool_t txStampNew;
+    uint32_t txStamp_us;
+    /** Last high resolution time stamp, 0x1013 */
+    uint32_t hrTimeStamp_us;
+    /** Consumer: TIME frame RX stamp and data */
+    volatile bool_t rxNew;
+    uint32_t rxStamp_us;
+    uint8_t rxData[6];
+    /** Consumer: RX stamp waiting for 0x1013 follow-up */
+    bool_t rxPairValid;
+    uint32_t rxPairStamp_us;
+    volatile bool_t followUpNew;
+    uint32_t followUp_us;
+    uint32_t lastSample_us;
+    /** Statistics: last offset to producer, samples, clock settings */
+    int32_t offset_ns;
+    uint32_t samples;
+    uint32_t steps;
+} CO_TIMEsync_t;
+
+
+/**
+ * Initialize synchronized time and connect it to the CAN driver. Called after
+ * CO_CANopenInit() and before CO_CANopenInitPDO(), so PDO mapping of 0x1013
+ * uses this object.
+ *
+ * @param timeSync This object will be initialized.
+ * @param TIME TIME object, CO->TIME.
+ * @param CANmodule CAN module, CO->CANmodule.
+ * @param OD_1012_cobIdTime OD entry for 0x1012 - "COB-ID time stamp".
+ * @param OD_1013_hrTimeStamp OD entry for 0x1013 - "High resolution time
+ * stamp", may be NULL, clock is then only set from TIME frame.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_TIMEsync_init(CO_TIMEsync_t *timeSync,
+                                  CO_TIME_t *TIME,
+                                  CO_CANmodule_t *CANmodule,
+                                  OD_entry_t *OD_1012_cobIdTime,
+                                  OD_entry_t *OD_1013_hrTimeStamp);
+
+
+/**
+ * Set synchronized time, on producer.
+ *
+ * @param timeSync Synchronized time object.
+ * @param ms Milliseconds after midnight.
+ * @param days Days since January 1, 1984.
+ */
+void CO_TIMEsync_set(CO_TIMEsync_t *timeSync, uint32_t ms, uint16_t days);
+
+
+/**
+ * Convert CO_timer_us() timestamp to synchronized time.
+ *
+ * @param timeSync Synchronized time object.
+ * @param raw_us Timestamp from CO_timer_us(), not older than about 30 min.
+ *
+ * @return Nanoseconds since January 1, 1984.
+ */
+uint64_t CO_TIMEsync_toSync_ns(CO_TIMEsync_t *timeSync, uint32_t raw_us);
+
+
+/**
+ * Get synchronized time.
+ *
+ * @param timeSync Synchronized time object.
+ *
+ * @return Nanoseconds since January 1, 1984.
+ */
+static inline uint64_t CO_TIMEsync_now_ns(CO_TIMEsync_t *timeSync) {
+    return CO_TIMEsync_toSync_ns(timeSync, CO_timer_us());
+}
+
+
+/**
+ * Process stamps and run the servo. Called cyclically from mainline.
+ *
+ * @param timeSync Synchronized time object.
+ */
+void CO_TIMEsync_process(CO_TIMEsync_t *timeSync);
+
+
+/**
+ * Write synchronized time into TIME frame. Called by CAN driver, when TIME
+ * frame is written into the CAN TX buffer.
+ *
+ * @param timeSync Synchronized time object.
+ * @param data Data of TIME frame, 6 bytes.
+ */
+void CO_TIMEsync_txLoad(CO_TIMEsync_t *timeSync, uint8_t *data);
+
+
+/**
+ * Stamp TIME frame. Called from CO_CANTXinterrupt(), if
+ * CO_TIMEsync_t.txInFlight is set.
+ *
+ * @param timeSync Synchronized time object.
+ */
+void CO_TIMEsync_txComplete(CO_TIMEsync_t *timeSync);
+
+
+/**
+ * Stamp received TIME frame. Called from CO_CANRXinterrupt().
+ *
+ * @param timeSync Synchronized time object.
+ * @param data Data of TIME frame, 6 bytes.
+ */
+void CO_TIMEsync_rx(CO_TIMEsync_t *timeSync, const uint8_t *data);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE */
+
+#endif /* CO_TIME_SYNC_H */
@@ -0,0 +1,90 @@
+/*
+ * Change of state detection for event driven TPDOs, for MAX32xxx.
+ *
+ * @file        CO_TPDOcos.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_TPDOcos.h"
+
+
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+
+/******************************************************************************/
+CO_ReturnError_t CO_TPDOcos_init(CO_TPDOcos_t *cos,
+                                 CO_TPDO_t *TPDO,
+                                 uint16_t count)
+{
+    /* verify arguments */
+    if (cos == NULL || TPDO == NULL || count > CO_TPDO_COS_MAX) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(cos, 0, sizeof(CO_TPDOcos_t));
+    cos->TPDO = TPDO;
+    cos->count = count;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_TPDOcos_process(CO_TPDOcos_t *cos) {
+    for (uint16_t i = 0; i < cos->count; i++) {
+        CO_TPDO_t *TPDO = &cos->TPDO[i];
+        CO_PDO_common_t *PDO = &TPDO->PDO_common;
+        uint8_t *shadow = cos->shadow[i];
+        bool_t changed = false;
+        uint8_t pos = 0;
+
+        if (!PDO->valid
+            || TPDO->transmissionType < (uint8_t)CO_PDO_TRANSM_TYPE_SYNC_EVENT_LO
+        ) {
+            continue;
+        }
+
+        for (uint8_t j = 0; j < PDO->mappedObjectsCount; j++) {
+            OD_IO_t *OD_IO = &PDO->OD_IO[j];
+            /* CO_PDO.c keeps mapped length in stream.dataOffset */
+            uint8_t len = (uint8_t)OD_IO->stream.dataOffset;
+
+            if ((pos + len) > CO_PDO_MAX_SIZE) {
+                break;
+            }
+            if (OD_IO->read == OD_readOriginal && OD_IO->stream.dataOrig != NULL
+                && memcmp(&shadow[pos], OD_IO->stream.dataOrig, len) != 0
+            ) {
+                memcpy(&shadow[pos], OD_IO->stream.dataOrig, len);
+                changed = true;
+            }
+            pos += len;
+        }
+
+        if (changed && cos->primed) {
+            CO_TPDOsendRequest(TPDO);
+            cos->requests++;
+        }
+    }
+    cos->primed = true;
+}
+
+#endif /* (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE */
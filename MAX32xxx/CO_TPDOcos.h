@@ -0,0 +1,97 @@
+/*
+ * Change of state detection for event driven TPDOs, for MAX32xxx.
+ *
+ * @file        CO_TPDOcos.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_TPDO_COS_H
+#define CO_TPDO_COS_H
+
+#include "301/CO_driver.h"
+#include "301/CO_PDO.h"
+
+#if ((CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Event driven TPDOs (transmission type 0xFE or 0xFF) are sent on event timer
+ * or on OD_requestTPDO() from the application. This object keeps a shadow copy
+ * of the mapped bytes of each such TPDO and compares it with OD variables once
+ * per RT cycle, before TPDO processing. If the content has changed, TPDO send
+ * is requested, and the stack sends it after its inhibit time.
+ *
+ * Only the mapped bytes are compared, so the cost scales with the number of
+ * mapped bytes. Objects with OD extension (their value is not in OD memory)
+ * and dummy entries are not watched, use OD_requestTPDO() for them.
+ */
+
+/* Maximum number of TPDOs. */
+#ifndef CO_TPDO_COS_MAX
+#define CO_TPDO_COS_MAX 64
+#endif
+
+/**
+ * TPDO change of state object.
+ */
+typedef struct {
+    CO_TPDO_t *TPDO;
+    uint16_t count;
+    /** Mapped bytes of each TPDO, at its last change */
+    uint8_t shadow[CO_TPDO_COS_MAX][CO_PDO_MAX_SIZE];
+    /** Shadow copies were filled, changes are reported after first cycle */
+    bool_t primed;
+    /** Number of TPDO send requests on change */
+    uint32_t requests;
+} CO_TPDOcos_t;
+
+
+/**
+ * Initialize TPDO change of state object. Called after CO_CANopenInitPDO().
+ *
+ * @param cos This object will be initialized.
+ * @param TPDO Array of TPDO objects, CO->TPDO.
+ * @param count Number of TPDO objects, OD_CNT_TPDO.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_TPDOcos_init(CO_TPDOcos_t *cos,
+                                 CO_TPDO_t *TPDO,
+                                 uint16_t count);
+
+
+/**
+ * Compare mapped data of event driven TPDOs and request send on change.
+ * Called from RT thread before CO_process_TPDO(), with OD locked.
+ *
+ * @param cos TPDO change of state object.
+ */
+void CO_TPDOcos_process(CO_TPDOcos_t *cos);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE */
+
+#endif /* CO_TPDO_COS_H */
@@ -38,7 +38,9 @@
  * Function is called once on the program startup, after Object dictionary
  * initialization and before CANopen initialization.
  *
- * @param [in,out] bitRate Stored CAN bit rate, can be overridden.
+ * @param [in,out] bitRate Stored CAN bit rate, can be overridden. With
+ * CO_CONFIG_AUTO_BITRATE leave it 0, if no bit rate is stored, then the bit
+ * rate of the bus is detected.
  * @param [in,out] nodeId Stored CANopen NodeId, can be overridden.
  * @param [out] errInfo Variable may indicate error information - index of
  * erroneous OD entry.
@@ -74,7 +76,8 @@ void app_programEnd();
  * (app_programRt() app_peripheralRead() and app_peripheralWrite()), which all
  * run from the realtime thread. If accessing Object dictionary variable which
  * is also mappable to PDO, it is necessary to use CO_LOCK_OD() and
- * CO_UNLOCK_OD() macros from @ref CO_critical_sections.
+ * CO_UNLOCK_OD() macros from @ref CO_critical_sections, or the process image
+ * from CO_procImage.h.
  *
  * @param co CANopen object.
  * @param timer1usDiff Time difference since last call in microseconds
@@ -0,0 +1,94 @@
+/*
+ * Listen-only CAN bitrate detection, for MAX32xxx.
+ *
+ * @file        CO_autoBitrate.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CO_autoBitrate.h"
+
+
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+
+/* Set candidate and start counting for it */
+static void CO_autoBitrate_set(CO_autoBitrate_t *ab, uint8_t index) {
+    ab->index = index;
+    ab->bitRate = ab->rates[index];
+    ab->setBitRate(ab->object, ab->bitRate);
+    /* events of the previous candidate came before the controller switched */
+    ab->frames = 0;
+    ab->errors = 0;
+    ab->dwell_us = 0;
+    ab->tries++;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_autoBitrate_init(CO_autoBitrate_t *ab,
+                                     const uint16_t *rates,
+                                     uint8_t ratesCount,
+                                     void (*setBitRate)(void *object,
+                                                        uint16_t bitRate),
+                                     void *object)
+{
+    /* verify arguments */
+    if (ab == NULL || rates == NULL || ratesCount == 0 || setBitRate == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    ab->rates = rates;
+    ab->ratesCount = ratesCount;
+    ab->setBitRate = setBitRate;
+    ab->object = object;
+    ab->total_us = 0;
+    ab->tries = 0;
+    CO_autoBitrate_set(ab, 0);
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+uint8_t CO_autoBitrate_process(CO_autoBitrate_t *ab,
+                               uint32_t timeDifference_us)
+{
+    uint16_t errors = ab->errors;
+
+    if (errors == 0 && ab->frames >= CO_AUTO_BITRATE_FRAMES) {
+        return CO_AUTO_BITRATE_FOUND;
+    }
+
+    ab->dwell_us += timeDifference_us;
+    ab->total_us += timeDifference_us;
+    if (CO_AUTO_BITRATE_TIMEOUT_MS > 0
+        && ab->total_us >= (uint32_t)CO_AUTO_BITRATE_TIMEOUT_MS * 1000U
+    ) {
+        return CO_AUTO_BITRATE_TIMEOUT;
+    }
+
+    if (errors != 0 || ab->dwell_us >= (uint32_t)CO_AUTO_BITRATE_DWELL_MS * 1000U) {
+        uint8_t next = (uint8_t)(ab->index + 1U);
+        CO_autoBitrate_set(ab, next < ab->ratesCount ? next : 0);
+    }
+
+    return CO_AUTO_BITRATE_LISTEN;
+}
+
+#endif /* (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE */
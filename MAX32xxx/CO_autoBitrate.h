@@ -0,0 +1,158 @@
+/*
+ * Listen-only CAN bitrate detection, for MAX32xxx.
+ *
+ * @file        CO_autoBitrate.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_AUTO_BITRATE_H
+#define CO_AUTO_BITRATE_H
+
+#include "301/CO_driver.h"
+
+#if ((CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Node without stored bitrate joins a running bus at unknown bitrate. With the
+ * CAN controller in listen-only mode it never sends error frames or
+ * acknowledges, so wrong candidates do not disturb the bus. Each candidate of
+ * the list is tried for CO_AUTO_BITRATE_DWELL_MS. It is accepted after
+ * CO_AUTO_BITRATE_FRAMES valid frames without error. Any error reported by the
+ * controller skips the candidate immediately, so on a bus with normal traffic
+ * wrong candidates take only a few bit times each. List is repeated until
+ * CO_AUTO_BITRATE_TIMEOUT_MS.
+ *
+ * This object has no hardware access: CAN driver reports frames and errors
+ * from its interrupt and sets the candidate through the setBitRate callback.
+ * So it runs also against a simulated bus on the host.
+ */
+
+/* Time for each candidate, if there are no frames and no errors. */
+#ifndef CO_AUTO_BITRATE_DWELL_MS
+#define CO_AUTO_BITRATE_DWELL_MS 25
+#endif
+/* Number of valid frames, which confirm the candidate. */
+#ifndef CO_AUTO_BITRATE_FRAMES
+#define CO_AUTO_BITRATE_FRAMES 2
+#endif
+/* Detection gives up after this time, 0 for no limit. */
+#ifndef CO_AUTO_BITRATE_TIMEOUT_MS
+#define CO_AUTO_BITRATE_TIMEOUT_MS 1000
+#endif
+/* Bitrate in kbit/s used by main file, if detection gives up. */
+#ifndef CO_AUTO_BITRATE_DEFAULT
+#define CO_AUTO_BITRATE_DEFAULT 125
+#endif
+/* Candidates in kbit/s, most common first. */
+#ifndef CO_AUTO_BITRATE_LIST
+#define CO_AUTO_BITRATE_LIST {125, 250, 500, 1000, 50, 20, 10}
+#endif
+
+/* Return values of CO_autoBitrate_process() */
+#define CO_AUTO_BITRATE_LISTEN  0U  /* detection in progress */
+#define CO_AUTO_BITRATE_FOUND   1U  /* bitRate is the bus bitrate */
+#define CO_AUTO_BITRATE_TIMEOUT 2U  /* no candidate confirmed */
+
+/**
+ * Bitrate detection object.
+ */
+typedef struct CO_autoBitrate {
+    const uint16_t *rates;
+    uint8_t ratesCount;
+    /** Index of the candidate in rates */
+    uint8_t index;
+    /** Current candidate in kbit/s, result after CO_AUTO_BITRATE_FOUND */
+    uint16_t bitRate;
+    /** Frames and errors at current candidate, written from CAN interrupt */
+    volatile uint16_t frames;
+    volatile uint16_t errors;
+    uint32_t dwell_us;
+    uint32_t total_us;
+    /** Number of tried candidates */
+    uint16_t tries;
+    /** Sets the controller to listen-only mode at bitRate */
+    void (*setBitRate)(void *object, uint16_t bitRate);
+    void *object;
+} CO_autoBitrate_t;
+
+
+/**
+ * Initialize bitrate detection and set the first candidate.
+ *
+ * @param ab This object will be initialized.
+ * @param rates Array of candidates in kbit/s, must remain valid.
+ * @param ratesCount Number of candidates.
+ * @param setBitRate Function, which sets the controller to listen-only mode
+ * at given bitrate.
+ * @param object Pointer passed to setBitRate.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_autoBitrate_init(CO_autoBitrate_t *ab,
+                                     const uint16_t *rates,
+                                     uint8_t ratesCount,
+                                     void (*setBitRate)(void *object,
+                                                        uint16_t bitRate),
+                                     void *object);
+
+
+/**
+ * Valid frame was received, called from CAN interrupt.
+ *
+ * @param ab Bitrate detection object.
+ */
+static inline void CO_autoBitrate_frame(CO_autoBitrate_t *ab) {
+    ab->frames++;
+}
+
+
+/**
+ * Bus error was detected, called from CAN interrupt.
+ *
+ * @param ab Bitrate detection object.
+ */
+static inline void CO_autoBitrate_error(CO_autoBitrate_t *ab) {
+    ab->errors++;
+}
+
+
+/**
+ * Evaluate the current candidate and switch to the next one, if needed.
+ *
+ * @param ab Bitrate detection object.
+ * @param timeDifference_us Time since the previous call.
+ *
+ * @return CO_AUTO_BITRATE_LISTEN, CO_AUTO_BITRATE_FOUND or
+ * CO_AUTO_BITRATE_TIMEOUT.
+ */
+uint8_t CO_autoBitrate_process(CO_autoBitrate_t *ab,
+                               uint32_t timeDifference_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE */
+
+#endif /* CO_AUTO_BITRATE_H */
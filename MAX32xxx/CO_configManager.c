@@ -0,0 +1,239 @@
+/*
+ * CANopen configuration manager (CiA 302-3) for MAX32xxx master.
+ *
+ * @file        CO_configManager.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_configManager.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+
+/* Size of concise DCF entry header: index, subIndex, size */
+#define DCF_ENTRY_HDR 7U
+
+
+/* Finish configuration of the slave on the channel */
+static void CO_configManager_nodeEnd(CO_configManager_t *cfgMgr,
+                                     CO_configManager_channel_t *ch,
+                                     uint32_t abortCode)
+{
+    uint8_t nodeId = ch->node->nodeId;
+
+    if (abortCode == 0U) {
+        cfgMgr->nodesConfigured++;
+    }
+    else {
+        cfgMgr->nodesFailed++;
+        /* invalid entries of CO_configManagerNodes have no bit */
+        if (nodeId >= 1U && nodeId <= 127U) {
+            cfgMgr->failed[nodeId / 32U] |= 1UL << (nodeId % 32U);
+        }
+        CO_LOG(CO_LOG_CFG_NODE_FAILED, nodeId, abortCode);
+    }
+    CO_SDOclientClose(ch->SDO_C);
+    ch->node = NULL;
+    ch->data = NULL;
+}
+
+
+/* Take next slave from the list, return false if none */
+static bool_t CO_configManager_nodeStart(CO_configManager_t *cfgMgr,
+                                         CO_configManager_channel_t *ch)
+{
+    while (cfgMgr->nextNode < CO_configManagerNodesCount) {
+        const CO_configManager_node_t *node =
+            &CO_configManagerNodes[cfgMgr->nextNode++];
+
+        ch->node = node;
+        ch->pos = sizeof(uint32_t);
+        ch->data = NULL;
+        ch->noBlock = false;
+        if (node->nodeId < 1U || node->nodeId > 127U
+            || node->dcf == NULL || node->dcfSize < sizeof(uint32_t)
+        ) {
+            CO_configManager_nodeEnd(cfgMgr, ch, CO_SDO_AB_DATA_LOC_CTRL);
+            continue;
+        }
+        ch->entriesLeft = CO_getUint32(node->dcf);
+
+        if (CO_SDOclient_setup(ch->SDO_C,
+                               CO_CAN_ID_SDO_CLI + node->nodeId,
+                               CO_CAN_ID_SDO_SRV + node->nodeId,
+                               node->nodeId) != CO_SDO_RT_ok_communicationEnd
+        ) {
+            CO_configManager_nodeEnd(cfgMgr, ch, CO_SDO_AB_GENERAL);
+            continue;
+        }
+        return true;
+    }
+    return false;
+}
+
+
+/* Start download of the next concise DCF entry, return abort code */
+static uint32_t CO_configManager_entryStart(CO_configManager_channel_t *ch) {
+    const uint8_t *dcf = ch->node->dcf;
+
+    if ((ch->node->dcfSize - ch->pos) < DCF_ENTRY_HDR) {
+        return CO_SDO_AB_DATA_LOC_CTRL;
+    }
+
+    uint16_t index = CO_getUint16(&dcf[ch->pos]);
+    uint8_t subIndex = dcf[ch->pos + 2U];
+    uint32_t size = CO_getUint32(&dcf[ch->pos + 3U]);
+
+    if (size == 0U
+        || size > (ch->node->dcfSize - ch->pos - DCF_ENTRY_HDR)
+    ) {
+        return CO_SDO_AB_DATA_LOC_CTRL;
+    }
+    ch->data = &dcf[ch->pos + DCF_ENTRY_HDR];
+    ch->size = size;
+    ch->written = 0;
+
+    if (CO_SDOclientDownloadInitiate(ch->SDO_C, index, subIndex, size,
+                                     CO_CFG_MGR_SDO_TIMEOUT_MS,
+                                     !ch->noBlock && size >= CO_CFG_MGR_BLOCK_MIN)
+        != CO_SDO_RT_ok_communicationEnd
+    ) {
+        return CO_SDO_AB_GENERAL;
+    }
+    return 0;
+}
+
+
+/* Process download on the channel */
+static void CO_configManager_channelProcess(CO_configManager_t *cfgMgr,
+                                            CO_configManager_channel_t *ch,
+                                            uint32_t timeDifference_us,
+                                            uint32_t *timerNext_us)
+{
+    CO_SDO_abortCode_t abortCode = CO_SDO_AB_NONE;
+
+    if (ch->data == NULL) {
+        if (ch->entriesLeft == 0U) {
+            CO_configManager_nodeEnd(cfgMgr, ch, 0);
+            return;
+        }
+        uint32_t err = CO_configManager_entryStart(ch);
+        if (err != 0U) {
+            CO_configManager_nodeEnd(cfgMgr, ch, err);
+            return;
+        }
+    }
+
+    /* Data is in flash, fill SDO client buffer as it empties */
+    if (ch->written < ch->size) {
+        ch->written += CO_SDOclientDownloadBufWrite(ch->SDO_C,
+                                                    &ch->data[ch->written],
+                                                    ch->size - ch->written);
+    }
+
+    CO_SDO_return_t ret = CO_SDOclientDownload(ch->SDO_C, timeDifference_us,
+                                               false, ch->written < ch->size,
+                                               &abortCode, NULL, timerNext_us);
+    if (ret == CO_SDO_RT_ok_communicationEnd) {
+        ch->pos += DCF_ENTRY_HDR + ch->size;
+        ch->entriesLeft--;
+        ch->data = NULL;
+        /* next entry without waiting */
+        if (timerNext_us != NULL) {
+            *timerNext_us = 0;
+        }
+    }
+    else if (ret < 0) {
+        if (abortCode == CO_SDO_AB_CMD && !ch->noBlock
+            && ch->size >= CO_CFG_MGR_BLOCK_MIN
+        ) {
+            /* Block transfer not supported, repeat entry segmented */
+            ch->noBlock = true;
+            ch->data = NULL;
+        }
+        else {
+            CO_configManager_nodeEnd(cfgMgr, ch, (uint32_t)abortCode);
+        }
+    }
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_configManager_init(CO_configManager_t *cfgMgr,
+                                       CO_SDOclient_t *SDOclients,
+                                       uint8_t SDOclientsCount)
+{
+    /* verify arguments */
+    if (cfgMgr == NULL || SDOclients == NULL || SDOclientsCount == 0U) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(cfgMgr, 0, sizeof(CO_configManager_t));
+
+    cfgMgr->channels = (SDOclientsCount < CO_CFG_MGR_CHANNELS)
+                     ? SDOclientsCount : CO_CFG_MGR_CHANNELS;
+    for (uint8_t i = 0; i < cfgMgr->channels; i++) {
+        cfgMgr->ch[i].SDO_C = &SDOclients[i];
+    }
+    cfgMgr->lastCall_us = CO_timer_us();
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+bool_t CO_configManager_process(CO_configManager_t *cfgMgr,
+                                uint32_t *timerNext_us)
+{
+    bool_t busy = false;
+
+    if (cfgMgr->finished) {
+        return true;
+    }
+
+    uint32_t now_us = CO_timer_us();
+    uint32_t timeDifference_us = now_us - cfgMgr->lastCall_us;
+    cfgMgr->lastCall_us = now_us;
+    cfgMgr->time_us += timeDifference_us;
+
+    for (uint8_t i = 0; i < cfgMgr->channels; i++) {
+        CO_configManager_channel_t *ch = &cfgMgr->ch[i];
+
+        if (ch->node == NULL && !CO_configManager_nodeStart(cfgMgr, ch)) {
+            continue;
+        }
+        CO_configManager_channelProcess(cfgMgr, ch, timeDifference_us,
+                                        timerNext_us);
+        if (ch->node != NULL || cfgMgr->nextNode < CO_configManagerNodesCount) {
+            busy = true;
+        }
+    }
+
+    if (!busy) {
+        cfgMgr->finished = true;
+        CO_LOG(CO_LOG_CFG_FINISHED, cfgMgr->time_us / 1000U, cfgMgr->channels);
+    }
+    return cfgMgr->finished;
+}
+
+#endif /* (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE */
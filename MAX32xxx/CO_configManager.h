@@ -0,0 +1,153 @@
+/*
+ * CANopen configuration manager (CiA 302-3) for MAX32xxx master.
+ *
+ * @file        CO_configManager.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_CONFIG_MANAGER_H
+#define CO_CONFIG_MANAGER_H
+
+#include "301/CO_driver.h"
+#include "301/CO_SDOclient.h"
+
+#if ((CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Configuration manager downloads concise DCF of each slave listed in
+ * CO_configManagerNodes. Each SDO client of the Object Dictionary (0x1280,
+ * 0x1281, ...) is one channel, channels configure different slaves in
+ * parallel. When a channel finishes its slave, it takes the next one from the
+ * list.
+ *
+ * Concise DCF (CiA 302-3), little endian:
+ * - UNSIGNED32: number of entries,
+ * - each entry: UNSIGNED16 index, UNSIGNED8 subIndex, UNSIGNED32 size, data.
+ */
+
+/* Maximum number of parallel channels (SDO clients). */
+#ifndef CO_CFG_MGR_CHANNELS
+#define CO_CFG_MGR_CHANNELS 8
+#endif
+/* Entries of this size or more are downloaded by SDO block transfer. Shorter
+ * entries are expedited or segmented, which takes less messages. */
+#ifndef CO_CFG_MGR_BLOCK_MIN
+#define CO_CFG_MGR_BLOCK_MIN 28
+#endif
+#ifndef CO_CFG_MGR_SDO_TIMEOUT_MS
+#define CO_CFG_MGR_SDO_TIMEOUT_MS 500
+#endif
+
+/**
+ * Slave to be configured.
+ */
+typedef struct {
+    uint8_t nodeId;
+    /** Concise DCF, usually const array in flash */
+    const uint8_t *dcf;
+    uint32_t dcfSize;
+} CO_configManager_node_t;
+
+/**
+ * List of slaves, provided by application. Slaves are configured in this
+ * order.
+ */
+extern const CO_configManager_node_t CO_configManagerNodes[];
+extern const uint8_t CO_configManagerNodesCount;
+
+/**
+ * Channel, one SDO client configuring one slave.
+ */
+typedef struct {
+    CO_SDOclient_t *SDO_C;
+    /** Slave being configured, NULL if channel is free */
+    const CO_configManager_node_t *node;
+    /** Position of the next entry in concise DCF */
+    uint32_t pos;
+    uint32_t entriesLeft;
+    /** Data of the entry being downloaded, NULL if none */
+    const uint8_t *data;
+    uint32_t size;
+    uint32_t written;
+    /** Slave does not support SDO block transfer */
+    bool_t noBlock;
+} CO_configManager_channel_t;
+
+/**
+ * Configuration manager object.
+ */
+typedef struct {
+    CO_configManager_channel_t ch[CO_CFG_MGR_CHANNELS];
+    uint8_t channels;
+    /** Position of the next free slave in CO_configManagerNodes */
+    uint8_t nextNode;
+    uint8_t nodesConfigured;
+    uint8_t nodesFailed;
+    /** Failed slaves, bit (nodeId) */
+    uint32_t failed[4];
+    uint32_t lastCall_us;
+    /** Network configuration time, valid when finished */
+    uint32_t time_us;
+    bool_t finished;
+} CO_configManager_t;
+
+
+/**
+ * Initialize configuration manager and start configuration. Called after
+ * CO_CANopenInit().
+ *
+ * @param cfgMgr This object will be initialized.
+ * @param SDOclients Array of SDO client objects, CO->SDOclient. With
+ * CO_CONFIG_GTW_UART it starts at CO->SDOclient[1], first client belongs to
+ * the ASCII gateway.
+ * @param SDOclientsCount Number of SDO clients in SDOclients. Maximum
+ * CO_CFG_MGR_CHANNELS are used.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT.
+ */
+CO_ReturnError_t CO_configManager_init(CO_configManager_t *cfgMgr,
+                                       CO_SDOclient_t *SDOclients,
+                                       uint8_t SDOclientsCount);
+
+
+/**
+ * Process configuration manager. Called from mainline as often as possible,
+ * not only once per millisecond, because SDO client sends one block segment
+ * per call. SDO clients must not be used by others until finished.
+ *
+ * @param cfgMgr Configuration manager object.
+ * @param [out] timerNext_us info to OS, may be NULL.
+ *
+ * @return true, when all slaves are processed, see nodesFailed.
+ */
+bool_t CO_configManager_process(CO_configManager_t *cfgMgr,
+                                uint32_t *timerNext_us);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE */
+
+#endif /* CO_CONFIG_MANAGER_H */
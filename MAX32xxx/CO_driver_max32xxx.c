@@ -24,19 +24,24 @@
  * limitations under the License.
  */
 
-#include <stdio.h>
+#include <string.h>
 
 #include "mxc_device.h"
 #include "mxc_lock.h"
+#include "mxc_delay.h"
 #include "can.h"
 
 #include "301/CO_driver.h"
-
-#ifdef DEBUG_MODE
-#define PRINT(...) printf(__VA_ARGS__)
-#else
-#define PRINT(...)
-#endif
+#include "CO_CANstats.h"
+#include "CO_CANtrace.h"
+#include "CO_HBmonitor.h"
+#include "CO_SYNCtimer.h"
+#include "CO_TIMEsync.h"
+#include "CO_autoBitrate.h"
+#include "CO_CANselfTest.h"
+#include "CO_CANbridge.h"
+#include "CO_CANextId.h"
+#include "CO_log.h"
 
 #define MAP_B   1
 
@@ -48,10 +53,24 @@
 #define CAN_ERR_THRESH_PASSIVE    128U
 #define CAN_ERR_THRESH_BUSOFF     256U
 
+/* Polling interval of bitrate detection */
+#define CAN_AUTO_BITRATE_POLL_US  500U
+
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_CYCLES
+#if defined(__riscv)
+#error "CO_CONFIG_RAM_FUNC_CYCLES requires Cortex-M DWT cycle counter"
+#endif
+#define CAN_CYCLES() (DWT->CYCCNT)
+#endif
+
 /* Global variables and objects */
 static mxc_can_req_t rxReq;
-static mxc_can_msg_info_t rxInfo;
-static uint8_t rxData[64];
+static CO_CANrxMsg_t rxRing[CO_CAN_RX_RING_SIZE];
+static uint8_t rxRingIdx;
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+/* Oldest slot queued to CAN RX task, slots from here to rxRingIdx are held */
+static volatile uint8_t rxRingTail;
+#endif
 static CO_CANmodule_t *CANthis;
 
 typedef struct {
@@ -77,6 +96,45 @@ const CO_CANbitRateData_t CO_CANbitRateData[] = {
 /* CAN driver callback functions */
 void canUnitEvent_cb(uint32_t can_idx, uint32_t event);
 void canObjEvent_cb(uint32_t can_idx, uint32_t event);
+void CO_CANTXinterrupt(CO_CANmodule_t *CANmodule);
+void CO_CANRXinterrupt(CO_CANmodule_t *CANmodule);
+
+/* Point message read request to the ring slot. MSDK driver keeps pointer to
+ * the read request, so next received message is written into this slot. */
+static inline void can_rxSlotArm(CO_CANrxMsg_t *slot)
+{
+    rxReq.msg_info = &slot->info;
+    rxReq.data = slot->data;
+    rxReq.data_sz = sizeof(slot->data);
+}
+
+/******************************************************************************/
+bool_t CO_CANsetBitRate(void *CANptr, uint16_t CANbitRate)
+{
+    const CO_CANbitRateData_t *CANbitRateData = NULL;
+
+    for (uint16_t i = 0; i < sizeof(CO_CANbitRateData) / sizeof(CO_CANbitRateData[0]);
+            i++) {
+        if (CO_CANbitRateData[i].bitrate == CANbitRate) {
+            CANbitRateData = &CO_CANbitRateData[i];
+            break;
+        }
+    }
+
+    if (CANbitRateData == NULL) {
+        return false;
+    }
+
+    if (MXC_CAN_SetBitRate(MXC_CAN_GET_IDX(CANptr),
+            MXC_CAN_BITRATE_SEL_NOMINAL, (uint32_t)CANbitRate * 1000,
+            MXC_CAN_BIT_SEGMENTS(CANbitRateData->nseg1, CANbitRateData
+                    ->nseg2, CANbitRateData->nsjw)) != E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_BITRATE_FAILED, CANbitRate, 0);
+        return false;
+    }
+
+    return true;
+}
 
 /******************************************************************************/
 void CO_CANsetConfigurationMode(void *CANptr){
@@ -84,7 +142,7 @@ void CO_CANsetConfigurationMode(void *CANptr){
     int err = MXC_CAN_SetMode(MXC_CAN_GET_IDX(CANptr),
             MXC_CAN_MODE_INITIALIZATION);
     if (err != E_NO_ERROR) {
-        PRINT("%s: Error: MXC_CAN_SetMode() failed: %d\n", __func__, err);
+        CO_LOG(CO_LOG_CAN_SET_MODE_FAILED, MXC_CAN_MODE_INITIALIZATION, err);
     }
 }
 
@@ -92,15 +150,59 @@ void CO_CANsetConfigurationMode(void *CANptr){
 /******************************************************************************/
 void CO_CANsetNormalMode(CO_CANmodule_t *CANmodule){
     /* Put CAN module in normal mode */
-    if (MXC_CAN_SetMode(MXC_CAN_GET_IDX(CANmodule->CANptr),
-            MXC_CAN_MODE_NORMAL) != E_NO_ERROR) {
-        PRINT("%s: Error: MXC_CAN_SetMode() failed\n", __func__);
+    int err = MXC_CAN_SetMode(MXC_CAN_GET_IDX(CANmodule->CANptr),
+            MXC_CAN_MODE_NORMAL);
+    if (err != E_NO_ERROR) {
+        CO_LOG(CO_LOG_CAN_SET_MODE_FAILED, MXC_CAN_MODE_NORMAL, err);
     } else {
         CANmodule->CANnormal = true;
     }
 }
 
 
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+/* Set candidate bitrate, called from CO_autoBitrate_process() */
+static void can_setListenOnly(void *object, uint16_t bitRate)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)object;
+    uint32_t idx = MXC_CAN_GET_IDX(CANmodule->CANptr);
+
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_INITIALIZATION);
+    (void)CO_CANsetBitRate(CANmodule->CANptr, bitRate);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_MONITOR);
+}
+
+
+/******************************************************************************/
+uint16_t CO_CANdetectBitRate(CO_CANmodule_t *CANmodule){
+    static const uint16_t rates[] = CO_AUTO_BITRATE_LIST;
+    CO_autoBitrate_t ab;
+    uint8_t ret;
+
+    if (CO_autoBitrate_init(&ab, rates, sizeof(rates) / sizeof(rates[0]),
+                            can_setListenOnly, CANmodule) != CO_ERROR_NO) {
+        return 0;
+    }
+    CANmodule->autoBitrate = &ab;
+
+    /* SysTick of bare-metal main is not running yet */
+    do {
+        MXC_Delay(CAN_AUTO_BITRATE_POLL_US);
+        ret = CO_autoBitrate_process(&ab, CAN_AUTO_BITRATE_POLL_US);
+    } while (ret == CO_AUTO_BITRATE_LISTEN);
+
+    /* stop reception before the interrupt loses its object */
+    (void)MXC_CAN_SetMode(MXC_CAN_GET_IDX(CANmodule->CANptr),
+                          MXC_CAN_MODE_INITIALIZATION);
+    CANmodule->autoBitrate = NULL;
+    CO_LOG(CO_LOG_CAN_AUTO_BITRATE, ret == CO_AUTO_BITRATE_FOUND ? ab.bitRate : 0,
+           ab.tries);
+
+    return ret == CO_AUTO_BITRATE_FOUND ? ab.bitRate : 0;
+}
+#endif
+
+
 /******************************************************************************/
 CO_ReturnError_t CO_CANmodule_init(
         CO_CANmodule_t         *CANmodule,
@@ -112,11 +214,10 @@ CO_ReturnError_t CO_CANmodule_init(
         uint16_t                CANbitRate)
 {
     uint16_t i;
-    uint32_t bitrate = CANbitRate * 1000;
-    const CO_CANbitRateData_t *CANbitRateData = NULL;
 
     /* verify arguments */
-    if(CANmodule==NULL || rxArray==NULL || txArray==NULL){
+    if(CANmodule==NULL || rxArray==NULL || txArray==NULL
+       || txSize > CO_CAN_TX_SYNC_WORDS * 32U){
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
 
@@ -127,16 +228,87 @@ CO_ReturnError_t CO_CANmodule_init(
     CANmodule->txArray = txArray;
     CANmodule->txSize = txSize;
     CANmodule->CANerrorStatus = 0;
+    CANmodule->rxExtRejected = 0U;
     CANmodule->CANnormal = false;
     /* Number of hardware filters are usually less than rxSize. */
     CANmodule->useCANrxFilters = false;
     CANmodule->bufferInhibitFlag = false;
     CANmodule->firstCANtxMessage = true;
     CANmodule->CANtxCount = 0U;
+    memset((void *)CANmodule->txSyncPending, 0, sizeof(CANmodule->txSyncPending));
+    CANmodule->txSyncAborted = 0U;
+    CANmodule->txSyncDropped = 0U;
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_CYCLES
+    CANmodule->rxCyclesMax = 0U;
+    CANmodule->txCyclesMax = 0U;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
     CANmodule->errOld = 0U;
+    CANmodule->errPoll_us = CO_timer_us();
+    CANmodule->errActiveTime_us = 0U;
+    CANmodule->errWarningTime_us = 0U;
+    CANmodule->errPassiveTime_us = 0U;
+    CANmodule->errBusOffTime_us = 0U;
     CANmodule->txLock = 0;
     CANmodule->emcyLock = 0;
     CANmodule->odLock = 0;
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+    CANmodule->busOffState = CO_CAN_BUSOFF_NONE;
+    CANmodule->busOffCount = 0U;
+    CANmodule->busOffRecovered_us = CO_timer_us();
+    CANmodule->busOffBackoff_ms = 0U;
+    CANmodule->busOffRecoveryTime_us = 0U;
+    CANmodule->busOffRecoveryTimeMax_us = 0U;
+#endif
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+    CANmodule->stats = NULL;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    CANmodule->trace = NULL;
+    CANmodule->rxInjectPending = false;
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+    CANmodule->hbMonitor = NULL;
+    CANmodule->hbConsumerRx = false;
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+    CANmodule->syncTimer = NULL;
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+    CANmodule->timeSync = NULL;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+    CANmodule->selfTest = NULL;
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+    CANmodule->bridge = NULL;
+#endif
+#if (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE
+    CANmodule->extId = NULL;
+#endif
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    CANmodule->autoBitrate = NULL;
+#endif
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+    CANmodule->pFunctSignalError = NULL;
+    CANmodule->functSignalErrorObject = NULL;
+#endif
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+    /* Created once, tasks keep using them across communication reset */
+    if (CANmodule->rxQueue == NULL) {
+        CANmodule->rxQueue = xQueueCreate(CO_CAN_RX_QUEUE_SIZE,
+                                          sizeof(CO_CANrxMsg_t *));
+    }
+    if (CANmodule->odMutex == NULL) {
+        CANmodule->odMutex = xSemaphoreCreateMutex();
+    }
+    if (CANmodule->rxQueue == NULL || CANmodule->odMutex == NULL) {
+        return CO_ERROR_OUT_OF_MEMORY;
+    }
+    xQueueReset(CANmodule->rxQueue);
+    CANmodule->rxQueueOverflow = 0U;
+#endif
 
     CANthis = CANmodule;
 
@@ -154,7 +326,7 @@ CO_ReturnError_t CO_CANmodule_init(
     /* Configure CAN module registers */
     if (MXC_CAN_PowerControl(MXC_CAN_GET_IDX(CANmodule->CANptr),
         MXC_CAN_PWR_CTRL_FULL) != E_NO_ERROR) {
-        PRINT("%s: Error: MXC_CAN_PowerControl() failed\n", __func__);
+        CO_LOG(CO_LOG_CAN_POWER_FAILED, MXC_CAN_PWR_CTRL_FULL, 0);
         return CO_ERROR_INVALID_STATE;
     }
 #if TARGET_NUM == 32662
@@ -171,23 +343,7 @@ CO_ReturnError_t CO_CANmodule_init(
 #endif
 
     /* Configure CAN timing */
-    for (i = 0; i < sizeof(CO_CANbitRateData) / sizeof(CO_CANbitRateData[0]);
-            i++) {
-        if (CO_CANbitRateData[i].bitrate == CANbitRate) {
-            CANbitRateData = &CO_CANbitRateData[i];
-            break;
-        }
-    }
-
-    if (CANbitRateData == NULL) {
-        return CO_ERROR_ILLEGAL_BAUDRATE;
-    }
-
-    if (MXC_CAN_SetBitRate(MXC_CAN_GET_IDX(CANmodule->CANptr),
-            MXC_CAN_BITRATE_SEL_NOMINAL, bitrate,
-            MXC_CAN_BIT_SEGMENTS(CANbitRateData->nseg1, CANbitRateData
-                    ->nseg2, CANbitRateData->nsjw)) != E_NO_ERROR) {
-        PRINT("%s: Error: MXC_CAN_SetBitrate() failed\n", __func__);
+    if (!CO_CANsetBitRate(CANmodule->CANptr, CANbitRate)) {
         return CO_ERROR_ILLEGAL_BAUDRATE;
     }
 
@@ -200,7 +356,8 @@ CO_ReturnError_t CO_CANmodule_init(
     }
     else{
         /* CAN module filters are not used, all messages with standard 11-bit */
-        /* identifier will be received */
+        /* identifier will be received. Filter compares the same bits of */
+        /* extended identifier, they are rejected in CO_CANRXinterrupt(). */
         /* Configure mask 0 so, that all messages with standard identifier are accepted */
     	MXC_CAN_ObjectSetFilter(MXC_CAN_GET_IDX(CANmodule->CANptr),
 		MXC_CAN_FILT_CFG_MASK_DEL | MXC_CAN_FILT_CFG_SINGLE_STD_ID,
@@ -210,13 +367,15 @@ CO_ReturnError_t CO_CANmodule_init(
                 CAN_STD_ID_MASK, 0);
     }
 
-    /* Store message read request */
-    rxReq.data = rxData;
-    rxReq.data_sz = sizeof(rxData);
-    rxReq.msg_info = &rxInfo;
+    /* Store message read request, targeting the first ring slot */
+    rxRingIdx = 0U;
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+    rxRingTail = 0U;
+#endif
+    can_rxSlotArm(&rxRing[rxRingIdx]);
     if (MXC_CAN_MessageReadAsync(MXC_CAN_GET_IDX(CANmodule->CANptr), &rxReq)
             < E_NO_ERROR) {
-        PRINT("%s: Error: MXC_CAN_MessageReadAsync() failed\n", __func__);
+        CO_LOG(CO_LOG_CAN_READ_FAILED, 0, 0);
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
 
@@ -230,10 +389,10 @@ void CO_CANmodule_disable(CO_CANmodule_t *CANmodule) {
         /* turn off the module */
         if (MXC_CAN_PowerControl(MXC_CAN_GET_IDX(CANmodule->CANptr),
                 MXC_CAN_PWR_CTRL_OFF) != E_NO_ERROR) {
-            PRINT("%s: Error: MXC_CAN_PowerControl() failed\n", __func__);
+            CO_LOG(CO_LOG_CAN_POWER_FAILED, MXC_CAN_PWR_CTRL_OFF, 0);
         }
         if (MXC_CAN_UnInit(MXC_CAN_GET_IDX(CANmodule->CANptr)) != E_NO_ERROR) {
-            PRINT("%s: Error: MXC_CAN_UnInit() failed\n", __func__);
+            CO_LOG(CO_LOG_CAN_UNINIT_FAILED, 0, 0);
         }
     }
 }
@@ -266,6 +425,13 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = MXC_CAN_STANDARD_ID(mask) | MXC_CAN_BUF_CFG_RTR(1);
 
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+        /* Heartbeats must then also be dispatched to rxArray */
+        if ((ident & ~0x7FU) == CO_CAN_ID_HEARTBEAT && (ident & 0x7FU) != 0U) {
+            CANmodule->hbConsumerRx = true;
+        }
+#endif
+
         /* Set CAN hardware module filter and mask. */
         if(CANmodule->useCANrxFilters){
             __NOP();
@@ -308,11 +474,20 @@ CO_CANtx_t *CO_CANtxBufferInit(
 
 
 /******************************************************************************/
-static int can_MessageSend(void *canPtr, CO_CANtx_t *buffer)
+CO_RAMFUNC
+static int can_MessageSend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
 {
     mxc_can_req_t req;
     mxc_can_msg_info_t info;
 
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+    /* TIME frame carries the time, when it enters the CAN TX buffer */
+    if (CANmodule->timeSync != NULL && CANmodule->timeSync->isProducer
+        && buffer->ident == CANmodule->timeSync->ident && buffer->DLC == 6U
+    ) {
+        CO_TIMEsync_txLoad(CANmodule->timeSync, buffer->data);
+    }
+#endif
     info.brs = 0;
     info.dlc = buffer->DLC;
     info.esi = 0;
@@ -323,13 +498,35 @@ static int can_MessageSend(void *canPtr, CO_CANtx_t *buffer)
     req.data = buffer->data;
     req.data_sz = buffer->DLC;
     req.msg_info = &info;
-    return MXC_CAN_MessageSendAsync(MXC_CAN_GET_IDX(canPtr), &req);
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+    if (CANmodule->stats != NULL) {
+        CO_CANstats_frame(CANmodule->stats, info.msg_id, info.dlc, true);
+    }
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    if (CANmodule->trace != NULL) {
+        CO_CANtrace_record(CANmodule->trace, info.msg_id | (info.rtr ?
+                           CO_CAN_TRACE_RTR : 0U), info.dlc, buffer->data, true);
+    }
+#endif
+    return MXC_CAN_MessageSendAsync(MXC_CAN_GET_IDX(CANmodule->CANptr), &req);
 }
 
+CO_RAMFUNC
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     CO_ReturnError_t err = CO_ERROR_NO;
     uint8_t canStat;
 
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+    /* Mainline keeps running during the self-test, other frames are dropped */
+    if (CANmodule->selfTest != NULL
+        && (buffer < CANmodule->txArray
+            || buffer >= &CANmodule->txArray[CANmodule->txSize])
+    ) {
+        return CO_ERROR_TX_BUSY;
+    }
+#endif
+
     /* Verify overflow */
     if(buffer->bufferFull){
         if(!CANmodule->firstCANtxMessage){
@@ -343,7 +540,7 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     /* if CAN TX buffer is free, copy message to it */
     canStat = ((mxc_can_regs_t *) CANmodule->CANptr)->stat;
     if((canStat & MXC_F_CAN_STAT_TXBUF) && CANmodule->CANtxCount == 0){
-        if (can_MessageSend(CANmodule->CANptr, buffer) != E_NO_ERROR) {
+        if (can_MessageSend(CANmodule, buffer) != E_NO_ERROR) {
             err = CO_ERROR_TX_BUSY;
         }
         CANmodule->bufferInhibitFlag = buffer->syncFlag;
@@ -353,6 +550,10 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
     else{
         buffer->bufferFull = true;
         CANmodule->CANtxCount++;
+        if(buffer->syncFlag){
+            uint16_t index = (uint16_t)(buffer - CANmodule->txArray);
+            CANmodule->txSyncPending[index >> 5] |= 1UL << (index & 31U);
+        }
     }
     CO_UNLOCK_CAN_SEND(CANmodule);
 
@@ -360,31 +561,75 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
 }
 
 
+#if ((CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE) \
+    || ((CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE)
+/******************************************************************************/
+CO_RAMFUNC
+bool_t CO_CANsendFromISR(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer){
+    bool_t sent = false;
+
+#if !((CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE)
+    /* Interrupted CO_CANsend() may hold the lock, it then sends or queues a
+     * message, so the caller gets the next TX interrupt anyway. */
+    if (MXC_GetLock(&CANmodule->txLock, 1) != E_NO_ERROR) {
+        return false;
+    }
+#endif
+    uint8_t canStat = ((mxc_can_regs_t *) CANmodule->CANptr)->stat;
+    if((canStat & MXC_F_CAN_STAT_TXBUF) && CANmodule->CANtxCount == 0){
+        if (can_MessageSend(CANmodule, buffer) != E_NO_ERROR) {
+            CO_LOG(CO_LOG_CAN_SEND_FAILED, buffer->ident, 0);
+        }
+        CANmodule->bufferInhibitFlag = buffer->syncFlag;
+        sent = true;
+    }
+#if !((CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE)
+    MXC_FreeLock(&CANmodule->txLock);
+#endif
+
+    return sent;
+}
+#endif
+
+
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule){
+    mxc_can_regs_t *can = (mxc_can_regs_t *)CANmodule->CANptr;
     uint32_t tpdoDeleted = 0U;
 
     CO_LOCK_CAN_SEND(CANmodule);
     /* Abort message from CAN module, if there is synchronous TPDO.
-     * Take special care with this functionality. */
-    if(/*messageIsOnCanBuffer && */CANmodule->bufferInhibitFlag){
-        /* clear TXREQ */
+     * Frame, which is already on the bus, is completed. Otherwise controller
+     * releases its TX buffer and TX interrupt sends the next queued message. */
+    if(CANmodule->bufferInhibitFlag){
+        uint32_t canStat = can->stat;
+
+        if((canStat & MXC_F_CAN_STAT_TXBUF) == 0U
+           && (canStat & MXC_F_CAN_STAT_TX) == 0U
+        ){
+            can->cmd = MXC_F_CAN_CMD_ABORT;
+            CANmodule->txSyncAborted++;
+        }
         CANmodule->bufferInhibitFlag = false;
         tpdoDeleted = 1U;
     }
-    /* delete also pending synchronous TPDOs in TX buffers */
-    if(CANmodule->CANtxCount != 0U){
-        uint16_t i;
-        CO_CANtx_t *buffer = &CANmodule->txArray[0];
-        for(i = CANmodule->txSize; i > 0U; i--){
+    /* delete also pending synchronous TPDOs in TX buffers, only set bits of
+     * the bitmap are visited */
+    for(uint16_t w = 0U; w < CO_CAN_TX_SYNC_WORDS; w++){
+        uint32_t pending = CANmodule->txSyncPending[w];
+
+        CANmodule->txSyncPending[w] = 0U;
+        while(pending != 0U){
+            uint32_t bit = (uint32_t)__builtin_ctz(pending);
+            CO_CANtx_t *buffer = &CANmodule->txArray[(w << 5) + bit];
+
+            pending &= pending - 1U;
             if(buffer->bufferFull){
-                if(buffer->syncFlag){
-                    buffer->bufferFull = false;
-                    CANmodule->CANtxCount--;
-                    tpdoDeleted = 2U;
-                }
+                buffer->bufferFull = false;
+                CANmodule->CANtxCount--;
+                CANmodule->txSyncDropped++;
+                tpdoDeleted = 2U;
             }
-            buffer++;
         }
     }
     CO_UNLOCK_CAN_SEND(CANmodule);
@@ -396,25 +641,117 @@ void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule){
 }
 
 
-/******************************************************************************/
-/* Get error counters from the module. If necessary, function may use
- * different way to determine errors. */
-void CO_CANmodule_process(CO_CANmodule_t *CANmodule) {
-    uint32_t err;
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+/* Restart CAN controller after bus-off. Controller rejoins the bus after it
+ * detects 128 occurrences of 11 recessive bits. */
+static void can_busOffRestart(CO_CANmodule_t *CANmodule) {
+    uint32_t idx = MXC_CAN_GET_IDX(CANmodule->CANptr);
+
+    CANmodule->busOffState = CO_CAN_BUSOFF_RECOVERING;
+    CO_LOG(CO_LOG_CAN_BUSOFF_RESTART, CANmodule->busOffCount,
+           CANmodule->busOffBackoff_ms);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_INITIALIZATION);
+    (void)MXC_CAN_SetMode(idx, MXC_CAN_MODE_NORMAL);
+}
+
+
+/* Bus-off event, called from CAN interrupt */
+static void can_busOffEvent(CO_CANmodule_t *CANmodule) {
+    uint32_t now = CO_timer_us();
+
+    CANmodule->CANerrorStatus |= CO_CAN_ERRTX_BUS_OFF;
+    if (CANmodule->busOffState != CO_CAN_BUSOFF_NONE) {
+        /* bus-off again during recovery */
+        CANmodule->busOffState = CO_CAN_BUSOFF_NONE;
+    }
+    else {
+        CANmodule->busOffTime_us = now;
+    }
+    CANmodule->busOffCount++;
+
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_FLUSH_TX
+    /* Drop queued messages. No lock here, CAN interrupt is not interrupted by
+     * CO_CANsend() callers. */
+    if (CANmodule->CANtxCount != 0U) {
+        for (uint16_t i = 0U; i < CANmodule->txSize; i++) {
+            CANmodule->txArray[i].bufferFull = false;
+        }
+        CANmodule->CANtxCount = 0U;
+        memset((void *)CANmodule->txSyncPending, 0,
+               sizeof(CANmodule->txSyncPending));
+    }
+    CANmodule->bufferInhibitFlag = false;
+#endif
+
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_BACKOFF
+    /* exponential back-off, if bus-off repeats shortly after recovery */
+    if ((now - CANmodule->busOffRecovered_us)
+        < (CO_CAN_BUSOFF_STABLE_MS * 1000UL)
+    ) {
+        CANmodule->busOffBackoff_ms = (CANmodule->busOffBackoff_ms == 0U)
+            ? CO_CAN_BUSOFF_BACKOFF_MIN_MS : CANmodule->busOffBackoff_ms * 2U;
+        if (CANmodule->busOffBackoff_ms > CO_CAN_BUSOFF_BACKOFF_MAX_MS) {
+            CANmodule->busOffBackoff_ms = CO_CAN_BUSOFF_BACKOFF_MAX_MS;
+        }
+    }
+    else {
+        CANmodule->busOffBackoff_ms = CO_CAN_BUSOFF_BACKOFF_MIN_MS;
+    }
+    CANmodule->busOffRetry_us = now + CANmodule->busOffBackoff_ms * 1000U;
+    CANmodule->busOffState = CO_CAN_BUSOFF_WAIT;
+#else
+    can_busOffRestart(CANmodule);
+#endif
+}
+
+
+/* Controller is error active after restart */
+static void can_busOffRecovered(CO_CANmodule_t *CANmodule) {
+    uint32_t now = CO_timer_us();
+    uint32_t duration = now - CANmodule->busOffTime_us;
+
+    CANmodule->busOffState = CO_CAN_BUSOFF_NONE;
+    CANmodule->busOffRecovered_us = now;
+    CANmodule->busOffRecoveryTime_us = duration;
+    if (duration > CANmodule->busOffRecoveryTimeMax_us) {
+        CANmodule->busOffRecoveryTimeMax_us = duration;
+    }
+    CANmodule->CANerrorStatus &= 0xFFFF ^ CO_CAN_ERRTX_BUS_OFF;
+    CO_LOG(CO_LOG_CAN_BUSOFF_RECOVERED, duration, 0);
+
+    /* send retained messages, the rest follows from TX interrupt */
+    if (CANmodule->CANtxCount > 0U) {
+        MXC_CAN_EnableInt(MXC_CAN_GET_IDX(CANmodule->CANptr),
+                          MXC_F_CAN_INTEN_TX, 0);
+        CO_CANTXinterrupt(CANmodule);
+    }
+}
+#endif /* (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE */
+
+
+/* Recalculate CANerrorStatus from error counters and status register. Called
+ * from CAN unit event and periodically from CO_CANmodule_process(). */
+static void can_errorStatusUpdate(CO_CANmodule_t *CANmodule) {
+    mxc_can_regs_t *can = (mxc_can_regs_t *)CANmodule->CANptr;
+    uint32_t err, stat;
     uint16_t rxErrors=0, txErrors=0, overflow=0;
+    bool_t busOff;
 
-    /* We may as well use event callbacks to obtain error status */
-    overflow = (MXC_CAN0->stat & MXC_F_CAN_STAT_DOR) ? 1 : 0;
-    txErrors = MXC_CAN0->txerr;
-    rxErrors = MXC_CAN0->rxerr;
-    err = ((uint32_t)txErrors << 16) | ((uint32_t)rxErrors << 8) | overflow;
+    stat = can->stat;
+    overflow = (stat & MXC_F_CAN_STAT_DOR) ? 1 : 0;
+    txErrors = can->txerr;
+    rxErrors = can->rxerr;
+    busOff = (stat & MXC_F_CAN_STAT_BUS_OFF) != 0
+             || txErrors >= CAN_ERR_THRESH_BUSOFF;
+    err = ((uint32_t)busOff << 24) | ((uint32_t)txErrors << 16)
+        | ((uint32_t)rxErrors << 8) | overflow;
 
     if (CANmodule->errOld != err) {
         uint16_t status = CANmodule->CANerrorStatus;
 
         CANmodule->errOld = err;
 
-        if (txErrors >= CAN_ERR_THRESH_BUSOFF) {
+        if (busOff) {
             /* bus off */
             status |= CO_CAN_ERRTX_BUS_OFF;
         }
@@ -434,7 +771,7 @@ void CO_CANmodule_process(CO_CANmodule_t *CANmodule) {
             /* tx bus warning or passive */
             if (txErrors >= CAN_ERR_THRESH_PASSIVE) {
                 status |= CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE;
-            } else if (rxErrors >= CAN_ERR_THRESH_WARNING) {
+            } else if (txErrors >= CAN_ERR_THRESH_WARNING) {
                 status |= CO_CAN_ERRTX_WARNING;
             }
 
@@ -449,19 +786,122 @@ void CO_CANmodule_process(CO_CANmodule_t *CANmodule) {
             status |= CO_CAN_ERRRX_OVERFLOW;
         }
 
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+        /* counters are reset by restart, bus-off lasts until recovered */
+        if (CANmodule->busOffState != CO_CAN_BUSOFF_NONE) {
+            status |= CO_CAN_ERRTX_BUS_OFF;
+        }
+#endif
+
         CANmodule->CANerrorStatus = status;
     }
 }
 
 
+/* CAN unit event (error state transition), called from CAN interrupt. */
+static void can_errorEvent(CO_CANmodule_t *CANmodule, uint32_t event) {
+    uint32_t now = CO_timer_us();
+
+    switch (event) {
+    case MXC_CAN_UNIT_EVT_ACTIVE:  CANmodule->errActiveTime_us = now; break;
+    case MXC_CAN_UNIT_EVT_WARNING: CANmodule->errWarningTime_us = now; break;
+    case MXC_CAN_UNIT_EVT_PASSIVE: CANmodule->errPassiveTime_us = now; break;
+    case MXC_CAN_UNIT_EVT_BUS_OFF: CANmodule->errBusOffTime_us = now; break;
+    default: break;
+    }
+    can_errorStatusUpdate(CANmodule);
+}
+
+
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+/******************************************************************************/
+void CO_CANmodule_initCallbackError(CO_CANmodule_t *CANmodule,
+                                    void *object,
+                                    void (*pFunctSignal)(void *object))
+{
+    if (CANmodule != NULL) {
+        CANmodule->functSignalErrorObject = object;
+        CANmodule->pFunctSignalError = pFunctSignal;
+    }
+}
+#endif
+
+
+/******************************************************************************/
+/* CANerrorStatus is updated from CAN unit events in canUnitEvent_cb(). Error
+ * counters are polled here only as slow consistency check, in case some
+ * transition was not signalled by an event. */
+void CO_CANmodule_process(CO_CANmodule_t *CANmodule) {
+    uint32_t now = CO_timer_us();
+
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+    /* restart after back-off, or recovery without ACTIVE event */
+    if (CANmodule->busOffState == CO_CAN_BUSOFF_WAIT) {
+        if ((int32_t)(now - CANmodule->busOffRetry_us) >= 0) {
+            can_busOffRestart(CANmodule);
+        }
+    }
+    else if (CANmodule->busOffState == CO_CAN_BUSOFF_RECOVERING) {
+        mxc_can_regs_t *can = (mxc_can_regs_t *)CANmodule->CANptr;
+        if ((can->stat & MXC_F_CAN_STAT_BUS_OFF) == 0
+            && can->txerr < CAN_ERR_THRESH_PASSIVE
+        ) {
+            can_busOffRecovered(CANmodule);
+        }
+    }
+#endif
+
+    if ((now - CANmodule->errPoll_us) >= (CO_CAN_ERR_POLL_MS * 1000UL)) {
+        CANmodule->errPoll_us = now;
+
+        /* CAN interrupt updates the same status */
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        can_errorStatusUpdate(CANmodule);
+        __set_PRIMASK(primask);
+    }
+}
+
+
 /******************************************************************************/
+CO_RAMFUNC
 void CO_CANTXinterrupt(CO_CANmodule_t *CANmodule){
     /* Clear interrupt flag */
 
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+    /* TIME frame is on the bus, stamp it first */
+    if (CANmodule->timeSync != NULL && CANmodule->timeSync->txInFlight) {
+        CO_TIMEsync_txComplete(CANmodule->timeSync);
+    }
+#endif
+
     /* First CAN message (bootup) was sent successfully */
     CANmodule->firstCANtxMessage = false;
     /* clear flag from previous message */
     CANmodule->bufferInhibitFlag = false;
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+    /* SYNC from timer goes before all queued messages */
+    if(CANmodule->syncTimer != NULL && CANmodule->syncTimer->pending){
+        if (can_MessageSend(CANmodule, &CANmodule->syncTimer->txBuff) < E_NO_ERROR) {
+            CO_LOG(CO_LOG_CAN_SEND_FAILED, CANmodule->syncTimer->txBuff.ident, 0);
+        }
+        CO_SYNCtimer_sent(CANmodule->syncTimer, true);
+        return;
+    }
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+    /* Forwarded frames take turns with queued messages */
+    if(CANmodule->bridge != NULL){
+        CO_CANtx_t *frame = CO_CANbridge_txNextCAN0(CANmodule->bridge,
+                                                    CANmodule->CANtxCount > 0U);
+        if(frame != NULL){
+            if (can_MessageSend(CANmodule, frame) < E_NO_ERROR) {
+                CO_LOG(CO_LOG_CAN_SEND_FAILED, frame->ident, 0);
+            }
+            return;
+        }
+    }
+#endif
     /* Are there any new messages waiting to be send */
     if(CANmodule->CANtxCount > 0U){
         uint16_t i;             /* index of transmitting message */
@@ -471,14 +911,17 @@ void CO_CANTXinterrupt(CO_CANmodule_t *CANmodule){
         for(i = CANmodule->txSize; i > 0U; i--){
             /* if message buffer is full, send it. */
             if(buffer->bufferFull){
+                uint16_t index = (uint16_t)(CANmodule->txSize - i);
+
                 buffer->bufferFull = false;
                 CANmodule->CANtxCount--;
+                CANmodule->txSyncPending[index >> 5] &= ~(1UL << (index & 31U));
 
                 /* Copy message to CAN buffer */
                 CANmodule->bufferInhibitFlag = buffer->syncFlag;
                 /* canSend... */
-                if (can_MessageSend(CANmodule->CANptr, buffer) < E_NO_ERROR) {
-                    PRINT("Error: can_MessageSend() failed\n");
+                if (can_MessageSend(CANmodule, buffer) < E_NO_ERROR) {
+                    CO_LOG(CO_LOG_CAN_SEND_FAILED, buffer->ident, 0);
                 }
                 break; /* exit for loop */
             }
@@ -493,18 +936,172 @@ void CO_CANTXinterrupt(CO_CANmodule_t *CANmodule){
     }
 }
 
+/* Pass message in the armed ring slot to processing. Next slot is handed to
+ * the controller, so this one stays intact until it is processed. */
+CO_RAMFUNC
+static void can_rxHandOff(CO_CANmodule_t *CANmodule, CO_CANrxMsg_t *rcvMsg)
+{
+    uint8_t next = (uint8_t)((rxRingIdx + 1U) % CO_CAN_RX_RING_SIZE);
+
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+    /* Only the slot is queued, CAN RX task processes the message in place
+     * and releases the slot with CO_CANrxRelease(). If all other slots are
+     * held by the task, this slot is reused for the next message. */
+    BaseType_t woken = pdFALSE;
+    if (next != rxRingTail
+        && xQueueSendFromISR(CANmodule->rxQueue, &rcvMsg, &woken) == pdTRUE
+    ) {
+        rxRingIdx = next;
+        can_rxSlotArm(&rxRing[next]);
+    }
+    else {
+        CANmodule->rxQueueOverflow++;
+        CANmodule->CANerrorStatus |= CO_CAN_ERRRX_OVERFLOW;
+    }
+    portYIELD_FROM_ISR(woken);
+#else
+    rxRingIdx = next;
+    can_rxSlotArm(&rxRing[next]);
+    CO_CANrxDispatch(CANmodule, rcvMsg);
+#endif
+}
+
+
+CO_RAMFUNC
 void CO_CANRXinterrupt(CO_CANmodule_t *CANmodule){
-    CO_CANrxMsg_t rcvMsg;      /* pointer to received message in CAN module */
+    CO_CANrxMsg_t *rcvMsg;      /* pointer to received message in ring slot */
+
+    /* Message was written by the CAN controller directly into the ring slot. */
+    rcvMsg = &rxRing[rxRingIdx];
+
+    /* Extended frame is not for CANopen. Slot is not advanced, next message
+     * is written into the same slot. */
+    if ((rcvMsg->info.msg_id & CO_CAN_EXT_ID_FLAG) != 0U) {
+#if (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE
+        if (CANmodule->extId != NULL) {
+            CO_CANextId_rx(CANmodule->extId, rcvMsg);
+            return;
+        }
+#endif
+        CANmodule->rxExtRejected++;
+        return;
+    }
+
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+    /* TIME frame is stamped here, CAN RX task would add latency */
+    if (CANmodule->timeSync != NULL && CANmodule->timeSync->isConsumer
+        && rcvMsg->info.msg_id == CANmodule->timeSync->ident
+        && rcvMsg->info.rtr == 0U && rcvMsg->info.dlc == 6U
+    ) {
+        CO_TIMEsync_rx(CANmodule->timeSync, rcvMsg->data);
+    }
+#endif
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+    if (CANmodule->stats != NULL) {
+        CO_CANstats_frame(CANmodule->stats, rcvMsg->info.msg_id,
+                          rcvMsg->info.dlc, false);
+    }
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    if (CANmodule->trace != NULL) {
+        CO_CANtrace_record(CANmodule->trace, rcvMsg->info.msg_id
+                           | (rcvMsg->info.rtr ? CO_CAN_TRACE_RTR : 0U),
+                           rcvMsg->info.dlc, rcvMsg->data, false);
+    }
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+    /* Frame is forwarded to CAN1 from here, the stack processes it too */
+    if (CANmodule->bridge != NULL) {
+        CO_CANbridge_rx(CANmodule->bridge, false, rcvMsg);
+    }
+#endif
+
+    can_rxHandOff(CANmodule, rcvMsg);
+}
+
+
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+/******************************************************************************/
+bool_t CO_CANrxInject(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *msg){
+    if (CANmodule->rxInjectPending) {
+        return false;
+    }
+    CANmodule->rxInjectMsg = *msg;
+    CANmodule->rxInjectPending = true;
+#if TARGET_NUM == 32662
+    NVIC_SetPendingIRQ(CAN_IRQn);
+#elif TARGET_NUM == 32690
+    NVIC_SetPendingIRQ(CAN0_IRQn);
+#endif
+    return true;
+}
+
+
+/******************************************************************************/
+CO_RAMFUNC
+void CO_CANrxInjectProcess(CO_CANmodule_t *CANmodule){
+    if (!CANmodule->rxInjectPending) {
+        return;
+    }
+    /* Controller writes the armed slot only from MXC_CAN_Handler(), which
+     * has returned, so the message is copied there. */
+    CO_CANrxMsg_t *rcvMsg = &rxRing[rxRingIdx];
+    rcvMsg->info = CANmodule->rxInjectMsg.info;
+    memcpy(rcvMsg->data, CANmodule->rxInjectMsg.data, sizeof(rcvMsg->data));
+    CANmodule->rxInjectPending = false;
+    can_rxHandOff(CANmodule, rcvMsg);
+}
+#endif
+
+
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+/******************************************************************************/
+CO_RAMFUNC
+void CO_CANrxRelease(CO_CANmodule_t *CANmodule){
+    (void)CANmodule;
+    /* Dispatch of the slot is finished before it is handed back */
+    __asm volatile("" ::: "memory");
+    rxRingTail = (uint8_t)((rxRingTail + 1U) % CO_CAN_RX_RING_SIZE);
+}
+#endif
+
+/******************************************************************************/
+CO_RAMFUNC
+void CO_CANrxDispatch(CO_CANmodule_t *CANmodule, CO_CANrxMsg_t *rcvMsg){
     uint16_t index;             /* index of received message */
     uint32_t rcvMsgIdent;       /* identifier of the received message */
     CO_CANrx_t *buffer = NULL;  /* receive message buffer from CO_CANmodule_t object. */
     bool_t msgMatched = false;
 
-    rcvMsg.ident = rxReq.msg_info->msg_id;
-    rcvMsg.DLC = rxReq.msg_info->dlc;
-    memcpy(rcvMsg.data, rxReq.data, rcvMsg.DLC);
+    rcvMsgIdent = rcvMsg->info.msg_id;
+
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+    /* Controller is in loopback, only own frames are received */
+    CO_CANselfTest_t *selfTest = CANmodule->selfTest;
+    if (selfTest != NULL) {
+        if (rcvMsgIdent == selfTest->ident) {
+            CO_CANselfTest_rx(selfTest, rcvMsg);
+        }
+        return;
+    }
+#endif
 
-    rcvMsgIdent = rcvMsg.ident;
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+    /* Heartbeats of all nodes share one slot, node is indexed by node-ID */
+    if (CANmodule->hbMonitor != NULL
+        && (rcvMsgIdent & ~0x7FUL) == CO_CAN_ID_HEARTBEAT
+        && (rcvMsgIdent & 0x7FUL) != 0U
+        && rcvMsg->info.rtr == 0U && rcvMsg->info.dlc == 1U
+    ) {
+        CO_HBmonitor_frame(CANmodule->hbMonitor, (uint8_t)(rcvMsgIdent & 0x7FU),
+                           rcvMsg->data[0]);
+        /* rxArray is searched only for heartbeat consumers of the stack */
+        if (!CANmodule->hbConsumerRx) {
+            return;
+        }
+    }
+#endif
     if(CANmodule->useCANrxFilters){
         /* CAN module filters are used. Message with known 11-bit identifier has */
         /* been received */
@@ -532,37 +1129,78 @@ void CO_CANRXinterrupt(CO_CANmodule_t *CANmodule){
 
     /* Call specific function, which will process the message */
     if(msgMatched && (buffer != NULL) && (buffer->CANrx_callback != NULL)){
-        buffer->CANrx_callback(buffer->object, (void*) &rcvMsg);
+        buffer->CANrx_callback(buffer->object, (void*) rcvMsg);
     }
 }
 
 ///< Callback used when a bus event occurs
 void canUnitEvent_cb(uint32_t can_idx, uint32_t event)
 {
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    /* error state changes at wrong bitrate are not reported to the stack */
+    if (CANthis->autoBitrate != NULL) {
+        if (event != MXC_CAN_UNIT_EVT_ACTIVE
+            && event != MXC_CAN_UNIT_EVT_INACTIVE) {
+            CO_autoBitrate_error(CANthis->autoBitrate);
+        }
+        return;
+    }
+#endif
+    /* error status is updated immediately, for all error state events */
+    can_errorEvent(CANthis, event);
+
     switch (event) {
     case MXC_CAN_UNIT_EVT_INACTIVE:
-        PRINT("Peripherals entered inactive state\n");
+        CO_LOG(CO_LOG_CAN_UNIT_INACTIVE, 0, 0);
         break;
     case MXC_CAN_UNIT_EVT_ACTIVE:
-        PRINT("Peripherals entered active state\n");
+        CO_LOG(CO_LOG_CAN_UNIT_ACTIVE, 0, 0);
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+        if (CANthis->busOffState == CO_CAN_BUSOFF_RECOVERING) {
+            can_busOffRecovered(CANthis);
+        }
+#endif
         break;
     case MXC_CAN_UNIT_EVT_WARNING:
-        PRINT("Peripheral received error warning\n");
+        CO_LOG(CO_LOG_CAN_UNIT_WARNING, 0, 0);
         break;
     case MXC_CAN_UNIT_EVT_PASSIVE:
-        PRINT("Peripheral entered passive state\n");
+        CO_LOG(CO_LOG_CAN_UNIT_PASSIVE, 0, 0);
         break;
     case MXC_CAN_UNIT_EVT_BUS_OFF:
-        PRINT("Bus turned off\n");
+        CO_LOG(CO_LOG_CAN_UNIT_BUS_OFF, 0, 0);
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+        can_busOffEvent(CANthis);
+#endif
         break;
     default:
-        PRINT("Undefined event\n");
+        CO_LOG(CO_LOG_CAN_UNIT_UNDEFINED, event, 0);
+    }
+
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+    /* EMCY and bus-off recovery are handled from CO_process() */
+    if (CANthis->pFunctSignalError != NULL) {
+        CANthis->pFunctSignalError(CANthis->functSignalErrorObject);
     }
+#endif
 }
 
 ///< Callback used when a transmission event occurs
+CO_RAMFUNC
 void canObjEvent_cb(uint32_t can_idx, uint32_t event)
 {
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    /* frame stays in the receive slot, it is not processed */
+    if (CANthis->autoBitrate != NULL) {
+        if (event == MXC_CAN_OBJ_EVT_RX) {
+            CO_autoBitrate_frame(CANthis->autoBitrate);
+        }
+        return;
+    }
+#endif
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_CYCLES
+    uint32_t start = CAN_CYCLES();
+#endif
     switch (event) {
     case MXC_CAN_OBJ_EVT_TX_COMPLETE:
         CO_CANTXinterrupt(CANthis);
@@ -571,10 +1209,21 @@ void canObjEvent_cb(uint32_t can_idx, uint32_t event)
         CO_CANRXinterrupt(CANthis);
         break;
     case MXC_CAN_OBJ_EVT_RX_OVERRUN:
+        CANthis->CANerrorStatus |= CO_CAN_ERRRX_OVERFLOW;
         break;
     default:
-        PRINT("Undefined event\n");
+        CO_LOG(CO_LOG_CAN_OBJ_UNDEFINED, event, 0);
     }
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_CYCLES
+    uint32_t cycles = CAN_CYCLES() - start;
+    if (event == MXC_CAN_OBJ_EVT_RX && cycles > CANthis->rxCyclesMax) {
+        CANthis->rxCyclesMax = cycles;
+    }
+    else if (event == MXC_CAN_OBJ_EVT_TX_COMPLETE
+             && cycles > CANthis->txCyclesMax) {
+        CANthis->txCyclesMax = cycles;
+    }
+#endif
 }
 
 void CO_CANModule_Lock(uint32_t *lock)
@@ -34,6 +34,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "can.h"
+
 #ifdef CO_DRIVER_CUSTOM
 #include "CO_driver_custom.h"
 #endif
@@ -43,8 +45,12 @@
 
 #ifndef CO_CONFIG_SDO_SRV
 #define CO_CONFIG_SDO_SRV (CO_CONFIG_SDO_SRV_SEGMENTED | \
-                           CO_CONFIG_SDO_SRV_BLOCK)
+                           CO_CONFIG_SDO_SRV_BLOCK | \
+                           CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                           CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
 #endif
+/* Holds one complete SDO block (127 segments * 7 bytes = 889 bytes), so block
+ * download runs at the full rate. Larger buffer does not speed it up. */
 #ifndef CO_CONFIG_SDO_SRV_BUFFER_SIZE
 #define CO_CONFIG_SDO_SRV_BUFFER_SIZE 900
 #endif
@@ -52,6 +58,318 @@
 #define CO_CONFIG_CRC16 (CO_CONFIG_CRC16_ENABLE)
 #endif
 
+/* MAX32xxx port specific configuration */
+
+/* FreeRTOS threading model, see CO_main_max32xxx_freertos.c. Requires
+ * LIB_FREERTOS=1 in project.mk. Mainline task sleeps until timerNext_us and is
+ * woken from CANopen callbacks, so stack objects use both global flags. */
+#define CO_CONFIG_FREERTOS_ENABLE 0x01
+#ifndef CO_CONFIG_FREERTOS
+#define CO_CONFIG_FREERTOS 0
+#endif
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#ifndef CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE CO_CONFIG_FLAG_CALLBACK_PRE
+#endif
+#ifndef CO_CONFIG_GLOBAL_FLAG_TIMERNEXT
+#define CO_CONFIG_GLOBAL_FLAG_TIMERNEXT CO_CONFIG_FLAG_TIMERNEXT
+#endif
+/* Length of the queue from CAN interrupt to CAN RX task */
+#ifndef CO_CAN_RX_QUEUE_SIZE
+#define CO_CAN_RX_QUEUE_SIZE 16
+#endif
+/* Receive slots stay in use until CAN RX task has processed them, so ring
+ * needs one more slot than the queue, see CO_CANRXinterrupt(). */
+#ifndef CO_CAN_RX_RING_SIZE
+#define CO_CAN_RX_RING_SIZE (CO_CAN_RX_QUEUE_SIZE + 1)
+#endif
+#endif
+
+/* CANerrorStatus is updated from CAN unit events, error counters are polled
+ * additionally with this period as consistency check. */
+#ifndef CO_CAN_ERR_POLL_MS
+#define CO_CAN_ERR_POLL_MS 100
+#endif
+
+/* CAN bus load and traffic statistics, see CO_CANstats.h */
+#define CO_CONFIG_CAN_STATS_ENABLE 0x01
+#ifndef CO_CONFIG_CAN_STATS
+#define CO_CONFIG_CAN_STATS 0
+#endif
+
+/* CAN trace recorder, see CO_CANtrace.h */
+#define CO_CONFIG_CAN_TRACE_ENABLE 0x01
+#ifndef CO_CONFIG_CAN_TRACE
+#define CO_CONFIG_CAN_TRACE 0
+#endif
+
+/* Heartbeat monitor for all nodes, see CO_HBmonitor.h. Heartbeats are passed
+ * from CAN driver by node-ID, without rxArray search. With
+ * CO_CONFIG_HB_MON_CYCLES CPU cycles are measured with DWT (Cortex-M only). */
+#define CO_CONFIG_HB_MON_ENABLE 0x01
+#define CO_CONFIG_HB_MON_CYCLES 0x02
+#ifndef CO_CONFIG_HB_MON
+#define CO_CONFIG_HB_MON 0
+#endif
+
+/* Bus-off recovery manager in CO_driver_max32xxx.c. Controller is restarted
+ * on bus-off event. With CO_CONFIG_CAN_BUSOFF_BACKOFF restart is delayed, the
+ * delay doubles (up to CO_CAN_BUSOFF_BACKOFF_MAX_MS) if bus-off repeats within
+ * CO_CAN_BUSOFF_STABLE_MS after recovery. With CO_CONFIG_CAN_BUSOFF_FLUSH_TX
+ * queued messages are dropped on bus-off, otherwise they are sent after
+ * recovery. */
+#define CO_CONFIG_CAN_BUSOFF_ENABLE 0x01
+#define CO_CONFIG_CAN_BUSOFF_BACKOFF 0x02
+#define CO_CONFIG_CAN_BUSOFF_FLUSH_TX 0x04
+#ifndef CO_CONFIG_CAN_BUSOFF
+#define CO_CONFIG_CAN_BUSOFF 0
+#endif
+#ifndef CO_CAN_BUSOFF_BACKOFF_MIN_MS
+#define CO_CAN_BUSOFF_BACKOFF_MIN_MS 10
+#endif
+#ifndef CO_CAN_BUSOFF_BACKOFF_MAX_MS
+#define CO_CAN_BUSOFF_BACKOFF_MAX_MS 1000
+#endif
+#ifndef CO_CAN_BUSOFF_STABLE_MS
+#define CO_CAN_BUSOFF_STABLE_MS 5000
+#endif
+
+/* Split-core operation with lock-free mailbox, see CO_mailbox.h. Set
+ * CO_CONFIG_MAILBOX_STACK on the core, which runs CANopen stack (main file
+ * then processes the mailbox in RT thread), only CO_CONFIG_MAILBOX_ENABLE on
+ * the application core. */
+#define CO_CONFIG_MAILBOX_ENABLE 0x01
+#define CO_CONFIG_MAILBOX_STACK 0x02
+#ifndef CO_CONFIG_MAILBOX
+#define CO_CONFIG_MAILBOX 0
+#endif
+
+/* CANopen ASCII gateway (CiA 309-3) on UART with DMA, see CO_gatewayUART.h.
+ * Enables gateway with SDO client, NMT and LSS commands in the stack, together
+ * with NMT master and LSS master, which these commands use. */
+#define CO_CONFIG_GTW_UART_ENABLE 0x01
+#ifndef CO_CONFIG_GTW_UART
+#define CO_CONFIG_GTW_UART 0
+#endif
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+#ifndef CO_CONFIG_GTW
+#define CO_CONFIG_GTW (CO_CONFIG_GTW_ASCII | \
+                       CO_CONFIG_GTW_ASCII_SDO | \
+                       CO_CONFIG_GTW_ASCII_NMT | \
+                       CO_CONFIG_GTW_ASCII_LSS | \
+                       CO_CONFIG_GTW_ASCII_ERROR_DESC | \
+                       CO_CONFIG_GTW_ASCII_PRINT_HELP)
+#endif
+#ifndef CO_CONFIG_FIFO
+#define CO_CONFIG_FIFO (CO_CONFIG_FIFO_ENABLE | \
+                        CO_CONFIG_FIFO_ALT_READ | \
+                        CO_CONFIG_FIFO_CRC16_CCITT | \
+                        CO_CONFIG_FIFO_ASCII_COMMANDS | \
+                        CO_CONFIG_FIFO_ASCII_DATATYPES)
+#endif
+#ifndef CO_CONFIG_SDO_CLI
+#define CO_CONFIG_SDO_CLI (CO_CONFIG_SDO_CLI_ENABLE | \
+                           CO_CONFIG_SDO_CLI_SEGMENTED | \
+                           CO_CONFIG_SDO_CLI_BLOCK | \
+                           CO_CONFIG_SDO_CLI_LOCAL | \
+                           CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                           CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
+#endif
+#ifndef CO_CONFIG_LSS
+#define CO_CONFIG_LSS (CO_CONFIG_LSS_SLAVE | \
+                       CO_CONFIG_LSS_MASTER | \
+                       CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE)
+#endif
+#ifndef CO_CONFIG_NMT
+#define CO_CONFIG_NMT (CO_CONFIG_NMT_MASTER | \
+                       CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                       CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
+#endif
+#ifndef CO_CONFIG_GTWA_COMM_BUF_SIZE
+#define CO_CONFIG_GTWA_COMM_BUF_SIZE 2000
+#endif
+#endif
+
+/* CiA 302 program download into the second flash bank, see
+ * CO_progDownload.h. Object Dictionary must contain 0x1F50 and 0x1F51,
+ * optionally 0x1F56 and 0x1F57. */
+#define CO_CONFIG_PROG_DOWNLOAD_ENABLE 0x01
+#ifndef CO_CONFIG_PROG_DOWNLOAD
+#define CO_CONFIG_PROG_DOWNLOAD 0
+#endif
+
+/* Configuration manager (CiA 302-3) downloads concise DCF to slaves, see
+ * CO_configManager.h. Each SDO client in Object Dictionary (0x1280, 0x1281,
+ * ...) configures one slave in parallel. With CO_CONFIG_GTW_UART the first
+ * SDO client is left to the gateway. */
+#define CO_CONFIG_CFG_MGR_ENABLE 0x01
+#ifndef CO_CONFIG_CFG_MGR
+#define CO_CONFIG_CFG_MGR 0
+#endif
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+#ifndef CO_CONFIG_FIFO
+#define CO_CONFIG_FIFO (CO_CONFIG_FIFO_ENABLE | \
+                        CO_CONFIG_FIFO_ALT_READ | \
+                        CO_CONFIG_FIFO_CRC16_CCITT)
+#endif
+#ifndef CO_CONFIG_SDO_CLI
+#define CO_CONFIG_SDO_CLI (CO_CONFIG_SDO_CLI_ENABLE | \
+                           CO_CONFIG_SDO_CLI_SEGMENTED | \
+                           CO_CONFIG_SDO_CLI_BLOCK | \
+                           CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                           CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
+#endif
+/* One complete SDO block per client */
+#ifndef CO_CONFIG_SDO_CLI_BUFFER_SIZE
+#define CO_CONFIG_SDO_CLI_BUFFER_SIZE 1000
+#endif
+#endif
+
+/* LSS master batch auto-addressing of unconfigured slaves with Fastscan, see
+ * CO_LSSauto.h. Enables LSS master and NMT master in the stack. */
+#define CO_CONFIG_LSS_AUTO_ENABLE 0x01
+#ifndef CO_CONFIG_LSS_AUTO
+#define CO_CONFIG_LSS_AUTO 0
+#endif
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+#ifndef CO_CONFIG_LSS
+#define CO_CONFIG_LSS (CO_CONFIG_LSS_SLAVE | \
+                       CO_CONFIG_LSS_SLAVE_FASTSCAN_DIRECT_RESPOND | \
+                       CO_CONFIG_LSS_MASTER | \
+                       CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE)
+#endif
+#ifndef CO_CONFIG_NMT
+#define CO_CONFIG_NMT (CO_CONFIG_NMT_MASTER | \
+                       CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                       CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
+#endif
+#endif
+
+/* SYNC producer driven by hardware timer, see CO_SYNCtimer.h. SYNC is sent
+ * from the timer interrupt, before all queued frames. */
+#define CO_CONFIG_SYNC_TMR_ENABLE 0x01
+#ifndef CO_CONFIG_SYNC_TMR
+#define CO_CONFIG_SYNC_TMR 0
+#endif
+
+/* Local clock synchronized to TIME producer, see CO_TIMEsync.h. CAN driver
+ * stamps TIME frames. Enables TIME producer in the stack. */
+#define CO_CONFIG_TIME_SYNC_ENABLE 0x01
+#ifndef CO_CONFIG_TIME_SYNC
+#define CO_CONFIG_TIME_SYNC 0
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+#ifndef CO_CONFIG_TIME
+#define CO_CONFIG_TIME (CO_CONFIG_TIME_ENABLE | \
+                        CO_CONFIG_TIME_PRODUCER | \
+                        CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | \
+                        CO_CONFIG_GLOBAL_FLAG_OD_DYNAMIC)
+#endif
+#endif
+
+/* Triple buffered process image of PDO mapped objects, see CO_procImage.h.
+ * Main file exchanges it in RT thread, between RPDO and TPDO processing. */
+#define CO_CONFIG_PROC_IMAGE_ENABLE 0x01
+#ifndef CO_CONFIG_PROC_IMAGE
+#define CO_CONFIG_PROC_IMAGE 0
+#endif
+
+/* Typed lock-free access to OD variables from mainline, see CO_ODaccess.h.
+ * Main file increments sequence counter around the locked RT section. */
+#define CO_CONFIG_OD_ACCESS_ENABLE 0x01
+#ifndef CO_CONFIG_OD_ACCESS
+#define CO_CONFIG_OD_ACCESS 0
+#endif
+
+/* Change of state detection for event driven TPDOs, see CO_TPDOcos.h. Main
+ * file checks mapped data in RT thread before TPDO processing. */
+#define CO_CONFIG_TPDO_COS_ENABLE 0x01
+#ifndef CO_CONFIG_TPDO_COS
+#define CO_CONFIG_TPDO_COS 0
+#endif
+
+/* Timer wheel for mainline services of bare-metal main file, see
+ * CO_timerWheel.h. CO_process() is called only at its timerNext_us or when
+ * woken from CANopen callbacks, so stack objects use both global flags. */
+#define CO_CONFIG_TIMER_WHEEL_ENABLE 0x01
+#ifndef CO_CONFIG_TIMER_WHEEL
+#define CO_CONFIG_TIMER_WHEEL 0
+#endif
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+#ifndef CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE CO_CONFIG_FLAG_CALLBACK_PRE
+#endif
+#ifndef CO_CONFIG_GLOBAL_FLAG_TIMERNEXT
+#define CO_CONFIG_GLOBAL_FLAG_TIMERNEXT CO_CONFIG_FLAG_TIMERNEXT
+#endif
+#endif
+
+/* Bitrate detection in listen-only mode at boot, if no bitrate is stored, see
+ * CO_autoBitrate.h */
+#define CO_CONFIG_AUTO_BITRATE_ENABLE 0x01
+#ifndef CO_CONFIG_AUTO_BITRATE
+#define CO_CONFIG_AUTO_BITRATE 0
+#endif
+
+/* CAN loopback self-test, started from OD, see CO_CANselfTest.h */
+#define CO_CONFIG_CAN_SELFTEST_ENABLE 0x01
+#ifndef CO_CONFIG_CAN_SELFTEST
+#define CO_CONFIG_CAN_SELFTEST 0
+#endif
+
+/* Forwarding of frames between CAN0 and CAN1 on MAX32690, routes from OD, see
+ * CO_CANbridge.h */
+#define CO_CONFIG_CAN_BRIDGE_ENABLE 0x01
+#ifndef CO_CONFIG_CAN_BRIDGE
+#define CO_CONFIG_CAN_BRIDGE 0
+#endif
+
+/* Extended 29-bit frames passed to application callbacks, instead of being
+ * rejected, see CO_CANextId.h */
+#define CO_CONFIG_CAN_EXT_ID_ENABLE 0x01
+#ifndef CO_CONFIG_CAN_EXT_ID
+#define CO_CONFIG_CAN_EXT_ID 0
+#endif
+
+/* CAN interrupt, CO_CANsend() and RT tick executed from SRAM, see CO_RAMFUNC.
+ * With CO_CONFIG_RAM_FUNC_CYCLES worst-case CPU cycles of the CAN interrupt
+ * are measured with DWT (Cortex-M only), also without
+ * CO_CONFIG_RAM_FUNC_ENABLE, for comparison. */
+#define CO_CONFIG_RAM_FUNC_ENABLE 0x01
+#define CO_CONFIG_RAM_FUNC_CYCLES 0x02
+#ifndef CO_CONFIG_RAM_FUNC
+#define CO_CONFIG_RAM_FUNC 0
+#endif
+
+/* Hot path function or lookup table in SRAM. Input section names match
+ * *(.data*) of the MSDK linker files, so startup code copies them from flash
+ * together with initialized data. They do not start with ".data.", which GAS
+ * knows as a data section and warns about incorrect attributes for code.
+ * Calls between flash and SRAM go through linker veneers. */
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_ENABLE
+#define CO_RAMFUNC  __attribute__((section(".data_co_ramfunc")))
+#define CO_RAMCONST __attribute__((section(".data_co_ramconst")))
+#else
+#define CO_RAMFUNC
+#define CO_RAMCONST
+#endif
+
+/* Deferred log for messages from driver and interrupts, see CO_log.h. Enabled
+ * with DEBUG_MODE, CO_CONFIG_LOG_BINARY writes binary records to the UART. */
+#define CO_CONFIG_LOG_ENABLE 0x01
+#define CO_CONFIG_LOG_BINARY 0x02
+#ifndef CO_CONFIG_LOG
+#ifdef DEBUG_MODE
+#define CO_CONFIG_LOG CO_CONFIG_LOG_ENABLE
+#else
+#define CO_CONFIG_LOG 0
+#endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -72,15 +390,35 @@ typedef uint_fast8_t            bool_t;
 typedef float                   float32_t;
 typedef double                  float64_t;
 
+/* Number of receive slots, the CAN controller writes received messages
+ * directly into them, see CO_CANRXinterrupt(). */
+#ifndef CO_CAN_RX_RING_SIZE
+#define CO_CAN_RX_RING_SIZE 4
+#endif
+/* Size of data field in the receive slot, 64 bytes covers CAN FD frames. */
+#ifndef CO_CAN_RX_DATA_SIZE
+#define CO_CAN_RX_DATA_SIZE 64
+#endif
+/* Size of bitmap of queued synchronous messages in 32-bit words, it covers
+ * this number of TX buffers times 32, see CO_CANclearPendingSyncPDOs(). */
+#ifndef CO_CAN_TX_SYNC_WORDS
+#define CO_CAN_TX_SYNC_WORDS 8
+#endif
+
+/* Received message, laid out as MSDK CAN read request (message info + data),
+ * so it is filled by the CAN controller without additional copy. */
 typedef struct {
-    uint32_t ident;
-    uint8_t DLC;
-    uint8_t data[8];
+    mxc_can_msg_info_t info;
+    uint8_t data[CO_CAN_RX_DATA_SIZE];
 } CO_CANrxMsg_t;
 
+/* Extended identifier flag in msg_id of received message, see
+ * MXC_CAN_EXTENDED_ID() */
+#define CO_CAN_EXT_ID_FLAG 0x80000000UL
+
 /* Access to received CAN message */
-#define CO_CANrxMsg_readIdent(msg) ((uint16_t)(((CO_CANrxMsg_t*)(msg)))->ident)
-#define CO_CANrxMsg_readDLC(msg)   ((uint8_t)(((CO_CANrxMsg_t*)(msg)))->DLC)
+#define CO_CANrxMsg_readIdent(msg) ((uint16_t)(((CO_CANrxMsg_t*)(msg)))->info.msg_id)
+#define CO_CANrxMsg_readDLC(msg)   ((uint8_t)(((CO_CANrxMsg_t*)(msg)))->info.dlc)
 #define CO_CANrxMsg_readData(msg)  ((uint8_t*)(((CO_CANrxMsg_t*)(msg)))->data)
 
 /* Received message object */
@@ -108,18 +446,218 @@ typedef struct {
     CO_CANtx_t *txArray;
     uint16_t txSize;
     uint16_t CANerrorStatus;
+    /* Received extended frames, rejected at the start of RX interrupt */
+    uint32_t rxExtRejected;
     volatile bool_t CANnormal;
     volatile bool_t useCANrxFilters;
     volatile bool_t bufferInhibitFlag;
     volatile bool_t firstCANtxMessage;
     volatile uint16_t CANtxCount;
+    /* Queued TX buffers with syncFlag, bit per index in txArray */
+    volatile uint32_t txSyncPending[CO_CAN_TX_SYNC_WORDS];
+    /* Synchronous messages aborted in the CAN controller and dropped from
+     * TX buffers, outside of the synchronous window */
+    uint32_t txSyncAborted;
+    uint32_t txSyncDropped;
+#if (CO_CONFIG_RAM_FUNC) & CO_CONFIG_RAM_FUNC_CYCLES
+    /* CPU cycles of the longest CAN RX and TX interrupt, from canObjEvent_cb() */
+    uint32_t rxCyclesMax;
+    uint32_t txCyclesMax;
+#endif
     uint32_t errOld;
+    uint32_t errPoll_us;
+    /* Time of last CAN unit event (error state transition), see CO_timer_us() */
+    uint32_t errActiveTime_us;
+    uint32_t errWarningTime_us;
+    uint32_t errPassiveTime_us;
+    uint32_t errBusOffTime_us;
     uint32_t txLock;
     uint32_t emcyLock;
     uint32_t odLock;
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+    /* Bus-off recovery, see CO_CAN_BUSOFF_NONE */
+    volatile uint8_t busOffState;
+    uint32_t busOffCount;
+    uint32_t busOffTime_us;
+    uint32_t busOffRetry_us;
+    uint32_t busOffRecovered_us;
+    uint32_t busOffBackoff_ms;
+    /* Duration from bus-off event to recovery, last and maximum */
+    uint32_t busOffRecoveryTime_us;
+    uint32_t busOffRecoveryTimeMax_us;
+#endif
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+    /* Receive slots, passed from CAN interrupt to CAN RX task. Created in
+     * CO_CANmodule_init(), all messages go through it. */
+    QueueHandle_t rxQueue;
+    uint32_t rxQueueOverflow;
+    SemaphoreHandle_t odMutex;
+#endif
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+    struct CO_CANstats *stats;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    struct CO_CANtrace *trace;
+    /* Replayed message, passed to the RX path from CAN interrupt */
+    CO_CANrxMsg_t rxInjectMsg;
+    volatile bool_t rxInjectPending;
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+    struct CO_HBmonitor *hbMonitor;
+    /* Set, if a heartbeat consumer of the stack (0x1016) uses rxArray */
+    bool_t hbConsumerRx;
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+    struct CO_SYNCtimer *syncTimer;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+    /* If set, received frames are passed only to the running self-test */
+    struct CO_CANselfTest *selfTest;
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+    /* If set, received frames are also matched against bridge routes */
+    struct CO_CANbridge *bridge;
+#endif
+#if (CO_CONFIG_CAN_EXT_ID) & CO_CONFIG_CAN_EXT_ID_ENABLE
+    /* If set, received extended frames are passed to it */
+    struct CO_CANextId *extId;
+#endif
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    /* If set, received frames and errors are only reported to it */
+    struct CO_autoBitrate *autoBitrate;
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+    struct CO_TIMEsync *timeSync;
+#endif
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+    /* Called from CAN interrupt after error state transition, may be NULL */
+    void (*pFunctSignalError)(void *object);
+    void *functSignalErrorObject;
+#endif
 } CO_CANmodule_t;
 
 
+/* Bus-off recovery states, CO_CANmodule_t.busOffState */
+#define CO_CAN_BUSOFF_NONE        0U  /* bus on */
+#define CO_CAN_BUSOFF_WAIT        1U  /* waiting for back-off before restart */
+#define CO_CAN_BUSOFF_RECOVERING  2U  /* restarted, waiting for error active */
+
+/**
+ * Process received message: search rxArray for matching CAN-ID and call its
+ * callback. Called from CO_CANRXinterrupt() for each message in receive slot
+ * or, with CO_CONFIG_FREERTOS, from CAN RX task for each message in rxQueue.
+ *
+ * @param CANmodule CAN module object.
+ * @param rcvMsg Received message.
+ */
+void CO_CANrxDispatch(CO_CANmodule_t *CANmodule, CO_CANrxMsg_t *rcvMsg);
+
+#if ((CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE) || defined CO_DOXYGEN
+/**
+ * Pass message into the receive path, as if it was received from CAN. It is
+ * copied and the CAN interrupt is pended, which then processes it like a
+ * received message: dispatched there or queued to CAN RX task with FreeRTOS.
+ * Used for replay of CAN trace.
+ *
+ * @param CANmodule CAN module object.
+ * @param msg Message.
+ *
+ * @return False, if previous message is not processed yet.
+ */
+bool_t CO_CANrxInject(CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *msg);
+
+
+/**
+ * Process message from CO_CANrxInject(), called from CAN interrupt handler
+ * after MXC_CAN_Handler().
+ *
+ * @param CANmodule CAN module object.
+ */
+void CO_CANrxInjectProcess(CO_CANmodule_t *CANmodule);
+#endif
+
+#if ((CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE) || defined CO_DOXYGEN
+/**
+ * Release the oldest receive slot, called from CAN RX task after
+ * CO_CANrxDispatch() of the slot from rxQueue. Slots are queued in ring
+ * order.
+ *
+ * @param CANmodule CAN module object.
+ */
+void CO_CANrxRelease(CO_CANmodule_t *CANmodule);
+#endif
+
+
+#if ((CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE) \
+    || ((CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE) || defined CO_DOXYGEN
+/**
+ * Send message from interrupt with the same priority as CAN interrupt. Message
+ * is written into the CAN TX buffer only if it is free and no messages are
+ * queued. Without FreeRTOS, txLock is only tried, as the interrupted code may
+ * hold it. Message is not queued.
+ *
+ * @param CANmodule CAN module object.
+ * @param buffer Message to send.
+ *
+ * @return True if message was written into the CAN TX buffer.
+ */
+bool_t CO_CANsendFromISR(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer);
+#endif
+
+
+#if ((CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE) || defined CO_DOXYGEN
+/**
+ * Detect bitrate of the running bus with the CAN controller in listen-only
+ * mode, see CO_autoBitrate.h. Called after CO_CANinit() with CAN interrupt
+ * enabled, blocks until detected or timeout. Controller is left in
+ * configuration mode, CAN module must be initialized again.
+ *
+ * @param CANmodule CAN module object.
+ *
+ * @return Detected bitrate in kbit/s or 0.
+ */
+uint16_t CO_CANdetectBitRate(CO_CANmodule_t *CANmodule);
+#endif
+
+
+#if ((CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE) || defined CO_DOXYGEN
+/**
+ * Initialize callback, called from CAN interrupt after each error state
+ * transition (also bus-off), so mainline runs CO_process() without waiting
+ * for its timer. Called after CO_CANinit().
+ *
+ * @param CANmodule CAN module object.
+ * @param object Pointer passed to callback.
+ * @param pFunctSignal Callback, may be NULL.
+ */
+void CO_CANmodule_initCallbackError(CO_CANmodule_t *CANmodule,
+                                    void *object,
+                                    void (*pFunctSignal)(void *object));
+#endif
+
+
+/**
+ * Set nominal bitrate from the driver bitrate table. CAN controller must be in
+ * configuration mode. Used also for the second CAN controller.
+ *
+ * @param CANptr CAN controller, MXC_CAN0 or MXC_CAN1.
+ * @param CANbitRate Bitrate in kbit/s.
+ *
+ * @return True if bitrate is in the table and was set.
+ */
+bool_t CO_CANsetBitRate(void *CANptr, uint16_t CANbitRate);
+
+
+/**
+ * Free running microsecond time base, derived from SysTick. Implemented in
+ * CO_main_max32xxx.c or CO_main_max32xxx_freertos.c, may be called from
+ * interrupts.
+ *
+ * @return Time in microseconds.
+ */
+uint32_t CO_timer_us(void);
+
+
 /* Data storage object for one entry */
 typedef struct {
     void *addr;
@@ -147,6 +685,28 @@ void CO_CANModule_Lock(uint32_t *lock);
  */
 void CO_CANModule_Unlock(uint32_t *lock);
 
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+/* CO_CANsend() and emergency are short sections, shared with CAN interrupt.
+ * CAN interrupt priority must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY.
+ * Object Dictionary is locked by RT task for the whole PDO processing, so a
+ * mutex is used, which does not block higher priority tasks and interrupts. */
+#define CO_LOCK_CAN_SEND(CAN_MODULE)    taskENTER_CRITICAL()
+#define CO_UNLOCK_CAN_SEND(CAN_MODULE)  taskEXIT_CRITICAL()
+
+#define CO_LOCK_EMCY(CAN_MODULE)    taskENTER_CRITICAL()
+#define CO_UNLOCK_EMCY(CAN_MODULE)  taskEXIT_CRITICAL()
+
+#define CO_LOCK_OD(CAN_MODULE)      xSemaphoreTake(((CO_CANmodule_t *) CAN_MODULE)->odMutex, portMAX_DELAY)
+#define CO_UNLOCK_OD(CAN_MODULE)    xSemaphoreGive(((CO_CANmodule_t *) CAN_MODULE)->odMutex)
+
+/* Received messages are processed in CAN RX task, flags are read by other
+ * tasks. */
+#define CO_MemoryBarrier() __asm volatile("dmb" ::: "memory")
+#define CO_FLAG_READ(rxNew) ((rxNew) != NULL)
+#define CO_FLAG_SET(rxNew) {CO_MemoryBarrier(); rxNew = (void*)1L;}
+#define CO_FLAG_CLEAR(rxNew) {CO_MemoryBarrier(); rxNew = NULL;}
+
+#else
 /* (un)lock critical section in CO_CANsend() */
 #define CO_LOCK_CAN_SEND(CAN_MODULE)    CO_CANModule_Lock(&((CO_CANmodule_t *) CAN_MODULE)->txLock)
 #define CO_UNLOCK_CAN_SEND(CAN_MODULE)  CO_CANModule_Unlock(&((CO_CANmodule_t *) CAN_MODULE)->txLock)
@@ -164,6 +724,7 @@ void CO_CANModule_Unlock(uint32_t *lock);
 #define CO_FLAG_READ(rxNew) ((rxNew) != NULL)
 #define CO_FLAG_SET(rxNew) {CO_MemoryBarrier(); rxNew = (void*)1L;}
 #define CO_FLAG_CLEAR(rxNew) {CO_MemoryBarrier(); rxNew = NULL;}
+#endif /* (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE */
 
 
 #ifdef __cplusplus
@@ -0,0 +1,268 @@
+/*
+ * CANopen ASCII gateway (CiA 309-3) on MAX32xxx UART with DMA.
+ *
+ * @file        CO_gatewayUART.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mxc_device.h"
+#include "dma.h"
+
+#include "CO_gatewayUART.h"
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+
+#if CO_GTW_UART_IDX == 0
+#define GTW_DMA_REQ_RX MXC_DMA_REQUEST_UART0RX
+#define GTW_DMA_REQ_TX MXC_DMA_REQUEST_UART0TX
+#elif CO_GTW_UART_IDX == 1
+#define GTW_DMA_REQ_RX MXC_DMA_REQUEST_UART1RX
+#define GTW_DMA_REQ_TX MXC_DMA_REQUEST_UART1TX
+#elif CO_GTW_UART_IDX == 2
+#define GTW_DMA_REQ_RX MXC_DMA_REQUEST_UART2RX
+#define GTW_DMA_REQ_TX MXC_DMA_REQUEST_UART2TX
+#else
+#error "Unsupported CO_GTW_UART_IDX"
+#endif
+
+
+/* Start DMA transmission of the next contiguous part of the transmit ring */
+static void CO_gatewayUART_txStart(CO_gatewayUART_t *gtwUART) {
+    uint16_t rd = gtwUART->txRd;
+    uint16_t wr = gtwUART->txWr;
+
+    if (rd == wr) {
+        return;
+    }
+    gtwUART->txLen = (wr > rd) ? (wr - rd) : (CO_GTW_UART_TX_SIZE - rd);
+
+    mxc_dma_srcdst_t srcdst = {
+        .ch = gtwUART->dmaTx,
+        .source = &gtwUART->txBuf[rd],
+        .dest = NULL,
+        .len = gtwUART->txLen
+    };
+    MXC_DMA_SetSrcDst(srcdst);
+    MXC_DMA_Start(gtwUART->dmaTx);
+}
+
+
+/*
+ * Gateway output, called from CO_GTWA_process() inside CO_process(). Response
+ * is copied into the transmit ring, bytes which do not fit are offered again
+ * in next call. If DMA is idle, transmission starts immediately.
+ */
+static size_t CO_gatewayUART_output(void *object, const char *buf,
+                                    size_t count, uint8_t *connectionOK)
+{
+    CO_gatewayUART_t *gtwUART = (CO_gatewayUART_t *)object;
+    size_t n;
+
+    (void)connectionOK;
+
+    for (n = 0; n < count; n++) {
+        uint16_t next = (uint16_t)((gtwUART->txWr + 1U) % CO_GTW_UART_TX_SIZE);
+        if (next == gtwUART->txRd) {
+            break;
+        }
+        gtwUART->txBuf[gtwUART->txWr] = (uint8_t)buf[n];
+        gtwUART->txWr = next;
+        if (buf[n] == '\n') {
+            gtwUART->responses++;
+        }
+    }
+    if (gtwUART->txLen == 0U) {
+        CO_gatewayUART_txStart(gtwUART);
+    }
+    return n;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_gatewayUART_init(CO_gatewayUART_t *gtwUART,
+                                     CO_GTWA_t *gtwa)
+{
+    /* verify arguments */
+    if (gtwUART == NULL || gtwa == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    gtwUART->gtwa = gtwa;
+
+    /* UART and DMA keep running over communication reset */
+    if (gtwUART->uart != NULL) {
+        CO_GTWA_initRead(gtwa, CO_gatewayUART_output, gtwUART);
+        return CO_ERROR_NO;
+    }
+
+    gtwUART->uart = MXC_UART_GET_UART(CO_GTW_UART_IDX);
+    if (MXC_UART_Init(gtwUART->uart, CO_GTW_UART_BAUD, MXC_UART_APB_CLK)
+        != E_NO_ERROR
+    ) {
+        return CO_ERROR_INVALID_STATE;
+    }
+
+    MXC_DMA_Init();
+    gtwUART->dmaRx = MXC_DMA_AcquireChannel();
+    gtwUART->dmaTx = MXC_DMA_AcquireChannel();
+    if (gtwUART->dmaRx < 0 || gtwUART->dmaTx < 0) {
+        return CO_ERROR_INVALID_STATE;
+    }
+
+    /* Receive: circular, DMA reloads the same buffer after each pass */
+    mxc_dma_config_t config = {
+        .ch = gtwUART->dmaRx,
+        .reqsel = GTW_DMA_REQ_RX,
+        .srcwd = MXC_DMA_WIDTH_BYTE,
+        .dstwd = MXC_DMA_WIDTH_BYTE,
+        .srcinc_en = 0,
+        .dstinc_en = 1
+    };
+    mxc_dma_srcdst_t srcdst = {
+        .ch = gtwUART->dmaRx,
+        .source = NULL,
+        .dest = gtwUART->rxBuf,
+        .len = CO_GTW_UART_RX_SIZE
+    };
+    if (MXC_DMA_ConfigChannel(config, srcdst) != E_NO_ERROR
+        || MXC_DMA_SetSrcReload(srcdst) != E_NO_ERROR
+    ) {
+        return CO_ERROR_INVALID_STATE;
+    }
+
+    /* Transmit: single transfers, started from CO_gatewayUART_process() */
+    config.ch = gtwUART->dmaTx;
+    config.reqsel = GTW_DMA_REQ_TX;
+    config.srcinc_en = 1;
+    config.dstinc_en = 0;
+    srcdst.ch = gtwUART->dmaTx;
+    srcdst.source = gtwUART->txBuf;
+    srcdst.dest = NULL;
+    srcdst.len = 0;
+    if (MXC_DMA_ConfigChannel(config, srcdst) != E_NO_ERROR) {
+        return CO_ERROR_INVALID_STATE;
+    }
+
+    gtwUART->uart->dma |= MXC_F_UART_DMA_RX_EN | MXC_F_UART_DMA_TX_EN;
+    MXC_DMA_ChannelClearFlags(gtwUART->dmaRx, MXC_F_DMA_STATUS_CTZ_IF);
+    MXC_DMA_Start(gtwUART->dmaRx);
+
+    CO_GTWA_initRead(gtwa, CO_gatewayUART_output, gtwUART);
+    gtwUART->lastCall_us = CO_timer_us();
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+bool_t CO_gatewayUART_process(CO_gatewayUART_t *gtwUART) {
+    mxc_dma_srcdst_t srcdst = { .ch = gtwUART->dmaRx };
+    uint32_t now_us = CO_timer_us();
+    uint32_t timeDifference_us = now_us - gtwUART->lastCall_us;
+    bool_t progress = false;
+    gtwUART->lastCall_us = now_us;
+
+    /* DMA write position from remaining count of the current pass. Count to
+     * zero flag is set on each reload, so a wrap since the last call is
+     * known. Flag is read first. A wrap between both reads is already seen in
+     * the position, its flag is then ignored in next call. */
+    bool_t wrapped = (MXC_DMA_ChannelGetFlags(gtwUART->dmaRx)
+                      & MXC_F_DMA_STATUS_CTZ_IF) != 0;
+    if (wrapped) {
+        MXC_DMA_ChannelClearFlags(gtwUART->dmaRx, MXC_F_DMA_STATUS_CTZ_IF);
+    }
+    MXC_DMA_GetSrcDst(&srcdst);
+    uint16_t rxWr = (uint16_t)((CO_GTW_UART_RX_SIZE - srcdst.len)
+                               % CO_GTW_UART_RX_SIZE);
+    if (gtwUART->rxWrapSeen) {
+        wrapped = false;
+    }
+    gtwUART->rxWrapSeen = !wrapped && rxWr < gtwUART->rxWrOld;
+
+    /* Overrun, if unread and newly received bytes do not fit into the ring.
+     * More than one wrap between two calls is counted as one. */
+    uint32_t unread = (uint32_t)(gtwUART->rxWrOld - gtwUART->rxRd
+                                 + CO_GTW_UART_RX_SIZE) % CO_GTW_UART_RX_SIZE;
+    uint32_t received = (uint32_t)(rxWr - gtwUART->rxWrOld
+                                   + CO_GTW_UART_RX_SIZE) % CO_GTW_UART_RX_SIZE;
+    if (wrapped && rxWr >= gtwUART->rxWrOld) {
+        received += CO_GTW_UART_RX_SIZE;
+    }
+    gtwUART->rxWrOld = rxWr;
+    if ((unread + received) >= CO_GTW_UART_RX_SIZE) {
+        uint32_t lost = unread + received;
+        gtwUART->rxLost += lost;
+        gtwUART->rxRd = rxWr;
+        CO_LOG(CO_LOG_GTW_RX_OVERRUN, lost, gtwUART->rxLost);
+    }
+
+    /* Pass received bytes to the gateway, as much as it accepts. Others stay
+     * in the ring, until gateway processes previous commands. */
+    while (gtwUART->rxRd != rxWr) {
+        uint16_t len = (rxWr > gtwUART->rxRd)
+                     ? (rxWr - gtwUART->rxRd)
+                     : (CO_GTW_UART_RX_SIZE - gtwUART->rxRd);
+        size_t space = CO_GTWA_write_getSpace(gtwUART->gtwa);
+        if (space == 0U) {
+            break;
+        }
+        if (len > space) {
+            len = (uint16_t)space;
+        }
+        len = (uint16_t)CO_GTWA_write(gtwUART->gtwa,
+                                      (const char *)&gtwUART->rxBuf[gtwUART->rxRd],
+                                      len);
+        if (len == 0U) {
+            break;
+        }
+        gtwUART->rxRd = (uint16_t)((gtwUART->rxRd + len) % CO_GTW_UART_RX_SIZE);
+        progress = true;
+    }
+
+    /* Transmit responses */
+    if (gtwUART->txLen != 0U) {
+        srcdst.ch = gtwUART->dmaTx;
+        MXC_DMA_GetSrcDst(&srcdst);
+        if (srcdst.len == 0U) {
+            gtwUART->txRd = (uint16_t)((gtwUART->txRd + gtwUART->txLen)
+                                       % CO_GTW_UART_TX_SIZE);
+            gtwUART->txLen = 0;
+            /* space for the rest of a long response */
+            progress = true;
+        }
+    }
+    if (gtwUART->txLen == 0U) {
+        CO_gatewayUART_txStart(gtwUART);
+    }
+
+    /* Throughput, completed responses per second */
+    gtwUART->window_us += timeDifference_us;
+    if (gtwUART->window_us >= 1000000U) {
+        gtwUART->responsesPerSec = gtwUART->responses - gtwUART->responsesOld;
+        gtwUART->responsesOld = gtwUART->responses;
+        gtwUART->window_us = 0;
+    }
+
+    return progress;
+}
+
+#endif /* (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE */
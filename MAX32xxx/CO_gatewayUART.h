@@ -0,0 +1,129 @@
+/*
+ * CANopen ASCII gateway (CiA 309-3) on MAX32xxx UART with DMA.
+ *
+ * @file        CO_gatewayUART.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_GATEWAY_UART_H
+#define CO_GATEWAY_UART_H
+
+#include "301/CO_driver.h"
+#include "309/CO_gateway_ascii.h"
+
+#if ((CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE) || defined CO_DOXYGEN
+
+#include "uart.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* UART used by the gateway, must differ from the console UART. */
+#ifndef CO_GTW_UART_IDX
+#define CO_GTW_UART_IDX 1
+#endif
+#ifndef CO_GTW_UART_BAUD
+#define CO_GTW_UART_BAUD 921600
+#endif
+/* Size of DMA receive ring, must hold all bytes received between two
+ * CO_gatewayUART_process() calls. */
+#ifndef CO_GTW_UART_RX_SIZE
+#define CO_GTW_UART_RX_SIZE 1024
+#endif
+/* Size of transmit ring for gateway responses. */
+#ifndef CO_GTW_UART_TX_SIZE
+#define CO_GTW_UART_TX_SIZE 1024
+#endif
+
+/**
+ * UART gateway object.
+ */
+typedef struct {
+    CO_GTWA_t *gtwa;
+    mxc_uart_regs_t *uart;
+    int dmaRx;
+    int dmaTx;
+    /** Receive ring, written by DMA in circular mode */
+    uint8_t rxBuf[CO_GTW_UART_RX_SIZE];
+    uint16_t rxRd;
+    /** DMA write position in the previous CO_gatewayUART_process() */
+    uint16_t rxWrOld;
+    /** Wrap seen in position before its count to zero flag */
+    bool_t rxWrapSeen;
+    /** Bytes lost, because DMA overwrote them before they were read */
+    uint32_t rxLost;
+    /** Transmit ring, written by gateway, read by DMA */
+    uint8_t txBuf[CO_GTW_UART_TX_SIZE];
+    uint16_t txWr;
+    uint16_t txRd;
+    /** Length of the DMA transfer in progress, 0 if idle */
+    uint16_t txLen;
+    /** Completed responses (lines) since init */
+    uint32_t responses;
+    /** Completed responses in the last second */
+    uint32_t responsesPerSec;
+    uint32_t responsesOld;
+    uint32_t lastCall_us;
+    uint32_t window_us;
+} CO_gatewayUART_t;
+
+
+/**
+ * Initialize UART and DMA channels and connect them to the gateway. Called
+ * after CO_CANopenInit(). UART and DMA are initialized on the first call only,
+ * after communication reset only the gateway object is connected again.
+ *
+ * @param gtwUART This object will be initialized, must be zeroed before the
+ * first call (global variable).
+ * @param gtwa Gateway object, CO->gtwa.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or CO_ERROR_INVALID_STATE, if
+ * UART or DMA can not be initialized.
+ */
+CO_ReturnError_t CO_gatewayUART_init(CO_gatewayUART_t *gtwUART,
+                                     CO_GTWA_t *gtwa);
+
+
+/**
+ * Move bytes between UART and gateway. Received bytes are passed from the DMA
+ * ring to the gateway and responses are started on DMA. Gateway commands are
+ * processed in CO_process(), called with enableGateway
+ * !CO->nodeIdUnconfigured. Never blocks. Called from mainline as often as
+ * possible.
+ *
+ * If DMA overwrites bytes, which were not read yet, the unread part of the
+ * ring is dropped, counted in rxLost and logged with CO_LOG_GTW_RX_OVERRUN.
+ * The gateway then reports an error for the damaged command.
+ *
+ * @param gtwUART UART gateway object.
+ *
+ * @return True, if bytes were passed to the gateway or a transmission has
+ * finished, so CO_process() should run soon.
+ */
+bool_t CO_gatewayUART_process(CO_gatewayUART_t *gtwUART);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE */
+
+#endif /* CO_GATEWAY_UART_H */
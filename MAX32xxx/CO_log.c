@@ -0,0 +1,118 @@
+/*
+ * Deferred binary log for MAX32xxx.
+ *
+ * @file        CO_log.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+
+#include "mxc_device.h"
+
+#include "CO_log.h"
+
+
+#if (CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE
+
+#define CO_LOG_FORMAT(id, format) format,
+static const char * const logFormats[CO_LOG_COUNT] = {
+    CO_LOG_MESSAGES(CO_LOG_FORMAT)
+};
+#undef CO_LOG_FORMAT
+
+static CO_log_record_t logRing[CO_LOG_SIZE];
+static volatile uint32_t logWrCnt;
+static volatile uint32_t logRdCnt;
+static volatile uint32_t logDropped;
+static uint32_t logDroppedReported;
+
+
+/******************************************************************************/
+void CO_log_write(CO_log_id_t id, uint32_t arg0, uint32_t arg1) {
+    uint32_t timestamp_us = CO_timer_us();
+
+    /* Writers may be in different interrupt priorities, so record is written
+     * in short critical section. Reader only advances logRdCnt. */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if ((logWrCnt - logRdCnt) < CO_LOG_SIZE) {
+        CO_log_record_t *rec = &logRing[logWrCnt & (CO_LOG_SIZE - 1U)];
+        rec->timestamp_us = timestamp_us;
+        rec->id = (uint16_t)id;
+        rec->seq = (uint16_t)(logWrCnt + logDropped);
+        rec->arg[0] = arg0;
+        rec->arg[1] = arg1;
+        logWrCnt++;
+    }
+    else {
+        logDropped++;
+    }
+    __set_PRIMASK(primask);
+}
+
+
+/* Output one record to stdout */
+static void CO_log_output(const CO_log_record_t *rec) {
+#if (CO_CONFIG_LOG) & CO_CONFIG_LOG_BINARY
+    putchar(CO_LOG_SYNC0);
+    putchar(CO_LOG_SYNC1);
+    fwrite(rec, sizeof(CO_log_record_t), 1, stdout);
+#else
+    if (rec->id < CO_LOG_COUNT) {
+        printf("[%lu.%06lu] ", (unsigned long)(rec->timestamp_us / 1000000U),
+               (unsigned long)(rec->timestamp_us % 1000000U));
+        printf(logFormats[rec->id], (unsigned long)rec->arg[0],
+               (unsigned long)rec->arg[1]);
+    }
+#endif
+}
+
+
+/******************************************************************************/
+void CO_log_process(void) {
+    uint8_t n;
+
+    for (n = 0; n < CO_LOG_DRAIN_MAX && logRdCnt != logWrCnt; n++) {
+        CO_log_record_t rec = logRing[logRdCnt & (CO_LOG_SIZE - 1U)];
+        logRdCnt++;
+        CO_log_output(&rec);
+    }
+
+    /* report dropped messages, once there is free space again */
+    uint32_t dropped = logDropped;
+    if (dropped != logDroppedReported && n < CO_LOG_DRAIN_MAX) {
+        CO_log_record_t rec = {
+            .timestamp_us = CO_timer_us(),
+            .id = CO_LOG_DROPPED,
+            .seq = 0,
+            .arg = { dropped - logDroppedReported, 0 }
+        };
+        logDroppedReported = dropped;
+        CO_log_output(&rec);
+    }
+}
+
+
+/******************************************************************************/
+uint32_t CO_log_dropped(void) {
+    return logDropped;
+}
+
+#endif /* (CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE */
@@ -0,0 +1,137 @@
+/*
+ * Deferred binary log for MAX32xxx.
+ *
+ * @file        CO_log.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_LOG_H
+#define CO_LOG_H
+
+#include "301/CO_driver.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Log messages. Message ID is its position in this list, arguments are two
+ * 32-bit values. Format strings stay in flash, log record contains only the
+ * ID and arguments. Host decoder (tools/CO_log_decode.py) parses this list,
+ * so keep one entry per line and append new entries at the end.
+ */
+#define CO_LOG_MESSAGES(X) \
+    X(CO_LOG_DROPPED,               "log: %lu messages dropped\n") \
+    X(CO_LOG_CAN_SET_MODE_FAILED,   "Error: MXC_CAN_SetMode(%lu) failed: %ld\n") \
+    X(CO_LOG_CAN_POWER_FAILED,      "Error: MXC_CAN_PowerControl(%lu) failed\n") \
+    X(CO_LOG_CAN_BITRATE_FAILED,    "Error: MXC_CAN_SetBitRate(%lu kbps) failed\n") \
+    X(CO_LOG_CAN_READ_FAILED,       "Error: MXC_CAN_MessageReadAsync() failed\n") \
+    X(CO_LOG_CAN_UNINIT_FAILED,     "Error: MXC_CAN_UnInit() failed\n") \
+    X(CO_LOG_CAN_SEND_FAILED,       "Error: can_MessageSend(0x%03lX) failed\n") \
+    X(CO_LOG_CAN_UNIT_INACTIVE,     "Peripherals entered inactive state\n") \
+    X(CO_LOG_CAN_UNIT_ACTIVE,       "Peripherals entered active state\n") \
+    X(CO_LOG_CAN_UNIT_WARNING,      "Peripheral received error warning\n") \
+    X(CO_LOG_CAN_UNIT_PASSIVE,      "Peripheral entered passive state\n") \
+    X(CO_LOG_CAN_UNIT_BUS_OFF,      "Bus turned off\n") \
+    X(CO_LOG_CAN_UNIT_UNDEFINED,    "Undefined unit event %lu\n") \
+    X(CO_LOG_CAN_OBJ_UNDEFINED,     "Undefined object event %lu\n") \
+    X(CO_LOG_CAN_BUSOFF_RESTART,    "Bus-off restart %lu, back-off %lu ms\n") \
+    X(CO_LOG_CAN_BUSOFF_RECOVERED,  "Bus-off recovered in %lu us\n") \
+    X(CO_LOG_PROG_DOWNLOADED,       "Program download: %lu bytes in %lu ms\n") \
+    X(CO_LOG_CFG_NODE_FAILED,       "Configuration of node %lu failed: 0x%08lX\n") \
+    X(CO_LOG_CFG_FINISHED,          "Network configured in %lu ms, %lu channels\n") \
+    X(CO_LOG_HB_MON_TIMEOUT,        "Heartbeat timeout, node %lu (total %lu)\n") \
+    X(CO_LOG_LSS_AUTO_ASSIGNED,     "LSS: node-ID %lu assigned, serial 0x%08lX\n") \
+    X(CO_LOG_LSS_AUTO_FAILED,       "LSS: auto-addressing failed in step %lu: -%lu\n") \
+    X(CO_LOG_LSS_AUTO_FINISHED,     "LSS: %lu nodes configured in %lu ms\n") \
+    X(CO_LOG_TIME_SYNC_STEP,        "TIME: clock set by %ld us (total %lu)\n") \
+    X(CO_LOG_CAN_AUTO_BITRATE,      "CAN bitrate detected: %lu kbps (%lu tries)\n") \
+    X(CO_LOG_GTW_RX_OVERRUN,        "Gateway: UART overrun, %lu bytes dropped (total %lu)\n")
+
+#define CO_LOG_ID(id, format) id,
+typedef enum {
+    CO_LOG_MESSAGES(CO_LOG_ID)
+    CO_LOG_COUNT
+} CO_log_id_t;
+#undef CO_LOG_ID
+
+#if ((CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE) || defined CO_DOXYGEN
+
+/* Number of records in the log ring, must be power of 2. */
+#ifndef CO_LOG_SIZE
+#define CO_LOG_SIZE 32
+#endif
+/* Maximum number of records written to UART in one CO_log_process() call. */
+#ifndef CO_LOG_DRAIN_MAX
+#define CO_LOG_DRAIN_MAX 4
+#endif
+
+/* Marker preceding each record in binary output (CO_CONFIG_LOG_BINARY) */
+#define CO_LOG_SYNC0 0xA5U
+#define CO_LOG_SYNC1 0x5AU
+
+/**
+ * Log record, written in binary output as is (little endian), preceded by
+ * CO_LOG_SYNC0 and CO_LOG_SYNC1.
+ */
+typedef struct {
+    uint32_t timestamp_us;
+    uint16_t id;
+    /** Lower bits of the record counter, gaps indicate dropped records */
+    uint16_t seq;
+    uint32_t arg[2];
+} CO_log_record_t;
+
+/**
+ * Write message into the log ring. Takes only few cycles and never blocks, so
+ * it may be used from interrupts. If ring is full, message is dropped and
+ * counted.
+ *
+ * @param id Message ID from CO_LOG_MESSAGES.
+ * @param arg0 First argument for the format string.
+ * @param arg1 Second argument for the format string.
+ */
+void CO_log_write(CO_log_id_t id, uint32_t arg0, uint32_t arg1);
+
+/**
+ * Drain up to CO_LOG_DRAIN_MAX records from the log ring to stdout (debug
+ * UART). Records are formatted as text or, with CO_CONFIG_LOG_BINARY, written
+ * as binary for tools/CO_log_decode.py. Called cyclically from mainline.
+ */
+void CO_log_process(void);
+
+/**
+ * Get number of dropped messages since startup.
+ *
+ * @return Number of dropped messages.
+ */
+uint32_t CO_log_dropped(void);
+
+#define CO_LOG(id, arg0, arg1) CO_log_write((id), (uint32_t)(arg0), (uint32_t)(arg1))
+
+#else
+#define CO_LOG(id, arg0, arg1)
+#endif /* (CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_LOG_H */
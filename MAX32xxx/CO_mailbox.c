@@ -0,0 +1,199 @@
+/*
+ * Lock-free mailbox for split-core operation on MAX32xxx.
+ *
+ * @file        CO_mailbox.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_mailbox.h"
+
+
+#if (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_ENABLE
+
+#define RING_IDX(cnt) ((cnt) & (CO_MAILBOX_SIZE - 1U))
+#define RESEND_BIT(i) (1UL << ((i) & 31U))
+
+CO_mailbox_shared_t CO_mailboxShared __attribute__((section(CO_MAILBOX_SECTION)));
+
+/* Producer side of the ring */
+static bool_t CO_mailbox_put(CO_mailbox_ring_t *ring,
+                             const CO_mailbox_msg_t *msg)
+{
+    uint32_t head = ring->head;
+
+    if ((head - ring->tail) >= CO_MAILBOX_SIZE) {
+        return false;
+    }
+    ring->msg[RING_IDX(head)] = *msg;
+    /* message must be visible before the new head */
+    CO_MAILBOX_BARRIER();
+    ring->head = head + 1U;
+    return true;
+}
+
+
+/* Consumer side of the ring */
+static bool_t CO_mailbox_get(CO_mailbox_ring_t *ring, CO_mailbox_msg_t *msg) {
+    uint32_t tail = ring->tail;
+
+    if (tail == ring->head) {
+        return false;
+    }
+    CO_MAILBOX_BARRIER();
+    *msg = ring->msg[RING_IDX(tail)];
+    /* message must be copied before the slot is released */
+    CO_MAILBOX_BARRIER();
+    ring->tail = tail + 1U;
+    return true;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_mailbox_init(CO_mailbox_t *mb,
+                                 CO_mailbox_shared_t *shared,
+                                 OD_t *od)
+{
+    /* verify arguments */
+    if (mb == NULL || shared == NULL
+        || CO_mailboxEntriesCount > CO_MAILBOX_ENTRIES_MAX
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(mb, 0, sizeof(CO_mailbox_t));
+    mb->shared = shared;
+    mb->stackCore = od != NULL;
+
+    if (!mb->stackCore) {
+        return CO_ERROR_NO;
+    }
+
+    for (uint8_t i = 0; i < CO_mailboxEntriesCount; i++) {
+        const CO_mailbox_entry_t *e = &CO_mailboxEntries[i];
+
+        mb->OD_entries[i] = OD_find(od, e->index);
+        if (mb->OD_entries[i] == NULL || e->len == 0U || e->len > 8U) {
+            return CO_ERROR_OD_PARAMETERS;
+        }
+        if (e->toApp == CO_MAILBOX_TO_APP) {
+            mb->resend[i / 32U] |= RESEND_BIT(i);
+        }
+    }
+
+    /* Rings are initialized once after power-on. After communication reset
+     * the application core keeps using them, values it wrote meanwhile are
+     * written into the new OD in the next CO_mailbox_processStack(). */
+    if (shared->magic != CO_MAILBOX_MAGIC) {
+        shared->toApp.head = shared->toApp.tail = 0;
+        shared->toStack.head = shared->toStack.tail = 0;
+        CO_MAILBOX_BARRIER();
+        shared->magic = CO_MAILBOX_MAGIC;
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_mailbox_processStack(CO_mailbox_t *mb) {
+    CO_mailbox_msg_t msg;
+
+    /* values from application, before TPDOs are processed */
+    while (CO_mailbox_get(&mb->shared->toStack, &msg)) {
+        if (msg.entry < CO_mailboxEntriesCount) {
+            const CO_mailbox_entry_t *e = &CO_mailboxEntries[msg.entry];
+            OD_set_value(mb->OD_entries[msg.entry], e->subIndex,
+                         msg.data, e->len, true);
+        }
+    }
+
+    /* changed values for application, after RPDOs are processed */
+    for (uint8_t i = 0; i < CO_mailboxEntriesCount; i++) {
+        const CO_mailbox_entry_t *e = &CO_mailboxEntries[i];
+
+        if (e->toApp != CO_MAILBOX_TO_APP) {
+            continue;
+        }
+        memset(msg.data, 0, sizeof(msg.data));
+        if (OD_get_value(mb->OD_entries[i], e->subIndex,
+                         msg.data, e->len, true) != ODR_OK
+            || ((mb->resend[i / 32U] & RESEND_BIT(i)) == 0U
+                && memcmp(msg.data, mb->values[i], e->len) == 0)
+        ) {
+            continue;
+        }
+        msg.entry = i;
+        msg.len = e->len;
+        if (CO_mailbox_put(&mb->shared->toApp, &msg)) {
+            memcpy(mb->values[i], msg.data, e->len);
+            mb->resend[i / 32U] &= ~RESEND_BIT(i);
+        }
+        else {
+            /* retried in next cycle, value still differs or resend bit is set */
+            mb->overflow++;
+            break;
+        }
+    }
+}
+
+
+/******************************************************************************/
+void CO_mailbox_processApp(CO_mailbox_t *mb) {
+    CO_mailbox_msg_t msg;
+
+    while (CO_mailbox_get(&mb->shared->toApp, &msg)) {
+        if (msg.entry < CO_mailboxEntriesCount && msg.len <= 8U) {
+            memcpy(mb->values[msg.entry], msg.data, msg.len);
+        }
+    }
+}
+
+
+/******************************************************************************/
+void CO_mailbox_read(CO_mailbox_t *mb, uint8_t entry, void *buf) {
+    if (entry < CO_mailboxEntriesCount) {
+        memcpy(buf, mb->values[entry], CO_mailboxEntries[entry].len);
+    }
+}
+
+
+/******************************************************************************/
+bool_t CO_mailbox_write(CO_mailbox_t *mb, uint8_t entry, const void *buf) {
+    CO_mailbox_msg_t msg;
+
+    if (entry >= CO_mailboxEntriesCount) {
+        return false;
+    }
+    msg.entry = entry;
+    msg.len = CO_mailboxEntries[entry].len;
+    memset(msg.data, 0, sizeof(msg.data));
+    memcpy(msg.data, buf, msg.len);
+    memcpy(mb->values[entry], msg.data, msg.len);
+
+    if (!CO_mailbox_put(&mb->shared->toStack, &msg)) {
+        mb->overflow++;
+        return false;
+    }
+    return true;
+}
+
+#endif /* (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_ENABLE */
@@ -0,0 +1,230 @@
+/*
+ * Lock-free mailbox for split-core operation on MAX32xxx.
+ *
+ * @file        CO_mailbox.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_MAILBOX_H
+#define CO_MAILBOX_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Split-core operation: one core runs the CANopen stack and owns the CAN
+ * peripheral, the other core (application) sees only the process image of the
+ * objects listed in CO_mailboxEntries. The main files of this port use
+ * Cortex-M SysTick and NVIC, so on MAX32690 the stack runs on the Cortex-M4
+ * and the application on the RISC-V core, see examples_MAX32690/MailboxApp. Values are
+ * exchanged through two single-producer single-consumer rings in memory
+ * shared by both cores. No locks are used, so neither core ever waits for the
+ * other.
+ */
+
+/* Number of messages in each ring, must be power of 2. */
+#ifndef CO_MAILBOX_SIZE
+#define CO_MAILBOX_SIZE 32
+#endif
+/* Maximum number of objects in the process image. */
+#ifndef CO_MAILBOX_ENTRIES_MAX
+#define CO_MAILBOX_ENTRIES_MAX 32
+#endif
+/* Input section of CO_mailboxShared. Linker files of both cores must place it
+ * as NOLOAD at the same address, outside of their RAM regions (and so away
+ * from stack and heap), see CO_mailbox.ld. */
+#ifndef CO_MAILBOX_SECTION
+#define CO_MAILBOX_SECTION ".co_mailbox"
+#endif
+#define CO_MAILBOX_SHARED (&CO_mailboxShared)
+
+/* Written by stack core after rings are initialized */
+#define CO_MAILBOX_MAGIC 0x434F4D42UL
+
+/* Ordering of shared memory accesses between cores */
+#if defined(__riscv)
+#define CO_MAILBOX_BARRIER() __asm volatile("fence rw, rw" ::: "memory")
+#else
+#define CO_MAILBOX_BARRIER() __asm volatile("dmb" ::: "memory")
+#endif
+
+/** Direction of process image object, CO_mailbox_entry_t.toApp */
+#define CO_MAILBOX_TO_STACK 0U  /* application writes, mapped to TPDO */
+#define CO_MAILBOX_TO_APP   1U  /* stack writes, mapped to RPDO */
+
+/**
+ * Process image object, OD variable mapped to PDO.
+ */
+typedef struct {
+    uint16_t index;
+    uint8_t subIndex;
+    /** Size of the variable, 1 to 8 bytes */
+    uint8_t len;
+    /** CO_MAILBOX_TO_APP or CO_MAILBOX_TO_STACK */
+    uint8_t toApp;
+} CO_mailbox_entry_t;
+
+/**
+ * List of process image objects, provided by application, identical on both
+ * cores. Position in the list identifies the object in mailbox messages.
+ */
+extern const CO_mailbox_entry_t CO_mailboxEntries[];
+extern const uint8_t CO_mailboxEntriesCount;
+
+/**
+ * Mailbox message, new value of one process image object.
+ */
+typedef struct {
+    uint8_t entry;
+    uint8_t len;
+    uint8_t data[8];
+} CO_mailbox_msg_t;
+
+/**
+ * Single-producer single-consumer ring. Free running counters, head is
+ * written only by the producer, tail only by the consumer.
+ */
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    CO_mailbox_msg_t msg[CO_MAILBOX_SIZE];
+} CO_mailbox_ring_t;
+
+/**
+ * Memory shared by both cores, in section CO_MAILBOX_SECTION.
+ */
+typedef struct {
+    volatile uint32_t magic;
+    CO_mailbox_ring_t toApp;
+    CO_mailbox_ring_t toStack;
+} CO_mailbox_shared_t;
+
+/** Shared memory, defined in CO_mailbox.c, not initialized by startup code */
+extern CO_mailbox_shared_t CO_mailboxShared;
+
+/**
+ * Mailbox object, one on each core, in private memory.
+ */
+typedef struct {
+    CO_mailbox_shared_t *shared;
+    /** Stack core: OD entries of process image objects, NULL on app core */
+    OD_entry_t *OD_entries[CO_MAILBOX_ENTRIES_MAX];
+    /** Stack core: last value sent to app. App core: process image. */
+    uint8_t values[CO_MAILBOX_ENTRIES_MAX][8];
+    /** Stack core: bit per CO_MAILBOX_TO_APP object, which is sent also if
+     * unchanged. All are set by init, so app gets full image after reset. */
+    uint32_t resend[(CO_MAILBOX_ENTRIES_MAX + 31U) / 32U];
+    /** Messages not sent, because ring was full */
+    uint32_t overflow;
+    bool_t stackCore;
+} CO_mailbox_t;
+
+
+/**
+ * Initialize mailbox object.
+ *
+ * On the stack core (od != NULL) shared memory is initialized and
+ * CO_MAILBOX_MAGIC is written last. This is done only once, after power-on,
+ * when magic is not valid yet. Rings are not touched on later calls from
+ * communication reset, because tail of toApp and head of toStack belong to the
+ * application core, which keeps running. All CO_MAILBOX_TO_APP objects are
+ * sent again after each init, also if their value is zero. The application
+ * core (od == NULL) must wait for CO_mailbox_ready() before use.
+ *
+ * @param mb This object will be initialized.
+ * @param shared Shared memory, usually CO_MAILBOX_SHARED.
+ * @param od Object Dictionary on the stack core, NULL on the application core.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or CO_ERROR_OD_PARAMETERS, if
+ * process image object does not exist in OD.
+ */
+CO_ReturnError_t CO_mailbox_init(CO_mailbox_t *mb,
+                                 CO_mailbox_shared_t *shared,
+                                 OD_t *od);
+
+
+/**
+ * Check, if stack core has initialized the shared memory.
+ *
+ * @param mb Mailbox object.
+ *
+ * @return True, if mailbox is ready.
+ */
+static inline bool_t CO_mailbox_ready(CO_mailbox_t *mb) {
+    return mb->shared->magic == CO_MAILBOX_MAGIC;
+}
+
+
+/**
+ * Process mailbox on the stack core. Values from the application are written
+ * into OD, changed values of CO_MAILBOX_TO_APP objects are sent to the
+ * application. Called from RT thread between RPDO and TPDO processing, with
+ * OD locked.
+ *
+ * @param mb Mailbox object.
+ */
+void CO_mailbox_processStack(CO_mailbox_t *mb);
+
+
+/**
+ * Process mailbox on the application core: update process image with values
+ * received from the stack core. Called cyclically, for example at the start of
+ * the control loop.
+ *
+ * @param mb Mailbox object.
+ */
+void CO_mailbox_processApp(CO_mailbox_t *mb);
+
+
+/**
+ * Read object from the process image on the application core.
+ *
+ * @param mb Mailbox object.
+ * @param entry Position in CO_mailboxEntries.
+ * @param [out] buf Buffer of CO_mailboxEntries[entry].len bytes.
+ */
+void CO_mailbox_read(CO_mailbox_t *mb, uint8_t entry, void *buf);
+
+
+/**
+ * Write object on the application core. Value is sent to the stack core,
+ * which writes it into OD in its next RT cycle.
+ *
+ * @param mb Mailbox object.
+ * @param entry Position in CO_mailboxEntries.
+ * @param buf Buffer of CO_mailboxEntries[entry].len bytes.
+ *
+ * @return False, if ring is full.
+ */
+bool_t CO_mailbox_write(CO_mailbox_t *mb, uint8_t entry, const void *buf);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_ENABLE */
+
+#endif /* CO_MAILBOX_H */
@@ -38,7 +38,28 @@
 #include "OD.h"
 #include "CO_application.h"
 #include "CO_storageBlank.h"
-
+#include "CO_CANstats.h"
+#include "CO_CANtrace.h"
+#include "CO_CANselfTest.h"
+#include "CO_log.h"
+#include "CO_mailbox.h"
+#include "CO_procImage.h"
+#include "CO_ODaccess.h"
+#include "CO_TPDOcos.h"
+#include "CO_timerWheel.h"
+#include "CO_gatewayUART.h"
+#include "CO_progDownload.h"
+#include "CO_configManager.h"
+#include "CO_HBmonitor.h"
+#include "CO_LSSauto.h"
+#include "CO_SYNCtimer.h"
+#include "CO_TIMEsync.h"
+#include "CO_autoBitrate.h"
+#include "CO_CANbridge.h"
+
+
+/* FreeRTOS threading model is in CO_main_max32xxx_freertos.c */
+#if !((CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE)
 
 #define log_printf(macropar_message, ...) \
         printf(macropar_message, ##__VA_ARGS__)
@@ -61,6 +82,58 @@
 CO_t *CO = NULL; /* CANopen object */
 uint8_t LED_red, LED_green;
 volatile uint32_t ticksMs = 0;
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+CO_CANstats_t CANstats;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+CO_CANtrace_t CANtrace;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+CO_CANselfTest_t CANselfTest;
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+CO_CANbridge_t CANbridge;
+#endif
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+CO_mailbox_t mailbox;
+#endif
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+CO_procImage_t procImage;
+#endif
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+CO_TPDOcos_t TPDOcos;
+#endif
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+CO_timerWheel_t timerWheel;
+/* Mainline services, processed when flag is set by timer or by callback */
+static CO_timerWheel_timer_t stackTimer;
+static volatile bool_t stackDue;
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+static CO_timerWheel_timer_t hbMonTimer;
+static volatile bool_t hbMonDue;
+#endif
+#endif
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+CO_gatewayUART_t gatewayUART;
+#endif
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+CO_progDownload_t progDownload;
+#endif
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+CO_configManager_t configManager;
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+CO_HBmonitor_t HBmonitor;
+#endif
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+CO_LSSauto_t LSSauto;
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+CO_SYNCtimer_t SYNCtimer;
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+CO_TIMEsync_t TIMEsync;
+#endif
 
 /* 1ms interrupt handler */
 void tmrTask_thread(void);
@@ -68,6 +141,25 @@ void tmrTask_thread(void);
 /* CAN interrupt handler */
 void CO_CAN1InterruptHandler(void);
 
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+/* SYNC timer interrupt handler */
+void CO_SYNCtimerInterruptHandler(void);
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+/* CAN1 interrupt handler */
+void CO_CANbridgeInterruptHandler(void);
+#endif
+
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+/* Mark mainline service as due, called from timer wheel or from CANopen
+ * object, also in CAN interrupt */
+static void serviceDue(void *object) {
+    *(volatile bool_t *)object = true;
+}
+#endif
+
+
 /* main ***********************************************************************/
 int main (void){
     CO_ReturnError_t err;
@@ -95,6 +187,10 @@ int main (void){
 #endif
 
     /* Configure microcontroller. */
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+    /* Install downloaded program, before anything else runs from flash */
+    CO_progDownload_bootSwap();
+#endif
 
 
     /* Allocate memory */
@@ -105,6 +201,13 @@ int main (void){
     OD_INIT_CONFIG(co_config); /* helper macro from OD.h */
     co_config.CNT_LEDS = 1;
     co_config.CNT_LSS_SLV = 1;
+#if ((CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE) \
+    || ((CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE)
+    co_config.CNT_LSS_MST = 1;
+#endif
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+    co_config.CNT_GTWA = 1;
+#endif
     config_ptr = &co_config;
 #endif /* CO_MULTIPLE_OD */
     CO = CO_new(config_ptr, &heapMemoryUsed);
@@ -137,6 +240,14 @@ int main (void){
         log_printf("Error: app_programStart: %d\n", err);
         return 0;
     }
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    /* Application has no stored bitrate, bitrate of the bus is detected on
+     * the first pass */
+    bool_t detectBitRate = pendingBitRate == 0;
+    if (detectBitRate) {
+        pendingBitRate = CO_AUTO_BITRATE_DEFAULT;
+    }
+#endif
 
 
     while(reset != CO_RESET_APP){
@@ -165,6 +276,22 @@ int main (void){
             return 0;
         }
 
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+        /* Statistics are readable from OD, if manufacturer entry exists */
+        CO_CANstats_init(&CANstats, OD_find(OD, CO_CAN_STATS_OD_INDEX),
+                         pendingBitRate);
+        CO->CANmodule->stats = &CANstats;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+        /* Trace is accessible from OD, if manufacturer entry exists */
+        CO_CANtrace_init(&CANtrace, OD_find(OD, CO_CAN_TRACE_OD_INDEX));
+        CO->CANmodule->trace = &CANtrace;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+        /* Self-test is started from OD, if manufacturer entry exists */
+        CO_CANselfTest_init(&CANselfTest, OD_find(OD, CO_CAN_SELFTEST_OD_INDEX));
+#endif
+
         /* configure CAN interrupt registers */
         MXC_CAN_EnableInt(MXC_CAN_GET_IDX(CO->CANmodule->CANptr),
                 MXC_F_CAN_INTEN_DOR | MXC_F_CAN_INTEN_BERR
@@ -181,6 +308,20 @@ int main (void){
 #error "Unsupported target"
 #endif
 
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+        /* Listen to the bus, then initialize CAN again at detected bitrate or
+         * at CO_AUTO_BITRATE_DEFAULT */
+        if (detectBitRate) {
+            uint16_t bitRate = CO_CANdetectBitRate(CO->CANmodule);
+
+            detectBitRate = false;
+            if (bitRate != 0) {
+                pendingBitRate = bitRate;
+            }
+            continue;
+        }
+#endif
+
         CO_LSS_address_t lssAddress = {.identity = {
             .vendorID = OD_PERSIST_COMM.x1018_identity.vendor_ID,
             .productCode = OD_PERSIST_COMM.x1018_identity.productCode,
@@ -218,6 +359,16 @@ int main (void){
             return 0;
         }
 
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+        /* Before PDOs, which may map 0x1013 */
+        err = CO_TIMEsync_init(&TIMEsync, CO->TIME, CO->CANmodule,
+                               OD_find(OD, 0x1012), OD_find(OD, 0x1013));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: TIME synchronization initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
         err = CO_CANopenInitPDO(CO, CO->em, OD, activeNodeId, &errInfo);
         if(err != CO_ERROR_NO) {
             if (err == CO_ERROR_OD_PARAMETERS) {
@@ -229,6 +380,127 @@ int main (void){
             return 0;
         }
 
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+        /* ASCII gateway on separate UART, console stays for log */
+        err = CO_gatewayUART_init(&gatewayUART, CO->gtwa);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Gateway initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+        /* Process image for the application core */
+        err = CO_mailbox_init(&mailbox, CO_MAILBOX_SHARED, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Mailbox initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+        /* Process image for app_programAsync() */
+        err = CO_procImage_init(&procImage, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Process image initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+        /* Event driven TPDOs are sent also on change of mapped data */
+        err = CO_TPDOcos_init(&TPDOcos, CO->TPDO, OD_CNT_TPDO);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: TPDO change of state initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+        /* Program download into the second flash bank, objects 0x1F50.. */
+        err = CO_progDownload_init(&progDownload, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Program download initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+        /* Configure slaves after each communication reset */
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+#if OD_CNT_SDO_CLI < 2
+#error "CO_CONFIG_CFG_MGR with CO_CONFIG_GTW_UART needs two SDO clients"
+#endif
+        /* first SDO client belongs to the ASCII gateway */
+        err = CO_configManager_init(&configManager, &CO->SDOclient[1],
+                                    OD_CNT_SDO_CLI - 1);
+#else
+        err = CO_configManager_init(&configManager, CO->SDOclient, OD_CNT_SDO_CLI);
+#endif
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Configuration manager initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+        /* Heartbeats of all other nodes, 0x1016 consumer entries not needed */
+        err = CO_HBmonitor_init(&HBmonitor, CO->CANmodule, CO_HB_MON_TIME_MS,
+                                activeNodeId);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Heartbeat monitor initialization failed: %d\n", err);
+            return 0;
+        }
+#endif
+
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+        /* Assign node-IDs to all unconfigured slaves */
+        err = CO_LSSauto_init(&LSSauto, CO->LSSmaster, CO->NMT,
+                              OD_find(OD, 0x1016), activeNodeId);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: LSS auto-addressing initialization failed: %d\n", err);
+            return 0;
+        }
+        if(!CO->nodeIdUnconfigured) {
+            CO_LSSauto_start(&LSSauto);
+        }
+#endif
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+        /* SYNC producer on hardware timer, same interrupt priority as CAN */
+        err = CO_SYNCtimer_init(&SYNCtimer, CO->SYNC, CO->CANmodule,
+                                OD_find(OD, 0x1005),
+                                OD_find(OD, CO_SYNC_TMR_OD_INDEX));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: SYNC timer initialization failed: %d\n", err);
+            return 0;
+        }
+#if TARGET_NUM == 32662
+        NVIC_SetPriority(CO_SYNC_TMR_IRQn, NVIC_GetPriority(CAN_IRQn));
+#else
+        NVIC_SetPriority(CO_SYNC_TMR_IRQn, NVIC_GetPriority(CAN0_IRQn));
+#endif
+        MXC_NVIC_SetVector(CO_SYNC_TMR_IRQn, CO_SYNCtimerInterruptHandler);
+        NVIC_EnableIRQ(CO_SYNC_TMR_IRQn);
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+        /* Bridge to CAN1, same interrupt priority as CAN0 */
+        err = CO_CANbridge_init(&CANbridge, CO->CANmodule, MXC_CAN1,
+                                CO_CAN_BRIDGE_BITRATE != 0
+                                ? CO_CAN_BRIDGE_BITRATE : pendingBitRate,
+                                OD_find(OD, CO_CAN_BRIDGE_OD_INDEX),
+                                OD_find(OD, CO_CAN_BRIDGE_STATS_OD_INDEX));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: CAN bridge initialization failed: %d\n", err);
+            return 0;
+        }
+        NVIC_SetPriority(CAN1_IRQn, NVIC_GetPriority(CAN0_IRQn));
+        MXC_NVIC_SetVector(CAN1_IRQn, CO_CANbridgeInterruptHandler);
+        NVIC_EnableIRQ(CAN1_IRQn);
+        CO->CANmodule->bridge = &CANbridge;
+#endif
+
         /* Configure Timer interrupt function for execution every 1 millisecond */
         /* CPU's system tick timer is used to generate interrupt every 1 millisecond. */
         if (SysTick_Config(SystemCoreClock / 1000)) {
@@ -239,6 +511,32 @@ int main (void){
 
         /* Configure CANopen callbacks, etc */
         if(!CO->nodeIdUnconfigured) {
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+            /* Process stack, when there is something to process */
+#if (CO_CONFIG_NMT) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_NMT_initCallbackPre(CO->NMT, (void *)&stackDue, serviceDue);
+#endif
+#if (CO_CONFIG_EM) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_EM_initCallbackPre(CO->em, (void *)&stackDue, serviceDue);
+#endif
+#if (CO_CONFIG_HB_CONS) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_HBconsumer_initCallbackPre(CO->HBcons, (void *)&stackDue, serviceDue);
+#endif
+#if (CO_CONFIG_SDO_SRV) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_SDOserver_initCallbackPre(&CO->SDOserver[0], (void *)&stackDue, serviceDue);
+#endif
+#if ((CO_CONFIG_SDO_CLI) & CO_CONFIG_SDO_CLI_ENABLE) \
+    && ((CO_CONFIG_SDO_CLI) & CO_CONFIG_FLAG_CALLBACK_PRE)
+            /* Gateway transfers are processed in CO_process() */
+            for (uint16_t i = 0; i < OD_CNT_SDO_CLI; i++) {
+                CO_SDOclient_initCallbackPre(&CO->SDOclient[i], (void *)&stackDue, serviceDue);
+            }
+#endif
+#if ((CO_CONFIG_LSS) & CO_CONFIG_LSS_MASTER) \
+    && ((CO_CONFIG_LSS) & CO_CONFIG_FLAG_CALLBACK_PRE)
+            CO_LSSmaster_initCallbackPre(CO->LSSmaster, (void *)&stackDue, serviceDue);
+#endif
+#endif
 
 #if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
             if(storageInitError != 0) {
@@ -250,6 +548,22 @@ int main (void){
         else {
             log_printf("CANopenNode - Node-id not initialized\n");
         }
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+#if (CO_CONFIG_LSS) & CO_CONFIG_FLAG_CALLBACK_PRE
+        CO_LSSslave_initCallbackPre(CO->LSSslave, (void *)&stackDue, serviceDue);
+#endif
+        /* CAN error state and bus-off are handled without delay */
+        CO_CANmodule_initCallbackError(CO->CANmodule, (void *)&stackDue, serviceDue);
+
+        /* All services are processed in the first pass */
+        CO_timerWheel_init(&timerWheel, ticksMs);
+        CO_timerWheel_initTimer(&stackTimer, serviceDue, (void *)&stackDue);
+        stackDue = true;
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+        CO_timerWheel_initTimer(&hbMonTimer, serviceDue, (void *)&hbMonDue);
+        hbMonDue = true;
+#endif
+#endif
 
 
         /* start CAN */
@@ -261,18 +575,87 @@ int main (void){
         fflush(stdout);
 
         uint32_t lastCall = 0;
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+        uint32_t lastStackCall = 0;
+#endif
         while(reset == CO_RESET_NOT){
             /* loop for normal program execution ******************************************/
             /* get time difference since last function call */
             if ((ticksMs - lastCall) > 0) {
                 uint32_t timeDifference_us = (ticksMs - lastCall) * 1000;
                 lastCall = ticksMs;
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+                /* Only expired timers are touched, services run when due */
+                CO_timerWheel_advance(&timerWheel, ticksMs);
+                if (stackDue) {
+                    uint32_t timerNext_us = CO_TIMER_WHEEL_IDLE_US;
+
+                    stackDue = false;
+                    reset = CO_process(CO, !CO->nodeIdUnconfigured,
+                                       (ticksMs - lastStackCall) * 1000U,
+                                       &timerNext_us);
+                    lastStackCall = ticksMs;
+#if (CO_CONFIG_CAN_BUSOFF) & CO_CONFIG_CAN_BUSOFF_ENABLE
+                    /* Back-off and recovery are polled in CO_CANmodule_process() */
+                    if ((!CO->CANmodule->CANnormal
+                         || CO->CANmodule->busOffState != CO_CAN_BUSOFF_NONE)
+                        && timerNext_us > (CO_CAN_BUSOFF_BACKOFF_MIN_MS * 1000U)
+                    ) {
+                        timerNext_us = CO_CAN_BUSOFF_BACKOFF_MIN_MS * 1000U;
+                    }
+#endif
+                    CO_timerWheel_start(&timerWheel, &stackTimer, timerNext_us);
+                }
+#else
                 /* CANopen process */
-                reset = CO_process(CO, false, timeDifference_us, NULL);
+                reset = CO_process(CO, !CO->nodeIdUnconfigured, timeDifference_us, NULL);
+#endif
 
                 /* Execute external application code */
                 app_programAsync(CO, timeDifference_us);
 
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+                CO_CANstats_process(&CANstats, timeDifference_us);
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+                CO_CANtrace_process(&CANtrace, CO->CANmodule);
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+                CO_CANbridge_process(&CANbridge, timeDifference_us);
+#endif
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+                CO_progDownload_process(&progDownload);
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+                if (hbMonDue) {
+                    uint32_t timerNext_us = CO_TIMER_WHEEL_IDLE_US;
+
+                    hbMonDue = false;
+                    CO_HBmonitor_process(&HBmonitor, &timerNext_us);
+                    CO_timerWheel_start(&timerWheel, &hbMonTimer, timerNext_us);
+                }
+#else
+                CO_HBmonitor_process(&HBmonitor, NULL);
+#endif
+#endif
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+                CO_LSSauto_process(&LSSauto, timeDifference_us, NULL);
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+                CO_SYNCtimer_process(&SYNCtimer, !CO->nodeIdUnconfigured
+                                     && CO->CANmodule->CANnormal
+                                     && (CO_NMT_getInternalState(CO->NMT) == CO_NMT_PRE_OPERATIONAL
+                                         || CO_NMT_getInternalState(CO->NMT) == CO_NMT_OPERATIONAL));
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+                CO_TIMEsync_process(&TIMEsync);
+#endif
+#if (CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE
+                /* Messages from driver and interrupts, non-blocking for them */
+                CO_log_process();
+#endif
+
                 LED_red = CO_LED_RED(CO->LEDs, CO_LED_CANopen);
                 LED_green = CO_LED_GREEN(CO->LEDs, CO_LED_CANopen);
                 if (num_leds)
@@ -281,7 +664,46 @@ int main (void){
                     LED_red ? LED_On(1) : LED_Off(1);
             }
 
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+            /* UART bytes are moved in every pass, gateway commands are
+             * processed in CO_process(). */
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+            if (CO_gatewayUART_process(&gatewayUART)) {
+                stackDue = true;
+            }
+#else
+            (void)CO_gatewayUART_process(&gatewayUART);
+#endif
+#endif
+
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+            /* Processed in every pass, idle counter of the test counts passes */
+            CO_CANselfTest_process(&CANselfTest, CO->CANmodule, NULL);
+#endif
+
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+            /* Processed in every pass, block segments are sent one per call */
+            if (!CO->nodeIdUnconfigured) {
+                CO_configManager_process(&configManager, NULL);
+            }
+#endif
+
             /* Process automatic storage */
+
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+            /* Nothing due before the next tick, sleep until an interrupt.
+             * SysTick wakes at the latest. Pending interrupt ends WFI also
+             * with interrupts masked, so no wake-up is lost after the check. */
+            __disable_irq();
+            if (!stackDue && ticksMs == lastCall
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+                && CANselfTest.state != CO_CAN_SELFTEST_PENDING
+#endif
+            ) {
+                __WFI();
+            }
+            __enable_irq();
+#endif
         }
     }
 
@@ -309,7 +731,28 @@ int main (void){
 }
 
 
+/* microsecond time base, see CO_driver_target.h ******************************/
+uint32_t CO_timer_us(void){
+    uint32_t ms, val;
+    bool_t wrapped;
+
+    do {
+        ms = ticksMs;
+        val = SysTick->VAL;
+        /* SysTick reloaded, but its interrupt did not increment ticksMs yet */
+        wrapped = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+    } while (ms != ticksMs);
+
+    if (wrapped && val > (SysTick->LOAD / 2U)) {
+        ms++;
+    }
+    return ms * 1000U
+         + (SysTick->LOAD - val) / (SystemCoreClock / 1000000U);
+}
+
+
 /* timer thread executes in constant intervals ********************************/
+CO_RAMFUNC
 void tmrTask_thread(void){
     /* get time difference since last function call */
     uint32_t timeDifference_us = 1000;
@@ -322,6 +765,11 @@ void tmrTask_thread(void){
     if (!CO->nodeIdUnconfigured && CO->CANmodule->CANnormal) {
         bool_t syncWas = false;
 
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+        /* Mainline readers repeat, if they overlap with this section */
+        CO_ODaccess_writeBegin();
+#endif
+
 #if (CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE
         syncWas = CO_process_SYNC(CO, timeDifference_us, NULL);
 #endif
@@ -332,11 +780,28 @@ void tmrTask_thread(void){
         /* Execute external application code */
         app_programRt(CO, timeDifference_us);
 
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+        /* Exchange process image with the application core */
+        CO_mailbox_processStack(&mailbox);
+#endif
+
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+        /* Exchange process image with app_programAsync() */
+        CO_procImage_processStack(&procImage, syncWas);
+#endif
+
 #if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_ENABLE
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+        CO_TPDOcos_process(&TPDOcos);
+#endif
         CO_process_TPDO(CO, syncWas, timeDifference_us, NULL);
 #endif
 
             /* Further I/O or nonblocking application code may go here. */
+
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+        CO_ODaccess_writeEnd();
+#endif
         }
     CO_UNLOCK_OD(CO->CANmodule);
 
@@ -345,6 +810,7 @@ void tmrTask_thread(void){
 
 
 /* CAN interrupt function executes on received CAN message ********************/
+CO_RAMFUNC
 void CO_CAN1InterruptHandler(void){
     /* interrupt flag cleared in MXC_CAN_Handler */
 #if TARGET_NUM == 32662
@@ -354,4 +820,24 @@ void CO_CAN1InterruptHandler(void){
 #else
 #error "Unsupported target"
 #endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    /* Frames replayed from CAN trace */
+    CO_CANrxInjectProcess(CO->CANmodule);
+#endif
+}
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+/* SYNC timer interrupt function sends SYNC at the 0x1006 period **************/
+void CO_SYNCtimerInterruptHandler(void){
+    CO_SYNCtimer_interrupt(&SYNCtimer);
+}
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+/* CAN1 interrupt function forwards frames between the controllers ************/
+void CO_CANbridgeInterruptHandler(void){
+    CO_CANbridge_interrupt(&CANbridge);
 }
+#endif
+
+#endif /* !((CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE) */
@@ -0,0 +1,875 @@
+/*
+ * CANopen main program file for FreeRTOS.
+ *
+ * @file        CO_main_max32xxx_freertos.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "mxc_device.h"
+#include "mxc_sys.h"
+#include "mxc_delay.h"
+#include "can.h"
+#include "led.h"
+#include "nvic_table.h"
+
+#include "CANopen.h"
+#include "OD.h"
+#include "CO_application.h"
+#include "CO_storageBlank.h"
+#include "CO_CANstats.h"
+#include "CO_CANtrace.h"
+#include "CO_CANselfTest.h"
+#include "CO_log.h"
+#include "CO_mailbox.h"
+#include "CO_procImage.h"
+#include "CO_ODaccess.h"
+#include "CO_TPDOcos.h"
+#include "CO_gatewayUART.h"
+#include "CO_progDownload.h"
+#include "CO_configManager.h"
+#include "CO_HBmonitor.h"
+#include "CO_LSSauto.h"
+#include "CO_SYNCtimer.h"
+#include "CO_TIMEsync.h"
+#include "CO_autoBitrate.h"
+#include "CO_CANbridge.h"
+
+
+/* Bare-metal threading model is in CO_main_max32xxx.c */
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+
+/*
+ * Threading model:
+ * - rtTask_thread: highest priority, processes SYNC, RPDO and TPDO every
+ *   CO_RTOS_RT_PERIOD_MS or immediately after SYNC reception.
+ * - canRxTask_thread: processes messages, which CAN interrupt puts into
+ *   CO_CANmodule_t.rxQueue.
+ * - mainlineTask_thread: low priority, calls CO_process() and sleeps until
+ *   timerNext_us or until woken by callback from CANopen object.
+ * Application tasks (motor control, communication) may use priorities between
+ * mainline and CAN RX task.
+ */
+#ifndef CO_RTOS_RT_PRIORITY
+#define CO_RTOS_RT_PRIORITY (configMAX_PRIORITIES - 1)
+#endif
+#ifndef CO_RTOS_CANRX_PRIORITY
+#define CO_RTOS_CANRX_PRIORITY (configMAX_PRIORITIES - 2)
+#endif
+#ifndef CO_RTOS_MAINLINE_PRIORITY
+#define CO_RTOS_MAINLINE_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+#ifndef CO_RTOS_RT_STACK_SIZE
+#define CO_RTOS_RT_STACK_SIZE 512
+#endif
+#ifndef CO_RTOS_CANRX_STACK_SIZE
+#define CO_RTOS_CANRX_STACK_SIZE 256
+#endif
+#ifndef CO_RTOS_MAINLINE_STACK_SIZE
+#define CO_RTOS_MAINLINE_STACK_SIZE 1024
+#endif
+/* Period of rtTask_thread */
+#ifndef CO_RTOS_RT_PERIOD_MS
+#define CO_RTOS_RT_PERIOD_MS 1
+#endif
+/* Maximum sleep time of mainlineTask_thread */
+#ifndef CO_RTOS_MAINLINE_PERIOD_MS
+#define CO_RTOS_MAINLINE_PERIOD_MS 10
+#endif
+
+
+#define log_printf(macropar_message, ...) \
+        printf(macropar_message, ##__VA_ARGS__)
+
+
+/* default values for CO_CANopenInit() */
+#define NMT_CONTROL \
+            CO_NMT_STARTUP_TO_OPERATIONAL \
+          | CO_NMT_ERR_ON_ERR_REG \
+          | CO_ERR_REG_GENERIC_ERR \
+          | CO_ERR_REG_COMMUNICATION
+#define FIRST_HB_TIME 500
+#define SDO_SRV_TIMEOUT_TIME 1000
+#define SDO_CLI_TIMEOUT_TIME 500
+#define SDO_CLI_BLOCK false
+#define OD_STATUS_BITS NULL
+
+
+/* Global variables and objects */
+CO_t *CO = NULL; /* CANopen object */
+uint8_t LED_red, LED_green;
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+CO_CANstats_t CANstats;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+CO_CANtrace_t CANtrace;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+CO_CANselfTest_t CANselfTest;
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+CO_CANbridge_t CANbridge;
+#endif
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+CO_mailbox_t mailbox;
+#endif
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+CO_procImage_t procImage;
+#endif
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+CO_TPDOcos_t TPDOcos;
+#endif
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+CO_gatewayUART_t gatewayUART;
+#endif
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+CO_progDownload_t progDownload;
+#endif
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+CO_configManager_t configManager;
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+CO_HBmonitor_t HBmonitor;
+#endif
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+CO_LSSauto_t LSSauto;
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+CO_SYNCtimer_t SYNCtimer;
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+CO_TIMEsync_t TIMEsync;
+#endif
+static TaskHandle_t rtTask = NULL;
+static TaskHandle_t canRxTask = NULL;
+static TaskHandle_t mainlineTask = NULL;
+
+/* Tasks */
+static void rtTask_thread(void *arg);
+static void canRxTask_thread(void *arg);
+static void mainlineTask_thread(void *arg);
+
+/* CAN interrupt handler */
+void CO_CAN1InterruptHandler(void);
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+/* SYNC timer interrupt handler */
+void CO_SYNCtimerInterruptHandler(void);
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+/* CAN1 interrupt handler */
+void CO_CANbridgeInterruptHandler(void);
+#endif
+
+
+/* Wake mainline task from CANopen object, called from CAN RX task or RT task */
+static void wakeupMainline(void *object) {
+    (void)object;
+    xTaskNotifyGive(mainlineTask);
+}
+
+
+#if (CO_CONFIG_SYNC) & CO_CONFIG_FLAG_CALLBACK_PRE
+/* Wake RT task on SYNC reception, called from CAN RX task */
+static void wakeupRt(void *object) {
+    (void)object;
+    xTaskNotifyGive(rtTask);
+}
+#endif
+
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+/* Wake RT task after SYNC from timer, called from SYNC timer or CAN interrupt */
+static void wakeupRtFromISR(void *object) {
+    BaseType_t woken = pdFALSE;
+    (void)object;
+    vTaskNotifyGiveFromISR(rtTask, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+
+/* main ***********************************************************************/
+int main (void){
+    /* Configure microcontroller. */
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+    /* Install downloaded program, before anything else runs from flash */
+    CO_progDownload_bootSwap();
+#endif
+
+
+    /* CANopen is initialized in mainline task, other tasks are created there */
+    if (xTaskCreate(mainlineTask_thread, "CO_main", CO_RTOS_MAINLINE_STACK_SIZE,
+                    NULL, CO_RTOS_MAINLINE_PRIORITY, &mainlineTask) != pdPASS
+    ) {
+        log_printf("Error: Can't create mainline task\n");
+        return 0;
+    }
+
+    vTaskStartScheduler();
+
+    /* not reached, unless there is not enough heap for idle task */
+    log_printf("Error: Scheduler not started\n");
+    return 0;
+}
+
+
+/* mainline task, initialization and non time critical processing *************/
+static void mainlineTask_thread(void *arg){
+    CO_ReturnError_t err;
+    CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
+    uint32_t heapMemoryUsed;
+    uint32_t errInfo = 0;
+    void *CANptr = NULL; /* CAN module address */
+    uint8_t pendingNodeId = 0; /* read from dip switches or nonvolatile memory, configurable by LSS slave */
+    uint8_t activeNodeId = 0; /* Copied from CO_pendingNodeId in the communication reset section */
+    uint16_t pendingBitRate = 0;  /* read from dip switches or nonvolatile memory, configurable by LSS slave */
+
+    (void)arg;
+
+#if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
+    CO_storage_t storage;
+    CO_storage_entry_t storageEntries[] = {
+        {
+            .addr = &OD_PERSIST_COMM,
+            .len = sizeof(OD_PERSIST_COMM),
+            .subIndexOD = 2,
+            .attr = CO_storage_cmd | CO_storage_restore,
+            .addrNV = NULL
+        }
+    };
+    uint8_t storageEntriesCount = sizeof(storageEntries) / sizeof(storageEntries[0]);
+    uint32_t storageInitError = 0;
+#endif
+
+    /* Allocate memory */
+    CO_config_t *config_ptr = NULL;
+#ifdef CO_MULTIPLE_OD
+    /* example usage of CO_MULTIPLE_OD (but still single OD here) */
+    CO_config_t co_config = {0};
+    OD_INIT_CONFIG(co_config); /* helper macro from OD.h */
+    co_config.CNT_LEDS = 1;
+    co_config.CNT_LSS_SLV = 1;
+#if ((CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE) \
+    || ((CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE)
+    co_config.CNT_LSS_MST = 1;
+#endif
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+    co_config.CNT_GTWA = 1;
+#endif
+    config_ptr = &co_config;
+#endif /* CO_MULTIPLE_OD */
+    CO = CO_new(config_ptr, &heapMemoryUsed);
+    if (CO == NULL) {
+        log_printf("Error: Can't allocate memory\n");
+        vTaskDelete(NULL);
+    }
+    else {
+        log_printf("Allocated %u bytes for CANopen objects\n", heapMemoryUsed);
+    }
+
+
+#if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
+    err = CO_storageBlank_init(&storage,
+                               CO->CANmodule,
+                               OD_ENTRY_H1010_storeParameters,
+                               OD_ENTRY_H1011_restoreDefaultParameters,
+                               storageEntries,
+                               storageEntriesCount,
+                               &storageInitError);
+
+    if (err != CO_ERROR_NO && err != CO_ERROR_DATA_CORRUPT) {
+        log_printf("Error: Storage %d\n", storageInitError);
+        vTaskDelete(NULL);
+    }
+#endif
+
+    err = app_programStart(&pendingBitRate, &pendingNodeId, &errInfo);
+    if (err != CO_ERROR_NO) {
+        log_printf("Error: app_programStart: %d\n", err);
+        vTaskDelete(NULL);
+    }
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+    /* Application has no stored bitrate, bitrate of the bus is detected on
+     * the first pass */
+    bool_t detectBitRate = pendingBitRate == 0;
+    if (detectBitRate) {
+        pendingBitRate = CO_AUTO_BITRATE_DEFAULT;
+    }
+#endif
+
+
+    while(reset != CO_RESET_APP){
+/* CANopen communication reset - initialize CANopen objects *******************/
+        log_printf("CANopenNode - Reset communication...\n");
+
+        /* Wait rt_thread. */
+        CO->CANmodule->CANnormal = false;
+
+        /* Enter CAN configuration. */
+#if TARGET_NUM == 32662
+        CANptr = MXC_CAN0;
+#elif TARGET_NUM == 32690
+        CANptr = MXC_CAN0;
+#else
+#error "Unsupported target"
+#endif
+        CO_CANsetConfigurationMode((void *)&CANptr);
+        CO->CANmodule->CANptr = CANptr;
+        CO_CANmodule_disable(CO->CANmodule);
+
+        /* initialize CANopen, creates also rxQueue and odMutex */
+        err = CO_CANinit(CO, CANptr, pendingBitRate);
+        if (err != CO_ERROR_NO) {
+            log_printf("Error: CAN initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+        /* Statistics are readable from OD, if manufacturer entry exists */
+        CO_CANstats_init(&CANstats, OD_find(OD, CO_CAN_STATS_OD_INDEX),
+                         pendingBitRate);
+        CO->CANmodule->stats = &CANstats;
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+        /* Trace is accessible from OD, if manufacturer entry exists */
+        CO_CANtrace_init(&CANtrace, OD_find(OD, CO_CAN_TRACE_OD_INDEX));
+        CO->CANmodule->trace = &CANtrace;
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+        /* Self-test is started from OD, if manufacturer entry exists */
+        CO_CANselfTest_init(&CANselfTest, OD_find(OD, CO_CAN_SELFTEST_OD_INDEX));
+#endif
+
+        /* configure CAN interrupt registers. CAN interrupt uses FreeRTOS API,
+         * so its priority must not be above configMAX_SYSCALL_INTERRUPT_PRIORITY */
+        MXC_CAN_EnableInt(MXC_CAN_GET_IDX(CO->CANmodule->CANptr),
+                MXC_F_CAN_INTEN_DOR | MXC_F_CAN_INTEN_BERR
+              | MXC_F_CAN_INTEN_TX | MXC_F_CAN_INTEN_RX
+              | MXC_F_CAN_INTEN_ERPSV | MXC_F_CAN_INTEN_ERWARN
+              | MXC_F_CAN_INTEN_AL, 0);
+#if TARGET_NUM == 32662
+        NVIC_SetPriority(CAN_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+        NVIC_EnableIRQ(CAN_IRQn);
+        MXC_NVIC_SetVector(CAN_IRQn, CO_CAN1InterruptHandler);
+#elif TARGET_NUM == 32690
+        NVIC_SetPriority(CAN0_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+        NVIC_EnableIRQ(CAN0_IRQn);
+        MXC_NVIC_SetVector(CAN0_IRQn, CO_CAN1InterruptHandler);
+#else
+#error "Unsupported target"
+#endif
+
+#if (CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE
+        /* Listen to the bus, then initialize CAN again at detected bitrate or
+         * at CO_AUTO_BITRATE_DEFAULT */
+        if (detectBitRate) {
+            uint16_t bitRate = CO_CANdetectBitRate(CO->CANmodule);
+
+            detectBitRate = false;
+            if (bitRate != 0) {
+                pendingBitRate = bitRate;
+            }
+            continue;
+        }
+#endif
+
+        CO_LSS_address_t lssAddress = {.identity = {
+            .vendorID = OD_PERSIST_COMM.x1018_identity.vendor_ID,
+            .productCode = OD_PERSIST_COMM.x1018_identity.productCode,
+            .revisionNumber = OD_PERSIST_COMM.x1018_identity.revisionNumber,
+            .serialNumber = OD_PERSIST_COMM.x1018_identity.serialNumber
+        }};
+        err = CO_LSSinit(CO, &lssAddress, &pendingNodeId, &pendingBitRate);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: LSS slave initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+
+        activeNodeId = pendingNodeId;
+        uint32_t errInfo = 0;
+
+        err = CO_CANopenInit(CO,                /* CANopen object */
+                             NULL,              /* alternate NMT */
+                             NULL,              /* alternate em */
+                             OD,                /* Object dictionary */
+                             OD_STATUS_BITS,    /* Optional OD_statusBits */
+                             NMT_CONTROL,       /* CO_NMT_control_t */
+                             FIRST_HB_TIME,     /* firstHBTime_ms */
+                             SDO_SRV_TIMEOUT_TIME, /* SDOserverTimeoutTime_ms */
+                             SDO_CLI_TIMEOUT_TIME, /* SDOclientTimeoutTime_ms */
+                             SDO_CLI_BLOCK,     /* SDOclientBlockTransfer */
+                             activeNodeId,
+                             &errInfo);
+        if(err != CO_ERROR_NO && err != CO_ERROR_NODE_ID_UNCONFIGURED_LSS) {
+            if (err == CO_ERROR_OD_PARAMETERS) {
+                log_printf("Error: Object Dictionary entry 0x%X\n", errInfo);
+            }
+            else {
+                log_printf("Error: CANopen initialization failed: %d\n", err);
+            }
+            vTaskDelete(NULL);
+        }
+
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+        /* Before PDOs, which may map 0x1013 */
+        err = CO_TIMEsync_init(&TIMEsync, CO->TIME, CO->CANmodule,
+                               OD_find(OD, 0x1012), OD_find(OD, 0x1013));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: TIME synchronization initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+        err = CO_CANopenInitPDO(CO, CO->em, OD, activeNodeId, &errInfo);
+        if(err != CO_ERROR_NO) {
+            if (err == CO_ERROR_OD_PARAMETERS) {
+                log_printf("Error: Object Dictionary entry 0x%X\n", errInfo);
+            }
+            else {
+                log_printf("Error: PDO initialization failed: %d\n", err);
+            }
+            vTaskDelete(NULL);
+        }
+
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+        /* ASCII gateway on separate UART, console stays for log */
+        err = CO_gatewayUART_init(&gatewayUART, CO->gtwa);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Gateway initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+        /* Process image for the application core */
+        err = CO_mailbox_init(&mailbox, CO_MAILBOX_SHARED, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Mailbox initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+        /* Process image for app_programAsync() */
+        err = CO_procImage_init(&procImage, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Process image initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+        /* Event driven TPDOs are sent also on change of mapped data */
+        err = CO_TPDOcos_init(&TPDOcos, CO->TPDO, OD_CNT_TPDO);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: TPDO change of state initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+        /* Program download into the second flash bank, objects 0x1F50.. */
+        err = CO_progDownload_init(&progDownload, OD);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Program download initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+        /* Configure slaves after each communication reset */
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+#if OD_CNT_SDO_CLI < 2
+#error "CO_CONFIG_CFG_MGR with CO_CONFIG_GTW_UART needs two SDO clients"
+#endif
+        /* first SDO client belongs to the ASCII gateway */
+        err = CO_configManager_init(&configManager, &CO->SDOclient[1],
+                                    OD_CNT_SDO_CLI - 1);
+#else
+        err = CO_configManager_init(&configManager, CO->SDOclient, OD_CNT_SDO_CLI);
+#endif
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Configuration manager initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+        /* Heartbeats of all other nodes, 0x1016 consumer entries not needed */
+        err = CO_HBmonitor_init(&HBmonitor, CO->CANmodule, CO_HB_MON_TIME_MS,
+                                activeNodeId);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: Heartbeat monitor initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+#endif
+
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+        /* Assign node-IDs to all unconfigured slaves */
+        err = CO_LSSauto_init(&LSSauto, CO->LSSmaster, CO->NMT,
+                              OD_find(OD, 0x1016), activeNodeId);
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: LSS auto-addressing initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+        if(!CO->nodeIdUnconfigured) {
+            CO_LSSauto_start(&LSSauto);
+        }
+#endif
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+        /* SYNC producer on hardware timer, same interrupt priority as CAN */
+        err = CO_SYNCtimer_init(&SYNCtimer, CO->SYNC, CO->CANmodule,
+                                OD_find(OD, 0x1005),
+                                OD_find(OD, CO_SYNC_TMR_OD_INDEX));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: SYNC timer initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+        NVIC_SetPriority(CO_SYNC_TMR_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+        MXC_NVIC_SetVector(CO_SYNC_TMR_IRQn, CO_SYNCtimerInterruptHandler);
+        NVIC_EnableIRQ(CO_SYNC_TMR_IRQn);
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+        /* Bridge to CAN1, same interrupt priority as CAN0 */
+        err = CO_CANbridge_init(&CANbridge, CO->CANmodule, MXC_CAN1,
+                                CO_CAN_BRIDGE_BITRATE != 0
+                                ? CO_CAN_BRIDGE_BITRATE : pendingBitRate,
+                                OD_find(OD, CO_CAN_BRIDGE_OD_INDEX),
+                                OD_find(OD, CO_CAN_BRIDGE_STATS_OD_INDEX));
+        if(err != CO_ERROR_NO) {
+            log_printf("Error: CAN bridge initialization failed: %d\n", err);
+            vTaskDelete(NULL);
+        }
+        NVIC_SetPriority(CAN1_IRQn, configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY);
+        MXC_NVIC_SetVector(CAN1_IRQn, CO_CANbridgeInterruptHandler);
+        NVIC_EnableIRQ(CAN1_IRQn);
+        CO->CANmodule->bridge = &CANbridge;
+#endif
+
+        /* Create tasks on first communication reset, they wait for CANnormal */
+        if (rtTask == NULL) {
+            if (xTaskCreate(rtTask_thread, "CO_rt", CO_RTOS_RT_STACK_SIZE,
+                            NULL, CO_RTOS_RT_PRIORITY, &rtTask) != pdPASS
+                || xTaskCreate(canRxTask_thread, "CO_canRx",
+                               CO_RTOS_CANRX_STACK_SIZE, NULL,
+                               CO_RTOS_CANRX_PRIORITY, &canRxTask) != pdPASS
+            ) {
+                log_printf("Error: Can't create tasks\n");
+                vTaskDelete(NULL);
+            }
+        }
+
+        /* Configure CANopen callbacks, etc */
+        if(!CO->nodeIdUnconfigured) {
+            /* Wake mainline task, when there is something to process */
+#if (CO_CONFIG_NMT) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_NMT_initCallbackPre(CO->NMT, NULL, wakeupMainline);
+#endif
+#if (CO_CONFIG_EM) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_EM_initCallbackPre(CO->em, NULL, wakeupMainline);
+#endif
+#if (CO_CONFIG_HB_CONS) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_HBconsumer_initCallbackPre(CO->HBcons, NULL, wakeupMainline);
+#endif
+#if (CO_CONFIG_SDO_SRV) & CO_CONFIG_FLAG_CALLBACK_PRE
+            CO_SDOserver_initCallbackPre(&CO->SDOserver[0], NULL, wakeupMainline);
+#endif
+#if (CO_CONFIG_SYNC) & CO_CONFIG_FLAG_CALLBACK_PRE
+            /* SYNC is processed in RT task */
+            CO_SYNC_initCallbackPre(CO->SYNC, NULL, wakeupRt);
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+            CO_SYNCtimer_initCallbackPre(&SYNCtimer, NULL, wakeupRtFromISR);
+#endif
+
+#if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
+            if(storageInitError != 0) {
+                CO_errorReport(CO->em, CO_EM_NON_VOLATILE_MEMORY,
+                               CO_EMC_HARDWARE, storageInitError);
+            }
+#endif
+        }
+        else {
+            log_printf("CANopenNode - Node-id not initialized\n");
+        }
+#if (CO_CONFIG_LSS) & CO_CONFIG_FLAG_CALLBACK_PRE
+        CO_LSSslave_initCallbackPre(CO->LSSslave, NULL, wakeupMainline);
+#endif
+
+
+        /* start CAN */
+        CO_CANsetNormalMode(CO->CANmodule);
+
+        reset = CO_RESET_NOT;
+
+        log_printf("CANopenNode - Running...\n");
+        fflush(stdout);
+
+        uint32_t lastCall_us = CO_timer_us();
+        while(reset == CO_RESET_NOT){
+            /* loop for normal program execution ******************************************/
+            /* get time difference since last function call */
+            uint32_t now_us = CO_timer_us();
+            uint32_t timeDifference_us = now_us - lastCall_us;
+            uint32_t timerNext_us = CO_RTOS_MAINLINE_PERIOD_MS * 1000U;
+            lastCall_us = now_us;
+
+#if (CO_CONFIG_GTW_UART) & CO_CONFIG_GTW_UART_ENABLE
+            /* Received bytes are passed to the gateway before CO_process(),
+             * which processes the commands. UART is polled, so sleep at most
+             * one tick. */
+            (void)CO_gatewayUART_process(&gatewayUART);
+            if (timerNext_us > 1000U) {
+                timerNext_us = 1000U;
+            }
+#endif
+
+            /* CANopen process */
+            reset = CO_process(CO, !CO->nodeIdUnconfigured, timeDifference_us, &timerNext_us);
+
+#if (CO_CONFIG_CFG_MGR) & CO_CONFIG_CFG_MGR_ENABLE
+            if (!CO->nodeIdUnconfigured) {
+                CO_configManager_process(&configManager, &timerNext_us);
+            }
+#endif
+
+            /* Execute external application code */
+            app_programAsync(CO, timeDifference_us);
+
+#if (CO_CONFIG_CAN_STATS) & CO_CONFIG_CAN_STATS_ENABLE
+            CO_CANstats_process(&CANstats, timeDifference_us);
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+            CO_CANtrace_process(&CANtrace, CO->CANmodule);
+#endif
+#if (CO_CONFIG_CAN_SELFTEST) & CO_CONFIG_CAN_SELFTEST_ENABLE
+            CO_CANselfTest_process(&CANselfTest, CO->CANmodule, &timerNext_us);
+#endif
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+            CO_CANbridge_process(&CANbridge, timeDifference_us);
+#endif
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+            CO_progDownload_process(&progDownload);
+#endif
+#if (CO_CONFIG_HB_MON) & CO_CONFIG_HB_MON_ENABLE
+            CO_HBmonitor_process(&HBmonitor, &timerNext_us);
+#endif
+#if (CO_CONFIG_LSS_AUTO) & CO_CONFIG_LSS_AUTO_ENABLE
+            CO_LSSauto_process(&LSSauto, timeDifference_us, &timerNext_us);
+#endif
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+            CO_SYNCtimer_process(&SYNCtimer, !CO->nodeIdUnconfigured
+                                 && CO->CANmodule->CANnormal
+                                 && (CO_NMT_getInternalState(CO->NMT) == CO_NMT_PRE_OPERATIONAL
+                                     || CO_NMT_getInternalState(CO->NMT) == CO_NMT_OPERATIONAL));
+#endif
+#if (CO_CONFIG_TIME_SYNC) & CO_CONFIG_TIME_SYNC_ENABLE
+            CO_TIMEsync_process(&TIMEsync);
+#endif
+#if (CO_CONFIG_LOG) & CO_CONFIG_LOG_ENABLE
+            /* Messages from driver and interrupts, non-blocking for them */
+            CO_log_process();
+#endif
+
+            LED_red = CO_LED_RED(CO->LEDs, CO_LED_CANopen);
+            LED_green = CO_LED_GREEN(CO->LEDs, CO_LED_CANopen);
+            if (num_leds)
+                LED_green ? LED_On(0) : LED_Off(0);
+            if (num_leds > 1)
+                LED_red ? LED_On(1) : LED_Off(1);
+
+            /* Sleep until next timer event or until woken by callback */
+            if (reset == CO_RESET_NOT) {
+                ulTaskNotifyTake(pdTRUE,
+                                 pdMS_TO_TICKS((timerNext_us + 999U) / 1000U));
+            }
+        }
+    }
+
+
+    /* program exit ***************************************************************/
+    /* stop threads */
+    app_programEnd();
+
+    /* stop tasks and CAN interrupt before releasing resources */
+    CO->CANmodule->CANnormal = false;
+    if (rtTask != NULL) {
+        vTaskSuspend(rtTask);
+        vTaskSuspend(canRxTask);
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    /* delete objects from memory */
+    CO_CANsetConfigurationMode((void *)&CANptr);
+    CO_delete(CO);
+    log_printf("CANopenNode finished\n");
+
+    /* reset */
+    log_printf("Resetting...\n");
+    MXC_Delay(10000);
+    MXC_SYS_Reset_Periph(MXC_SYS_RESET0_SYS);
+    while(1);
+}
+
+
+/* microsecond time base, see CO_driver_target.h ******************************/
+uint32_t CO_timer_us(void){
+    TickType_t ticks;
+    uint32_t val;
+    bool_t wrapped;
+
+    /* SysTick is owned by FreeRTOS and generates the tick interrupt */
+    do {
+        ticks = xTaskGetTickCountFromISR();
+        val = SysTick->VAL;
+        /* SysTick reloaded, but its interrupt did not increment tick yet */
+        wrapped = (SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) != 0;
+    } while (ticks != xTaskGetTickCountFromISR());
+
+    if (wrapped && val > (SysTick->LOAD / 2U)) {
+        ticks++;
+    }
+    return (uint32_t)ticks * (1000000U / configTICK_RATE_HZ)
+         + (SysTick->LOAD - val) / (SystemCoreClock / 1000000U);
+}
+
+
+/* realtime task executes in constant intervals or after SYNC *****************/
+CO_RAMFUNC
+static void rtTask_thread(void *arg){
+    uint32_t lastCall_us = CO_timer_us();
+
+    (void)arg;
+
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CO_RTOS_RT_PERIOD_MS));
+
+        /* get time difference since last function call */
+        uint32_t now_us = CO_timer_us();
+        uint32_t timeDifference_us = now_us - lastCall_us;
+        lastCall_us = now_us;
+
+        /* Execute external application code */
+        app_peripheralRead(CO, timeDifference_us);
+
+        CO_LOCK_OD(CO->CANmodule);
+        if (!CO->nodeIdUnconfigured && CO->CANmodule->CANnormal) {
+            bool_t syncWas = false;
+
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+            /* Mainline readers repeat, if they overlap with this section */
+            CO_ODaccess_writeBegin();
+#endif
+
+#if (CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE
+            syncWas = CO_process_SYNC(CO, timeDifference_us, NULL);
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_ENABLE
+            CO_process_RPDO(CO, syncWas, timeDifference_us, NULL);
+#endif
+
+            /* Execute external application code */
+            app_programRt(CO, timeDifference_us);
+
+#if ((CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK)
+            /* Exchange process image with the application core */
+            CO_mailbox_processStack(&mailbox);
+#endif
+
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+            /* Exchange process image with app_programAsync() */
+            CO_procImage_processStack(&procImage, syncWas);
+#endif
+
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_ENABLE
+#if (CO_CONFIG_TPDO_COS) & CO_CONFIG_TPDO_COS_ENABLE
+            CO_TPDOcos_process(&TPDOcos);
+#endif
+            CO_process_TPDO(CO, syncWas, timeDifference_us, NULL);
+#endif
+
+            /* Further I/O or nonblocking application code may go here. */
+
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+            CO_ODaccess_writeEnd();
+#endif
+        }
+        CO_UNLOCK_OD(CO->CANmodule);
+
+        app_peripheralWrite(CO, timeDifference_us);
+    }
+}
+
+
+/* CAN receive task processes messages from CAN interrupt *********************/
+static void canRxTask_thread(void *arg){
+    CO_CANrxMsg_t *rcvMsg;
+
+    (void)arg;
+
+    for (;;) {
+        /* Message stays in its receive slot, only the pointer is queued */
+        if (xQueueReceive(CO->CANmodule->rxQueue, &rcvMsg, portMAX_DELAY) == pdTRUE) {
+            CO_CANrxDispatch(CO->CANmodule, rcvMsg);
+            CO_CANrxRelease(CO->CANmodule);
+        }
+    }
+}
+
+
+/* CAN interrupt function executes on received CAN message ********************/
+CO_RAMFUNC
+void CO_CAN1InterruptHandler(void){
+    /* interrupt flag cleared in MXC_CAN_Handler */
+#if TARGET_NUM == 32662
+    MXC_CAN_Handler(MXC_CAN_GET_IDX(MXC_CAN0));
+#elif TARGET_NUM == 32690
+    MXC_CAN_Handler(MXC_CAN_GET_IDX(MXC_CAN0));
+#else
+#error "Unsupported target"
+#endif
+#if (CO_CONFIG_CAN_TRACE) & CO_CONFIG_CAN_TRACE_ENABLE
+    /* Frames replayed from CAN trace */
+    CO_CANrxInjectProcess(CO->CANmodule);
+#endif
+}
+
+#if (CO_CONFIG_SYNC_TMR) & CO_CONFIG_SYNC_TMR_ENABLE
+/* SYNC timer interrupt function sends SYNC at the 0x1006 period **************/
+void CO_SYNCtimerInterruptHandler(void){
+    CO_SYNCtimer_interrupt(&SYNCtimer);
+}
+#endif
+
+#if (CO_CONFIG_CAN_BRIDGE) & CO_CONFIG_CAN_BRIDGE_ENABLE
+/* CAN1 interrupt function forwards frames between the controllers ************/
+void CO_CANbridgeInterruptHandler(void){
+    CO_CANbridge_interrupt(&CANbridge);
+}
+#endif
+
+#endif /* (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE */
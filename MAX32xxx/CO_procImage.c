@@ -0,0 +1,184 @@
+/*
+ * Triple buffered process image of PDO mapped objects, for MAX32xxx.
+ *
+ * @file        CO_procImage.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+
+#include "CO_procImage.h"
+
+
+#if (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+
+/* Buffer indexes are exchanged by the application (mainline or main task) and
+ * by the RT thread (SysTick interrupt or RT task). */
+#if (CO_CONFIG_FREERTOS) & CO_CONFIG_FREERTOS_ENABLE
+#define PROC_IMAGE_LOCK()   taskENTER_CRITICAL()
+#define PROC_IMAGE_UNLOCK() taskEXIT_CRITICAL()
+#else
+#define PROC_IMAGE_LOCK()   uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define PROC_IMAGE_UNLOCK() __set_PRIMASK(primask)
+#endif
+
+
+/* Producer: filled buffer becomes the latest */
+static void CO_procImage_produced(CO_procImage_buffers_t *b) {
+    PROC_IMAGE_LOCK();
+    uint8_t latest = b->latest;
+    b->latest = b->producer;
+    b->producer = latest;
+    b->fresh = true;
+    PROC_IMAGE_UNLOCK();
+}
+
+
+/* Consumer: take the latest buffer, if it is new */
+static bool_t CO_procImage_consume(CO_procImage_buffers_t *b) {
+    bool_t fresh;
+
+    PROC_IMAGE_LOCK();
+    fresh = b->fresh;
+    if (fresh) {
+        uint8_t latest = b->latest;
+        b->latest = b->consumer;
+        b->consumer = latest;
+        b->fresh = false;
+    }
+    PROC_IMAGE_UNLOCK();
+    return fresh;
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_procImage_init(CO_procImage_t *pi, OD_t *od) {
+    uint16_t offset = 0;
+
+    /* verify arguments */
+    if (pi == NULL || od == NULL
+        || CO_procImageEntriesCount > CO_PROC_IMAGE_ENTRIES_MAX
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(pi, 0, sizeof(CO_procImage_t));
+
+    for (uint8_t i = 0; i < CO_procImageEntriesCount; i++) {
+        const CO_procImage_entry_t *e = &CO_procImageEntries[i];
+
+        pi->OD_entries[i] = OD_find(od, e->index);
+        if (pi->OD_entries[i] == NULL || e->len == 0U || e->len > 8U
+            || (offset + e->len) > CO_PROC_IMAGE_SIZE
+        ) {
+            return CO_ERROR_OD_PARAMETERS;
+        }
+        pi->offset[i] = offset;
+        /* values from OD (or its defaults), so nothing is overwritten by
+         * the first image */
+        OD_get_value(pi->OD_entries[i], e->subIndex,
+                     &pi->appOut[offset], e->len, true);
+        offset += e->len;
+    }
+
+    for (uint8_t i = 0; i < 3U; i++) {
+        memcpy(pi->toStack.buf[i], pi->appOut, CO_PROC_IMAGE_SIZE);
+        memcpy(pi->toApp.buf[i], pi->appOut, CO_PROC_IMAGE_SIZE);
+    }
+    pi->toStack.producer = pi->toApp.producer = 0;
+    pi->toStack.latest = pi->toApp.latest = 1;
+    pi->toStack.consumer = pi->toApp.consumer = 2;
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_procImage_processStack(CO_procImage_t *pi, bool_t syncWas) {
+    if (CO_PROC_IMAGE_ON_SYNC && !syncWas) {
+        return;
+    }
+
+    /* image from application, before TPDOs are processed */
+    if (CO_procImage_consume(&pi->toStack)) {
+        const uint8_t *buf = pi->toStack.buf[pi->toStack.consumer];
+
+        for (uint8_t i = 0; i < CO_procImageEntriesCount; i++) {
+            const CO_procImage_entry_t *e = &CO_procImageEntries[i];
+
+            if (e->toApp == CO_PROC_IMAGE_TO_STACK) {
+                OD_set_value(pi->OD_entries[i], e->subIndex,
+                             (void *)&buf[pi->offset[i]], e->len, true);
+            }
+        }
+        pi->toStackCount++;
+    }
+
+    /* image for application, after RPDOs are processed */
+    uint8_t *buf = pi->toApp.buf[pi->toApp.producer];
+
+    for (uint8_t i = 0; i < CO_procImageEntriesCount; i++) {
+        const CO_procImage_entry_t *e = &CO_procImageEntries[i];
+
+        if (e->toApp == CO_PROC_IMAGE_TO_APP) {
+            OD_get_value(pi->OD_entries[i], e->subIndex,
+                         &buf[pi->offset[i]], e->len, true);
+        }
+    }
+    CO_procImage_produced(&pi->toApp);
+    pi->toAppCount++;
+}
+
+
+/******************************************************************************/
+bool_t CO_procImage_fetch(CO_procImage_t *pi) {
+    return CO_procImage_consume(&pi->toApp);
+}
+
+
+/******************************************************************************/
+void CO_procImage_read(CO_procImage_t *pi, uint8_t entry, void *buf) {
+    if (entry < CO_procImageEntriesCount) {
+        memcpy(buf, &pi->toApp.buf[pi->toApp.consumer][pi->offset[entry]],
+               CO_procImageEntries[entry].len);
+    }
+}
+
+
+/******************************************************************************/
+void CO_procImage_write(CO_procImage_t *pi, uint8_t entry, const void *buf) {
+    if (entry < CO_procImageEntriesCount) {
+        memcpy(&pi->appOut[pi->offset[entry]], buf,
+               CO_procImageEntries[entry].len);
+    }
+}
+
+
+/******************************************************************************/
+void CO_procImage_publish(CO_procImage_t *pi) {
+    /* producer buffer is owned by the application, copy needs no lock */
+    memcpy(pi->toStack.buf[pi->toStack.producer], pi->appOut,
+           CO_PROC_IMAGE_SIZE);
+    CO_procImage_produced(&pi->toStack);
+}
+
+#endif /* (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE */
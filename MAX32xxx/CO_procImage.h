@@ -0,0 +1,199 @@
+/*
+ * Triple buffered process image of PDO mapped objects, for MAX32xxx.
+ *
+ * @file        CO_procImage.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_PROC_IMAGE_H
+#define CO_PROC_IMAGE_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Process image for app_programAsync(), so it does not need CO_LOCK_OD() for
+ * PDO mapped objects. Objects are listed in CO_procImageEntries.
+ *
+ * Each direction has three buffers: one is owned by the producer, one by the
+ * consumer and one holds the latest complete image. Producer fills its buffer
+ * and exchanges it with the latest one, consumer exchanges its buffer with the
+ * latest one, if there is a new one. Only buffer indexes are exchanged inside
+ * a short critical section, so neither side waits for the other.
+ *
+ * The RT thread, with OD locked, takes the latest image from the application
+ * and writes it into OD before TPDOs, and publishes values of RPDO mapped
+ * objects to the application. If CO_PROC_IMAGE_ON_SYNC is set, this is done
+ * only in RT cycles with SYNC, so synchronous PDOs of one SYNC cycle see one
+ * image.
+ */
+
+/* Size of the image in bytes, sum of all CO_procImageEntries lengths. */
+#ifndef CO_PROC_IMAGE_SIZE
+#define CO_PROC_IMAGE_SIZE 64
+#endif
+/* Maximum number of objects in the process image. */
+#ifndef CO_PROC_IMAGE_ENTRIES_MAX
+#define CO_PROC_IMAGE_ENTRIES_MAX 32
+#endif
+/* Exchange the image only in RT cycles with SYNC. */
+#ifndef CO_PROC_IMAGE_ON_SYNC
+#define CO_PROC_IMAGE_ON_SYNC 0
+#endif
+
+/** Direction of process image object, CO_procImage_entry_t.toApp */
+#define CO_PROC_IMAGE_TO_STACK 0U  /* application writes, mapped to TPDO */
+#define CO_PROC_IMAGE_TO_APP   1U  /* stack writes, mapped to RPDO */
+
+/**
+ * Process image object, OD variable mapped to PDO.
+ */
+typedef struct {
+    uint16_t index;
+    uint8_t subIndex;
+    /** Size of the variable, 1 to 8 bytes */
+    uint8_t len;
+    /** CO_PROC_IMAGE_TO_APP or CO_PROC_IMAGE_TO_STACK */
+    uint8_t toApp;
+} CO_procImage_entry_t;
+
+/**
+ * List of process image objects, provided by application. Position in the
+ * list identifies the object in CO_procImage_read() and CO_procImage_write().
+ */
+extern const CO_procImage_entry_t CO_procImageEntries[];
+extern const uint8_t CO_procImageEntriesCount;
+
+/**
+ * Three buffers of one direction.
+ */
+typedef struct {
+    uint8_t buf[3][CO_PROC_IMAGE_SIZE];
+    /** Buffer indexes, exchanged in critical section */
+    uint8_t producer;
+    uint8_t latest;
+    uint8_t consumer;
+    /** Latest buffer was not yet taken by consumer */
+    bool_t fresh;
+} CO_procImage_buffers_t;
+
+/**
+ * Process image object.
+ */
+typedef struct {
+    /** OD entries of process image objects */
+    OD_entry_t *OD_entries[CO_PROC_IMAGE_ENTRIES_MAX];
+    /** Offset of each object in buffers */
+    uint16_t offset[CO_PROC_IMAGE_ENTRIES_MAX];
+    /** Application writes, RT thread reads */
+    CO_procImage_buffers_t toStack;
+    /** RT thread writes, application reads */
+    CO_procImage_buffers_t toApp;
+    /** Application side image, written by CO_procImage_write() */
+    uint8_t appOut[CO_PROC_IMAGE_SIZE];
+    /** Number of images written into OD and published to the application */
+    uint32_t toStackCount;
+    uint32_t toAppCount;
+} CO_procImage_t;
+
+/** Process image object of the main file */
+extern CO_procImage_t procImage;
+
+
+/**
+ * Initialize process image object. All buffers are filled from OD. Called
+ * after CO_CANopenInitPDO().
+ *
+ * @param pi This object will be initialized.
+ * @param od Object Dictionary.
+ *
+ * @return CO_ERROR_NO, CO_ERROR_ILLEGAL_ARGUMENT or CO_ERROR_OD_PARAMETERS, if
+ * process image object does not exist in OD or image is too large.
+ */
+CO_ReturnError_t CO_procImage_init(CO_procImage_t *pi, OD_t *od);
+
+
+/**
+ * Exchange the process image on the stack side. New image from the
+ * application is written into OD, values of CO_PROC_IMAGE_TO_APP objects are
+ * published to the application. Called from RT thread between RPDO and TPDO
+ * processing, with OD locked.
+ *
+ * @param pi Process image object.
+ * @param syncWas True, if SYNC was processed in this RT cycle.
+ */
+void CO_procImage_processStack(CO_procImage_t *pi, bool_t syncWas);
+
+
+/**
+ * Take the latest image published by the RT thread, if there is a new one.
+ * Called from application, for example at the start of app_programAsync().
+ *
+ * @param pi Process image object.
+ *
+ * @return True, if image was updated.
+ */
+bool_t CO_procImage_fetch(CO_procImage_t *pi);
+
+
+/**
+ * Read CO_PROC_IMAGE_TO_APP object from the image taken by
+ * CO_procImage_fetch().
+ *
+ * @param pi Process image object.
+ * @param entry Position in CO_procImageEntries.
+ * @param [out] buf Buffer of CO_procImageEntries[entry].len bytes.
+ */
+void CO_procImage_read(CO_procImage_t *pi, uint8_t entry, void *buf);
+
+
+/**
+ * Write CO_PROC_IMAGE_TO_STACK object into the application side image. It is
+ * passed to the RT thread by CO_procImage_publish().
+ *
+ * @param pi Process image object.
+ * @param entry Position in CO_procImageEntries.
+ * @param buf Buffer of CO_procImageEntries[entry].len bytes.
+ */
+void CO_procImage_write(CO_procImage_t *pi, uint8_t entry, const void *buf);
+
+
+/**
+ * Pass the application side image to the RT thread, which writes it into OD
+ * in its next (SYNC) cycle. Objects written since the previous call become
+ * visible to PDOs together.
+ *
+ * @param pi Process image object.
+ */
+void CO_procImage_publish(CO_procImage_t *pi);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE */
+
+#endif /* CO_PROC_IMAGE_H */
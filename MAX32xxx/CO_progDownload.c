@@ -0,0 +1,417 @@
+/*
+ * CiA 302 program download for MAX32xxx.
+ *
+ * @file        CO_progDownload.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "mxc_device.h"
+#include "flc.h"
+
+#include "CO_progDownload.h"
+#include "CO_log.h"
+#include "301/crc16-ccitt.h"
+
+
+#if (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE
+
+/* Time for SDO response of the start command, before reset */
+#define CO_PROG_RESET_DELAY_US 100000UL
+
+/* CiA 302 program control commands, 0x1F51 */
+#define CO_PROG_CMD_STOP  0U
+#define CO_PROG_CMD_START 1U
+#define CO_PROG_CMD_RESET 2U
+#define CO_PROG_CMD_CLEAR 3U
+
+#define TRAILER ((const CO_progDownload_trailer_t *)CO_PROG_TRAILER_ADDR)
+
+/* MSDK linker files: code and constants end at _etext, followed by the
+ * initial values of .data, which startup code copies to _data.._edata */
+extern uint32_t _etext;
+extern uint32_t _data;
+extern uint32_t _edata;
+
+
+/* Write buffer into the slot, erase pages in front of it first */
+static bool_t CO_progDownload_flush(CO_progDownload_t *pd) {
+    uint32_t addr = CO_PROG_SLOT_ADDR + pd->size;
+    uint32_t len = pd->bufLen;
+
+    if (len == 0U) {
+        return true;
+    }
+    /* partial flash word at the end of the image */
+    while ((len % 16U) != 0U) {
+        pd->buf[len++] = 0xFFU;
+    }
+    if ((addr + len) > CO_PROG_TRAILER_ADDR) {
+        pd->error = CO_PROG_ERR_ADDRESS;
+        return false;
+    }
+    while (pd->erasedTo < (addr + len)) {
+        if (MXC_FLC_PageErase(pd->erasedTo) != E_NO_ERROR) {
+            pd->error = CO_PROG_ERR_WRITE;
+            return false;
+        }
+        pd->erasedTo += MXC_FLASH_PAGE_SIZE;
+    }
+    if (MXC_FLC_Write(addr, len, (uint32_t *)pd->buf) != E_NO_ERROR) {
+        pd->error = CO_PROG_ERR_WRITE;
+        return false;
+    }
+    pd->size += pd->bufLen;
+    pd->bufLen = 0;
+    return true;
+}
+
+
+/* Verify image in the slot and mark it pending, image is then installed by
+ * CO_progDownload_bootSwap() after reset */
+static bool_t CO_progDownload_start(CO_progDownload_t *pd) {
+    CO_progDownload_trailer_t trailer = {
+        .magic = CO_PROG_MAGIC,
+        .size = pd->size,
+        .crc = pd->crc,
+        .state = CO_PROG_PENDING
+    };
+
+    if (!pd->cleared || pd->size == 0U) {
+        pd->error = CO_PROG_ERR_NO_PROGRAM;
+        return false;
+    }
+    /* read back, CRC during download was calculated from received data */
+    if (crc16_ccitt((const uint8_t *)CO_PROG_SLOT_ADDR, pd->size, 0)
+        != pd->crc
+    ) {
+        pd->error = CO_PROG_ERR_FORMAT;
+        return false;
+    }
+    if (MXC_FLC_PageErase(CO_PROG_TRAILER_ADDR) != E_NO_ERROR
+        || MXC_FLC_Write(CO_PROG_TRAILER_ADDR, sizeof(trailer),
+                         (uint32_t *)&trailer) != E_NO_ERROR
+    ) {
+        pd->error = CO_PROG_ERR_WRITE;
+        return false;
+    }
+    return true;
+}
+
+
+/*
+ * Custom function for writing OD object "Program data" (0x1F50). Segments
+ * are written to flash as they arrive.
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_write_1F50(OD_stream_t *stream, const void *buf,
+                           OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex != 1) {
+        return OD_writeOriginal(stream, buf, count, countWritten);
+    }
+
+    CO_progDownload_t *pd = (CO_progDownload_t *)stream->object;
+    const uint8_t *data = (const uint8_t *)buf;
+
+    /* New SDO download starts with dataOffset 0 */
+    if (stream->dataOffset == 0) {
+        if (!pd->cleared || pd->size != 0U || pd->bufLen != 0U) {
+            pd->error = CO_PROG_ERR_NOT_CLEARED;
+            return ODR_DATA_DEV_STATE;
+        }
+        pd->inProgress = true;
+        pd->start_us = CO_timer_us();
+    }
+
+    pd->crc = crc16_ccitt(data, count, pd->crc);
+    for (OD_size_t n = 0; n < count; ) {
+        OD_size_t len = CO_PROG_WRITE_SIZE - pd->bufLen;
+        if (len > (count - n)) {
+            len = count - n;
+        }
+        memcpy(&pd->buf[pd->bufLen], &data[n], len);
+        pd->bufLen += len;
+        n += len;
+        if (pd->bufLen == CO_PROG_WRITE_SIZE && !CO_progDownload_flush(pd)) {
+            pd->inProgress = false;
+            return ODR_HW;
+        }
+    }
+
+    stream->dataOffset += count;
+    *countWritten = count;
+
+    /* SDO server sets dataLength of DOMAIN with the last segment */
+    if (stream->dataLength == 0 || stream->dataOffset < stream->dataLength) {
+        return ODR_PARTIAL;
+    }
+
+    pd->inProgress = false;
+    stream->dataOffset = 0;
+    if (!CO_progDownload_flush(pd)) {
+        return ODR_HW;
+    }
+    pd->time_us = CO_timer_us() - pd->start_us;
+    CO_LOG(CO_LOG_PROG_DOWNLOADED, pd->size, pd->time_us / 1000U);
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for writing OD object "Program control" (0x1F51)
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_write_1F51(OD_stream_t *stream, const void *buf,
+                           OD_size_t count, OD_size_t *countWritten)
+{
+    if (stream == NULL || buf == NULL || countWritten == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex != 1) {
+        return OD_writeOriginal(stream, buf, count, countWritten);
+    }
+    if (count != 1) {
+        return ODR_TYPE_MISMATCH;
+    }
+
+    CO_progDownload_t *pd = (CO_progDownload_t *)stream->object;
+
+    switch (*(const uint8_t *)buf) {
+    case CO_PROG_CMD_STOP:
+        break;
+    case CO_PROG_CMD_CLEAR:
+        /* Pages are erased during download, only trailer here, so command
+         * is fast enough for SDO timeout */
+        pd->size = 0;
+        pd->bufLen = 0;
+        pd->crc = 0;
+        pd->erasedTo = CO_PROG_SLOT_ADDR;
+        pd->error = CO_PROG_ERR_NONE;
+        pd->inProgress = false;
+        pd->cleared = MXC_FLC_PageErase(CO_PROG_TRAILER_ADDR) == E_NO_ERROR;
+        if (!pd->cleared) {
+            pd->error = CO_PROG_ERR_WRITE;
+            return ODR_HW;
+        }
+        break;
+    case CO_PROG_CMD_START:
+        if (!CO_progDownload_start(pd)) {
+            return ODR_DATA_DEV_STATE;
+        }
+        /* fall through */
+    case CO_PROG_CMD_RESET:
+        pd->resetPending = true;
+        pd->reset_us = CO_timer_us();
+        break;
+    default:
+        return ODR_INVALID_VALUE;
+    }
+
+    *countWritten = count;
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for reading OD object "Program control" (0x1F51). Program
+ * is running, when this is read.
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_1F51(OD_stream_t *stream, void *buf,
+                          OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex != 1) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < 1U) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    *(uint8_t *)buf = CO_PROG_CMD_START;
+    *countRead = 1;
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for reading OD object "Program software identification"
+ * (0x1F56), CRC of the installed image.
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_1F56(OD_stream_t *stream, void *buf,
+                          OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex != 1) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_progDownload_t *pd = (CO_progDownload_t *)stream->object;
+    *countRead = CO_setUint32(buf, pd->installedCrc);
+    return ODR_OK;
+}
+
+
+/*
+ * Custom function for reading OD object "Flash status identification"
+ * (0x1F57)
+ *
+ * For more information see file CO_ODinterface.h, OD_IO_t.
+ */
+static ODR_t OD_read_1F57(OD_stream_t *stream, void *buf,
+                          OD_size_t count, OD_size_t *countRead)
+{
+    if (stream == NULL || buf == NULL || countRead == NULL) {
+        return ODR_DEV_INCOMPAT;
+    }
+    if (stream->subIndex != 1) {
+        return OD_readOriginal(stream, buf, count, countRead);
+    }
+    if (count < sizeof(uint32_t)) {
+        return ODR_DEV_INCOMPAT;
+    }
+
+    CO_progDownload_t *pd = (CO_progDownload_t *)stream->object;
+    uint32_t status = ((uint32_t)pd->error << 1) | (pd->inProgress ? 1U : 0U);
+    *countRead = CO_setUint32(buf, status);
+    return ODR_OK;
+}
+
+
+/******************************************************************************/
+/* Application flash is overwritten here, so only RAM code (flash controller
+ * driver is in .flashprog) and inline functions may be called after copy
+ * starts. */
+__attribute__((section(".flashprog"), noinline))
+void CO_progDownload_bootSwap(void) {
+    const CO_progDownload_trailer_t *t = TRAILER;
+
+    if (t->magic != CO_PROG_MAGIC || t->state != CO_PROG_PENDING
+        || t->size == 0U || t->size > (CO_PROG_SLOT_SIZE - MXC_FLASH_PAGE_SIZE)
+        || crc16_ccitt((const uint8_t *)CO_PROG_SLOT_ADDR, t->size, 0) != t->crc
+    ) {
+        return;
+    }
+
+    CO_progDownload_trailer_t trailer = *t;
+    trailer.state = CO_PROG_INSTALLED;
+
+    __disable_irq();
+    for (uint32_t off = 0; off < trailer.size; off += MXC_FLASH_PAGE_SIZE) {
+        uint32_t len = trailer.size - off;
+        if (len > MXC_FLASH_PAGE_SIZE) {
+            len = MXC_FLASH_PAGE_SIZE;
+        }
+        len = (len + 15U) & ~15UL;
+        MXC_FLC_PageErase(CO_PROG_APP_ADDR + off);
+        MXC_FLC_Write(CO_PROG_APP_ADDR + off, len,
+                      (uint32_t *)(CO_PROG_SLOT_ADDR + off));
+    }
+    MXC_FLC_PageErase(CO_PROG_TRAILER_ADDR);
+    MXC_FLC_Write(CO_PROG_TRAILER_ADDR, sizeof(trailer), (uint32_t *)&trailer);
+
+    NVIC_SystemReset();
+}
+
+
+/******************************************************************************/
+CO_ReturnError_t CO_progDownload_init(CO_progDownload_t *pd, OD_t *OD) {
+    OD_entry_t *entry;
+
+    /* verify arguments */
+    if (pd == NULL || OD == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    /* download must not overwrite the running image */
+    uint32_t imageEnd = (uint32_t)(uintptr_t)&_etext
+                      + (uint32_t)((uintptr_t)&_edata - (uintptr_t)&_data);
+    if (imageEnd > CO_PROG_SLOT_ADDR
+        && CO_PROG_APP_ADDR < (CO_PROG_SLOT_ADDR + CO_PROG_SLOT_SIZE)
+    ) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    memset(pd, 0, sizeof(CO_progDownload_t));
+    if (TRAILER->magic == CO_PROG_MAGIC && TRAILER->state == CO_PROG_INSTALLED) {
+        pd->installedCrc = TRAILER->crc;
+    }
+
+    entry = OD_find(OD, 0x1F50);
+    if (entry != NULL) {
+        pd->OD_1F50_ext.object = pd;
+        pd->OD_1F50_ext.read = OD_readOriginal;
+        pd->OD_1F50_ext.write = OD_write_1F50;
+        OD_extension_init(entry, &pd->OD_1F50_ext);
+    }
+    entry = OD_find(OD, 0x1F51);
+    if (entry != NULL) {
+        pd->OD_1F51_ext.object = pd;
+        pd->OD_1F51_ext.read = OD_read_1F51;
+        pd->OD_1F51_ext.write = OD_write_1F51;
+        OD_extension_init(entry, &pd->OD_1F51_ext);
+    }
+    entry = OD_find(OD, 0x1F56);
+    if (entry != NULL) {
+        pd->OD_1F56_ext.object = pd;
+        pd->OD_1F56_ext.read = OD_read_1F56;
+        pd->OD_1F56_ext.write = NULL;
+        OD_extension_init(entry, &pd->OD_1F56_ext);
+    }
+    entry = OD_find(OD, 0x1F57);
+    if (entry != NULL) {
+        pd->OD_1F57_ext.object = pd;
+        pd->OD_1F57_ext.read = OD_read_1F57;
+        pd->OD_1F57_ext.write = NULL;
+        OD_extension_init(entry, &pd->OD_1F57_ext);
+    }
+
+    return CO_ERROR_NO;
+}
+
+
+/******************************************************************************/
+void CO_progDownload_process(CO_progDownload_t *pd) {
+    if (pd->resetPending
+        && (CO_timer_us() - pd->reset_us) > CO_PROG_RESET_DELAY_US
+    ) {
+        /* CO_progDownload_bootSwap() installs pending image */
+        NVIC_SystemReset();
+    }
+}
+
+#endif /* (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE */
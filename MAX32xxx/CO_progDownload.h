@@ -0,0 +1,164 @@
+/*
+ * CiA 302 program download for MAX32xxx.
+ *
+ * @file        CO_progDownload.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_PROG_DOWNLOAD_H
+#define CO_PROG_DOWNLOAD_H
+
+#include "301/CO_driver.h"
+#include "301/CO_ODinterface.h"
+
+#if ((CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE) || defined CO_DOXYGEN
+
+#include "flc.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Program download (CiA 302-3):
+ * - 0x1F51 sub1 = 3 (clear): prepare download slot.
+ * - 0x1F50 sub1 (DOMAIN): binary image, preferably by SDO block transfer. Data
+ *   is written to flash directly from SDO segments, CRC is calculated on the
+ *   fly, no RAM buffer for the image is used.
+ * - 0x1F51 sub1 = 1 (start): image is verified and marked pending, device
+ *   resets. CO_progDownload_bootSwap() then copies the image over the running
+ *   application.
+ * - 0x1F56 sub1: CRC-16 of the installed image (program software id).
+ * - 0x1F57 sub1: flash status, bit 0 = in progress, bits 1..7 = error code.
+ */
+
+/* Download slot, default is the upper half of flash. On parts with two flash
+ * banks this is the bank not used by the application, so the CPU is not
+ * stalled by erase and write. Single-bank parts, like MAX32662, stall the CPU
+ * and interrupts executed from flash during each page erase and write. Last
+ * page of the slot holds the trailer. Running image must end below the slot,
+ * this is verified in CO_progDownload_init(). */
+#ifndef CO_PROG_SLOT_ADDR
+#define CO_PROG_SLOT_ADDR (MXC_FLASH_MEM_BASE + MXC_FLASH_MEM_SIZE / 2U)
+#endif
+#ifndef CO_PROG_SLOT_SIZE
+#define CO_PROG_SLOT_SIZE (MXC_FLASH_MEM_SIZE / 2U)
+#endif
+/* Address of the application, where image is installed */
+#ifndef CO_PROG_APP_ADDR
+#define CO_PROG_APP_ADDR MXC_FLASH_MEM_BASE
+#endif
+/* Size of flash write buffer, multiple of 16 (128-bit flash word) */
+#ifndef CO_PROG_WRITE_SIZE
+#define CO_PROG_WRITE_SIZE 512
+#endif
+
+#define CO_PROG_TRAILER_ADDR (CO_PROG_SLOT_ADDR + CO_PROG_SLOT_SIZE - MXC_FLASH_PAGE_SIZE)
+#define CO_PROG_MAGIC 0x434F5044UL
+#define CO_PROG_PENDING 0x50454E44UL    /* verified, to be installed */
+#define CO_PROG_INSTALLED 0x494E5354UL  /* copied to application */
+
+/** Flash status error codes, 0x1F57 bits 1..7 (CiA 302-3) */
+#define CO_PROG_ERR_NONE        0U
+#define CO_PROG_ERR_NO_PROGRAM  1U
+#define CO_PROG_ERR_FORMAT      3U
+#define CO_PROG_ERR_NOT_CLEARED 4U
+#define CO_PROG_ERR_WRITE       5U
+#define CO_PROG_ERR_ADDRESS     6U
+
+/**
+ * Trailer in the last page of the download slot, one 128-bit flash word.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t state;
+} CO_progDownload_trailer_t;
+
+/**
+ * Program download object.
+ */
+typedef struct {
+    /** Bytes of the image written into the slot */
+    uint32_t size;
+    /** Flash below this address in the slot is erased */
+    uint32_t erasedTo;
+    uint16_t crc;
+    /** Passed to MXC_FLC_Write() as words */
+    uint8_t buf[CO_PROG_WRITE_SIZE] __attribute__((aligned(4)));
+    uint16_t bufLen;
+    uint8_t error;
+    bool_t cleared;
+    bool_t inProgress;
+    /** Duration of the last download, for throughput (size / time) */
+    uint32_t start_us;
+    uint32_t time_us;
+    /** CRC of the installed image, 0x1F56 */
+    uint32_t installedCrc;
+    bool_t resetPending;
+    uint32_t reset_us;
+    OD_extension_t OD_1F50_ext;
+    OD_extension_t OD_1F51_ext;
+    OD_extension_t OD_1F56_ext;
+    OD_extension_t OD_1F57_ext;
+} CO_progDownload_t;
+
+
+/**
+ * Install pending image. Called first in main(), before any peripheral is
+ * initialized. If download slot holds a verified image marked pending, it is
+ * copied over the application and device is reset. Runs from RAM.
+ *
+ * @warning Power loss during copy leaves the application incomplete. Pending
+ * image is kept in the slot until installed, but recovery then requires a
+ * debugger or the ROM bootloader.
+ */
+void CO_progDownload_bootSwap(void);
+
+
+/**
+ * Initialize program download object and OD extensions for 0x1F50, 0x1F51,
+ * 0x1F56 and 0x1F57. Missing OD entries are ignored.
+ *
+ * @param pd This object will be initialized.
+ * @param OD Object Dictionary.
+ *
+ * @return CO_ERROR_NO or CO_ERROR_ILLEGAL_ARGUMENT, also if the running image
+ * (linker symbols _etext, _data and _edata) overlaps the download slot.
+ */
+CO_ReturnError_t CO_progDownload_init(CO_progDownload_t *pd, OD_t *OD);
+
+
+/**
+ * Process program download: reset device, after started image was verified
+ * and SDO response was sent. Called cyclically from mainline.
+ *
+ * @param pd Program download object.
+ */
+void CO_progDownload_process(CO_progDownload_t *pd);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_PROG_DOWNLOAD) & CO_CONFIG_PROG_DOWNLOAD_ENABLE */
+
+#endif /* CO_PROG_DOWNLOAD_H */
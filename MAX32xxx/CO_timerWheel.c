@@ -0,0 +1,167 @@
+/*
+ * Hierarchical timer wheel for mainline deadlines, for MAX32xxx.
+ *
+ * @file        CO_timerWheel.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_timerWheel.h"
+
+
+#if (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE
+
+#define SLOT_BITS 6U
+#define SLOT_MASK (CO_TIMER_WHEEL_SLOTS - 1U)
+#define SLOT_BIT(slot) (1ULL << (slot))
+
+/* Add timer to the slot of its expiry time */
+static void CO_timerWheel_insert(CO_timerWheel_t *wheel,
+                                 CO_timerWheel_timer_t *timer)
+{
+    uint32_t delta = timer->expires - wheel->now;
+    uint8_t level = 0;
+    uint8_t slot;
+
+    if (delta < CO_TIMER_WHEEL_SLOTS) {
+        slot = (uint8_t)(timer->expires & SLOT_MASK);
+    }
+    else {
+        level = 1;
+        slot = (uint8_t)((timer->expires >> SLOT_BITS) & SLOT_MASK);
+    }
+
+    timer->level = level;
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = wheel->slot[level][slot];
+    if (timer->next != NULL) {
+        timer->next->prev = timer;
+    }
+    wheel->slot[level][slot] = timer;
+    wheel->used[level] |= SLOT_BIT(slot);
+    timer->active = true;
+}
+
+
+/* Remove timer from its slot */
+static void CO_timerWheel_remove(CO_timerWheel_t *wheel,
+                                 CO_timerWheel_timer_t *timer)
+{
+    if (timer->prev != NULL) {
+        timer->prev->next = timer->next;
+    }
+    else {
+        wheel->slot[timer->level][timer->slot] = timer->next;
+        if (timer->next == NULL) {
+            wheel->used[timer->level] &= ~SLOT_BIT(timer->slot);
+        }
+    }
+    if (timer->next != NULL) {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+    timer->active = false;
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_init(CO_timerWheel_t *wheel, uint32_t now_ms) {
+    memset(wheel, 0, sizeof(CO_timerWheel_t));
+    wheel->now = now_ms;
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_initTimer(CO_timerWheel_timer_t *timer,
+                             void (*callback)(void *object),
+                             void *object)
+{
+    memset(timer, 0, sizeof(CO_timerWheel_timer_t));
+    timer->callback = callback;
+    timer->object = object;
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_start(CO_timerWheel_t *wheel,
+                         CO_timerWheel_timer_t *timer,
+                         uint32_t delay_us)
+{
+    uint32_t delay_ms = delay_us / 1000U + ((delay_us % 1000U) != 0U ? 1U : 0U);
+
+    if (delay_ms == 0U) {
+        delay_ms = 1;
+    }
+    else if (delay_ms > CO_TIMER_WHEEL_MAX_MS) {
+        delay_ms = CO_TIMER_WHEEL_MAX_MS;
+    }
+
+    if (timer->active) {
+        CO_timerWheel_remove(wheel, timer);
+    }
+    timer->expires = wheel->now + delay_ms;
+    CO_timerWheel_insert(wheel, timer);
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_stop(CO_timerWheel_t *wheel, CO_timerWheel_timer_t *timer) {
+    if (timer->active) {
+        CO_timerWheel_remove(wheel, timer);
+    }
+}
+
+
+/******************************************************************************/
+void CO_timerWheel_advance(CO_timerWheel_t *wheel, uint32_t now_ms) {
+    while (wheel->now != now_ms) {
+        CO_timerWheel_timer_t *timer;
+
+        if (wheel->used[0] == 0U && wheel->used[1] == 0U) {
+            wheel->now = now_ms;
+            break;
+        }
+
+        wheel->now++;
+        uint8_t slot = (uint8_t)(wheel->now & SLOT_MASK);
+
+        /* next 64 ms: move timers from the second level */
+        if (slot == 0U) {
+            uint8_t slot1 = (uint8_t)((wheel->now >> SLOT_BITS) & SLOT_MASK);
+
+            while ((timer = wheel->slot[1][slot1]) != NULL) {
+                CO_timerWheel_remove(wheel, timer);
+                CO_timerWheel_insert(wheel, timer);
+            }
+        }
+
+        /* callback may start timers, but never into the current slot */
+        while ((timer = wheel->slot[0][slot]) != NULL) {
+            CO_timerWheel_remove(wheel, timer);
+            wheel->fired++;
+            timer->callback(timer->object);
+        }
+    }
+}
+
+#endif /* (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE */
@@ -0,0 +1,149 @@
+/*
+ * Hierarchical timer wheel for mainline deadlines, for MAX32xxx.
+ *
+ * @file        CO_timerWheel.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_TIMER_WHEEL_H
+#define CO_TIMER_WHEEL_H
+
+#include "301/CO_driver.h"
+
+#if ((CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE) || defined CO_DOXYGEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Services in the bare-metal mainline register their next deadline (their
+ * timerNext_us) in the wheel, and are processed only when it expires, or when
+ * a CANopen object signals a received message. CO_process() thus is not called
+ * in each 1 ms tick, only when any of its timers is due.
+ *
+ * Wheel has two levels of 64 slots: 1 ms slots for the next 64 ms and 64 ms
+ * slots up to about 4 s. Timers of the 64 ms slot are moved to 1 ms slots,
+ * when their slot is reached. A tick touches one slot of each level, so its
+ * cost does not depend on the number of timers. Longer deadlines are
+ * shortened, service is then processed earlier and sets its timer again.
+ *
+ * Wheel is used from mainline only, objects in interrupts signal with flags.
+ */
+
+/* Number of slots in each level, 1 ms slots in the first one. */
+#define CO_TIMER_WHEEL_SLOTS 64U
+/* Longest deadline in milliseconds. */
+#define CO_TIMER_WHEEL_MAX_MS (CO_TIMER_WHEEL_SLOTS * CO_TIMER_WHEEL_SLOTS - 1U)
+/* Deadline of service without own deadline, as safety poll. */
+#ifndef CO_TIMER_WHEEL_IDLE_US
+#define CO_TIMER_WHEEL_IDLE_US 100000
+#endif
+
+/**
+ * Timer, member of the service object.
+ */
+typedef struct CO_timerWheel_timer {
+    struct CO_timerWheel_timer *next;
+    struct CO_timerWheel_timer *prev;
+    /** Expiry time in milliseconds */
+    uint32_t expires;
+    /** Timer is in the wheel, at slot[level][slot] */
+    bool_t active;
+    uint8_t level;
+    uint8_t slot;
+    /** Called from CO_timerWheel_advance() on expiry */
+    void (*callback)(void *object);
+    void *object;
+} CO_timerWheel_timer_t;
+
+/**
+ * Timer wheel object.
+ */
+typedef struct {
+    /** Lists of timers, first index is the level */
+    CO_timerWheel_timer_t *slot[2][CO_TIMER_WHEEL_SLOTS];
+    /** Non-empty slots, bit per slot */
+    uint64_t used[2];
+    /** Current time in milliseconds */
+    uint32_t now;
+    /** Number of expired timers */
+    uint32_t fired;
+} CO_timerWheel_t;
+
+
+/**
+ * Initialize timer wheel.
+ *
+ * @param wheel This object will be initialized.
+ * @param now_ms Current time in milliseconds.
+ */
+void CO_timerWheel_init(CO_timerWheel_t *wheel, uint32_t now_ms);
+
+
+/**
+ * Initialize timer.
+ *
+ * @param timer This object will be initialized.
+ * @param callback Function called on expiry.
+ * @param object Pointer passed to callback.
+ */
+void CO_timerWheel_initTimer(CO_timerWheel_timer_t *timer,
+                             void (*callback)(void *object),
+                             void *object);
+
+
+/**
+ * (Re)start timer.
+ *
+ * @param wheel Timer wheel object.
+ * @param timer Timer object.
+ * @param delay_us Time to expiry, rounded up to milliseconds, at least 1 ms.
+ */
+void CO_timerWheel_start(CO_timerWheel_t *wheel,
+                         CO_timerWheel_timer_t *timer,
+                         uint32_t delay_us);
+
+
+/**
+ * Stop timer.
+ *
+ * @param wheel Timer wheel object.
+ * @param timer Timer object.
+ */
+void CO_timerWheel_stop(CO_timerWheel_t *wheel, CO_timerWheel_timer_t *timer);
+
+
+/**
+ * Advance the wheel to the current time and call callbacks of expired timers.
+ *
+ * @param wheel Timer wheel object.
+ * @param now_ms Current time in milliseconds.
+ */
+void CO_timerWheel_advance(CO_timerWheel_t *wheel, uint32_t now_ms);
+
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* (CO_CONFIG_TIMER_WHEEL) & CO_CONFIG_TIMER_WHEEL_ENABLE */
+
+#endif /* CO_TIMER_WHEEL_H */
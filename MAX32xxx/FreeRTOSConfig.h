@@ -0,0 +1,83 @@
+/*
+ * FreeRTOS configuration for CANopenNode on MAX32xxx.
+ *
+ * @file        FreeRTOSConfig.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* Used with CO_CONFIG_FREERTOS, see CO_main_max32xxx_freertos.c. Project may
+ * provide its own FreeRTOSConfig.h, earlier in the include path. */
+
+#include <stdint.h>
+#include "mxc_device.h"
+
+#define configCPU_CLOCK_HZ                      ((uint32_t)SystemCoreClock)
+/* CO_timer_us() requires SysTick based tick, tickless idle is not supported */
+#define configTICK_RATE_HZ                      ((TickType_t)1000)
+#define configUSE_PREEMPTION                    1
+#define configUSE_TIME_SLICING                  1
+#define configUSE_TICKLESS_IDLE                 0
+#define configMAX_PRIORITIES                    8
+#define configMINIMAL_STACK_SIZE                ((uint16_t)128)
+#define configTOTAL_HEAP_SIZE                   ((size_t)(16 * 1024))
+#define configMAX_TASK_NAME_LEN                 12
+#define configUSE_16_BIT_TICKS                  0
+#define configIDLE_SHOULD_YIELD                 1
+#define configUSE_MUTEXES                       1
+#define configUSE_RECURSIVE_MUTEXES             0
+#define configUSE_COUNTING_SEMAPHORES           0
+#define configUSE_TASK_NOTIFICATIONS            1
+#define configQUEUE_REGISTRY_SIZE               0
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configUSE_IDLE_HOOK                     0
+#define configUSE_TICK_HOOK                     0
+#define configUSE_MALLOC_FAILED_HOOK            0
+#define configCHECK_FOR_STACK_OVERFLOW          0
+#define configUSE_TIMERS                        0
+#define configUSE_CO_ROUTINES                   0
+
+#define INCLUDE_vTaskDelete                     1
+#define INCLUDE_vTaskSuspend                    1
+#define INCLUDE_vTaskDelay                      1
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_vTaskPrioritySet                0
+#define INCLUDE_uxTaskPriorityGet               0
+#define INCLUDE_xTaskGetSchedulerState          1
+
+/* Interrupt priorities, __NVIC_PRIO_BITS is defined in mxc_device.h */
+#define configPRIO_BITS                         __NVIC_PRIO_BITS
+#define configLIBRARY_LOWEST_INTERRUPT_PRIORITY ((1 << configPRIO_BITS) - 1)
+/* Highest priority of interrupts using FreeRTOS API, for example CAN */
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY 5
+#define configKERNEL_INTERRUPT_PRIORITY \
+        (configLIBRARY_LOWEST_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+#define configMAX_SYSCALL_INTERRUPT_PRIORITY \
+        (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY << (8 - configPRIO_BITS))
+
+/* FreeRTOS handlers in the startup vector table */
+#define vPortSVCHandler                         SVC_Handler
+#define xPortPendSVHandler                      PendSV_Handler
+#define xPortSysTickHandler                     SysTick_Handler
+
+#endif /* FREERTOS_CONFIG_H */
@@ -25,18 +25,27 @@
 #include <stdio.h>
 
 #include "CO_application.h"
+#include "CO_ODaccess.h"
 #include "OD.h"
 
 #define DEFAULT_BITRATE 125
 #define DEFAULT_NODE_ID 0x0B
 
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+/* Written by RPDO in RT thread, read from app_programAsync() */
+CO_OD_ACCESSORS(x6001_remoteCounter, OD_PERSIST_COMM.x6001_remoteCounter)
+#endif
+
 /******************************************************************************/
 CO_ReturnError_t app_programStart(uint16_t *bitRate,
                                   uint8_t *nodeId,
                                   uint32_t *errInfo)
 {
     /* Set initial CAN bitRate and CANopen nodeId. May be configured by LSS. */
+#if !((CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE)
+    /* With auto bitrate, 0 means detect the bitrate of the bus */
     if (*bitRate == 0) *bitRate = DEFAULT_BITRATE;
+#endif
     if (*nodeId == 0) *nodeId = DEFAULT_NODE_ID;
 
     return CO_ERROR_NO;
@@ -70,7 +79,11 @@ void app_programAsync(CO_t *co, uint32_t timer1usDiff)
     timer1usTotal += timer1usDiff;
     if (timer1usTotal > 1000000) {
         timer1usTotal = 0;
+#if (CO_CONFIG_OD_ACCESS) & CO_CONFIG_OD_ACCESS_ENABLE
+        printf("Remote counter: %u\n", OD_get_x6001_remoteCounter());
+#else
         printf("Remote counter: %u\n", OD_PERSIST_COMM.x6001_remoteCounter);
+#endif
     }
 }
 
@@ -29,3 +29,6 @@ VPATH += ../../MAX32xxx
 # Add CANopenNode to include path
 IPATH += ../../CANopenNode
 IPATH += ../../MAX32xxx
+
+# Process image for app_programAsync(), see CO_procImage.h
+PROJ_CFLAGS += -DCO_CONFIG_PROC_IMAGE=1
@@ -32,7 +32,10 @@ CO_ReturnError_t app_programStart(uint16_t *bitRate,
                                   uint32_t *errInfo)
 {
     /* Set initial CAN bitRate and CANopen nodeId. May be configured by LSS. */
+#if !((CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE)
+    /* With auto bitrate, 0 means detect the bitrate of the bus */
     if (*bitRate == 0) *bitRate = 125;
+#endif
     if (*nodeId == 0) *nodeId = 0x0A;
 
     return CO_ERROR_NO;
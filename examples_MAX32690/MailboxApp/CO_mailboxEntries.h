@@ -0,0 +1,47 @@
+/*
+ * Process image of the split-core example, shared by both cores.
+ *
+ * @file        CO_mailboxEntries.h
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_MAILBOX_ENTRIES_H
+#define CO_MAILBOX_ENTRIES_H
+
+#include "CO_mailbox.h"
+
+/*
+ * Included by exactly one file on each core, so both use the same list:
+ * CO_application.c of ../TPDO on the stack core and main.c on the
+ * application core.
+ */
+
+/* Position of objects in CO_mailboxEntries */
+#define MB_COUNTER          0   /* 0x6000, mapped to TPDO */
+#define MB_ERROR_REGISTER   1   /* 0x1001 */
+
+const CO_mailbox_entry_t CO_mailboxEntries[] = {
+    {0x6000, 0x00, sizeof(uint32_t), CO_MAILBOX_TO_STACK},
+    {0x1001, 0x00, sizeof(uint8_t), CO_MAILBOX_TO_APP}
+};
+const uint8_t CO_mailboxEntriesCount =
+    sizeof(CO_mailboxEntries) / sizeof(CO_mailboxEntries[0]);
+
+#endif /* CO_MAILBOX_ENTRIES_H */
@@ -0,0 +1,64 @@
+/*
+ * Application core of the split-core example on MAX32690.
+ *
+ * @file        main.c
+ * @author      Analog Devices, Inc.    2023
+ * @copyright   2023 Analog Devices, Inc.
+ *
+ * This file is part of CANopenNode, an opensource CANopen Stack.
+ * Project home page is <https://github.com/CANopenNode/CANopenNode>.
+ * For more information on CANopen see <http://www.can-cia.org/>.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "mxc_device.h"
+#include "mxc_delay.h"
+
+#include "CO_mailbox.h"
+#include "CO_mailboxEntries.h"
+
+/* Control loop period */
+#define APP_PERIOD_MS 1
+
+static CO_mailbox_t mailbox;
+
+
+/******************************************************************************/
+int main(void)
+{
+    uint32_t counter = 0;
+    uint8_t errorRegister = 0;
+
+    if (CO_mailbox_init(&mailbox, CO_MAILBOX_SHARED, NULL) != CO_ERROR_NO) {
+        for (;;) {}
+    }
+
+    /* Stack core starts this core, but rings may not be initialized yet */
+    while (!CO_mailbox_ready(&mailbox)) {}
+
+    for (;;) {
+        /* Process image from the last RT cycle of the stack core */
+        CO_mailbox_processApp(&mailbox);
+        CO_mailbox_read(&mailbox, MB_ERROR_REGISTER, &errorRegister);
+
+        /* Counter is sent in TPDO by the stack core, it stops on error */
+        if (errorRegister == 0U) {
+            counter++;
+            /* On full ring, next loop sends the newer value */
+            (void)CO_mailbox_write(&mailbox, MB_COUNTER, &counter);
+        }
+
+        MXC_Delay(MXC_DELAY_MSEC(APP_PERIOD_MS));
+    }
+}
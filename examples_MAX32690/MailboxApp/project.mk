@@ -0,0 +1,25 @@
+# This file can be used to set build configuration
+# variables.  These variables are defined in a file called 
+# "Makefile" that is located next to this one.
+
+# For instructions on how to use this system, see
+# https://github.com/Analog-Devices-MSDK/VSCode-Maxim/tree/develop#build-configuration
+
+# **********************************************************
+
+# Application core of split-core operation, see CO_mailbox.h. It runs on the
+# RISC-V core and is built and loaded by the stack core project
+# (../TPDO with RISCV_LOAD=1), it has no CANopen stack.
+RISCV_CORE=1
+
+# Only the mailbox, not the CANopenNode sources or the stack main files
+AUTOSEARCH=0
+SRCS += main.c
+SRCS += CO_mailbox.c
+VPATH += ../../MAX32xxx
+
+# CANopenNode headers for the types of CO_mailbox.h
+IPATH += ../../CANopenNode
+IPATH += ../../MAX32xxx
+
+PROJ_CFLAGS += -DCO_CONFIG_MAILBOX=1
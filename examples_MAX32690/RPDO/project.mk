@@ -29,3 +29,6 @@ VPATH += ../../MAX32xxx
 # Add CANopenNode to include path
 IPATH += ../../CANopenNode
 IPATH += ../../MAX32xxx
+
+# Lock-free OD accessors for app_programAsync(), see CO_ODaccess.h
+PROJ_CFLAGS += -DCO_CONFIG_OD_ACCESS=1
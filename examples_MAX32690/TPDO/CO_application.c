@@ -24,20 +24,49 @@
 
 
 #include "CO_application.h"
+#include "CO_procImage.h"
 #include "OD.h"
 
 #define DEFAULT_BITRATE 125
 #define DEFAULT_NODE_ID 0x0A
 
+#if (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK
+/* Counter is written by the application core, see ../MailboxApp */
+#include "mxc_sys.h"
+#include "CO_mailboxEntries.h"
+#elif (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+/* Objects written from app_programAsync(), mapped to TPDO */
+#define PI_COUNTER 0
+
+const CO_procImage_entry_t CO_procImageEntries[] = {
+    {0x6000, 0x00, sizeof(uint32_t), CO_PROC_IMAGE_TO_STACK}
+};
+const uint8_t CO_procImageEntriesCount =
+    sizeof(CO_procImageEntries) / sizeof(CO_procImageEntries[0]);
+
+static uint32_t counter;
+#endif
+
 /******************************************************************************/
 CO_ReturnError_t app_programStart(uint16_t *bitRate,
                                   uint8_t *nodeId,
                                   uint32_t *errInfo)
 {
     /* Set initial CAN bitRate and CANopen nodeId. May be configured by LSS. */
+#if !((CO_CONFIG_AUTO_BITRATE) & CO_CONFIG_AUTO_BITRATE_ENABLE)
+    /* With auto bitrate, 0 means detect the bitrate of the bus */
     if (*bitRate == 0) *bitRate = DEFAULT_BITRATE;
+#endif
     if (*nodeId == 0) *nodeId = DEFAULT_NODE_ID;
 
+#if (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK
+    /* Application core waits until the mailbox is initialized */
+    MXC_SYS_RISCVRun();
+#elif (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+    /* Continue from the value in OD, which may be restored from storage */
+    counter = OD_PERSIST_COMM.x6000_counter;
+#endif
+
     return CO_ERROR_NO;
 }
 
@@ -64,7 +93,16 @@ void app_programAsync(CO_t *co, uint32_t timer1usDiff)
     /* Here can be slower code, all must be non-blocking. Mind race conditions
      * between this functions and following three functions, which all run from
      * realtime timer interrupt */
+#if (CO_CONFIG_MAILBOX) & CO_CONFIG_MAILBOX_STACK
+    /* RT thread writes counter from the application core into OD */
+#elif (CO_CONFIG_PROC_IMAGE) & CO_CONFIG_PROC_IMAGE_ENABLE
+    /* TPDO is built from the image, RT thread copies it into OD */
+    counter++;
+    CO_procImage_write(&procImage, PI_COUNTER, &counter);
+    CO_procImage_publish(&procImage);
+#else
     OD_PERSIST_COMM.x6000_counter++;
+#endif
 }
 
 
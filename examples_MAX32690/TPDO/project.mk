@@ -29,3 +29,16 @@ VPATH += ../../MAX32xxx
 # Add CANopenNode to include path
 IPATH += ../../CANopenNode
 IPATH += ../../MAX32xxx
+
+# Process image for app_programAsync(), see CO_procImage.h
+PROJ_CFLAGS += -DCO_CONFIG_PROC_IMAGE=1
+
+# Split-core operation, see CO_mailbox.h: this core runs the CANopen stack,
+# counter comes from the application on the RISC-V core, which is built from
+# ../MailboxApp and loaded together with this image. Use it instead of the
+# process image above. Linker files of both cores must INCLUDE
+# ../../MAX32xxx/CO_mailbox.ld.
+#PROJ_CFLAGS += -DCO_CONFIG_MAILBOX=3
+#RISCV_LOAD=1
+#RISCV_APP=../MailboxApp
+IPATH += ../MailboxApp
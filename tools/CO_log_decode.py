@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+#
+# Host decoder for the binary log of the MAX32xxx port (CO_CONFIG_LOG_BINARY).
+#
+# Copyright 2023 Analog Devices, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Decode binary log records from the debug UART.
+
+Message formats are taken from the CO_LOG_MESSAGES list in MAX32xxx/CO_log.h.
+Bytes outside of records (for example output of log_printf) are passed
+through as text.
+
+Usage:
+    CO_log_decode.py [-H path/to/CO_log.h] [input]
+
+Input is a file or serial device, stdin by default.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+# CO_log_record_t: timestamp_us, id, seq, arg[2]
+RECORD = struct.Struct("<IHHII")
+
+
+def load_formats(header):
+    with open(header, encoding="utf-8") as f:
+        text = f.read()
+    entries = re.findall(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)', text)
+    formats = []
+    for name, fmt in entries:
+        fmt = bytes(fmt, "utf-8").decode("unicode_escape")
+        # C length modifiers are not used in Python
+        fmt = re.sub(r"%(0?\d*)l([udxX])", r"%\1\2", fmt)
+        formats.append((name, fmt))
+    return formats
+
+
+def format_record(formats, timestamp, msg_id, args):
+    if msg_id >= len(formats):
+        return "[%d.%06d] unknown message %d (0x%X, 0x%X)\n" % (
+            timestamp // 1000000, timestamp % 1000000, msg_id, args[0], args[1])
+    fmt = formats[msg_id][1]
+    n = len(re.findall(r"%[^%]", fmt.replace("%%", "")))
+    values = []
+    for i, conv in enumerate(re.findall(r"%0?\d*([udxX])", fmt)[:n]):
+        v = args[i]
+        if conv == "d" and v & 0x80000000:
+            v -= 1 << 32
+        values.append(v)
+    return "[%d.%06d] %s" % (timestamp // 1000000, timestamp % 1000000,
+                             fmt % tuple(values))
+
+
+def decode(stream, formats, out):
+    buf = b""
+    last_seq = None
+    while True:
+        chunk = stream.read(256)
+        if not chunk:
+            break
+        buf += chunk
+        while True:
+            pos = buf.find(SYNC)
+            if pos < 0:
+                # keep possible first half of the marker
+                keep = 1 if buf.endswith(SYNC[:1]) else 0
+                out.write(buf[:len(buf) - keep].decode("utf-8", "replace"))
+                buf = buf[len(buf) - keep:]
+                break
+            out.write(buf[:pos].decode("utf-8", "replace"))
+            if len(buf) < pos + len(SYNC) + RECORD.size:
+                buf = buf[pos:]
+                break
+            start = pos + len(SYNC)
+            timestamp, msg_id, seq, arg0, arg1 = RECORD.unpack_from(buf, start)
+            buf = buf[start + RECORD.size:]
+            if msg_id != 0 and last_seq is not None:
+                gap = (seq - last_seq - 1) & 0xFFFF
+                if gap:
+                    out.write("(%d records missing)\n" % gap)
+            if msg_id != 0:
+                last_seq = seq
+            out.write(format_record(formats, timestamp, msg_id, (arg0, arg1)))
+        out.flush()
+
+
+def main():
+    default_header = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                  "..", "MAX32xxx", "CO_log.h")
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-H", "--header", default=default_header,
+                        help="path to CO_log.h")
+    parser.add_argument("input", nargs="?", help="input file or device")
+    args = parser.parse_args()
+
+    formats = load_formats(args.header)
+    if args.input:
+        with open(args.input, "rb", buffering=0) as stream:
+            decode(stream, formats, sys.stdout)
+    else:
+        decode(sys.stdin.buffer, formats, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()